@@ -1,94 +1,182 @@
 #include "pybind11/pybind11.h"
 #include "pybind11/operators.h"
 #include "pybind11/stl.h"
+#include "pybind11/numpy.h"
 
 #include "kuai.h"
+#include "kuai/Components/CoreSystems.h"
+#include "kuai/Physics/Physics3D.h"
 
 #include "glm/glm.hpp"
 
+#include <thread>
+
 using namespace kuai;
 namespace py = pybind11;
 using namespace py::literals;
 
-class PyLayer : public Layer
+// The GIL is released while the engine runs (see App.run) and while assets load, and taken back only for calls into
+// Python, so Python threads keep running while the engine works, and update() can be called from the update thread.
+class PyApp : public App
 {
 public:
-    using Layer::Layer;
-
-    //virtual void onAttach() override
-    //{
-    //    PYBIND11_OVERRIDE_PURE(
-    //        void,
-    //        Layer,
-    //        onAttach
-    //    );
-    //}
-
-    //virtual void onDetach() override
-    //{
-    //    PYBIND11_OVERRIDE_PURE(
-    //        void,
-    //        Layer,
-    //        onDetach
-    //    );
-    //}
+    using App::App;
 
     virtual void update(float dt) override
     {
         PYBIND11_OVERRIDE_PURE(
             void,
-            Layer,
+            App,
             update,
             dt
         );
     }
 
-    virtual void onEvent(Event* event) override
+    virtual void fixedUpdate(float dt) override
     {
-        PYBIND11_OVERRIDE_PURE(
+        PYBIND11_OVERRIDE(
             void,
-            Layer,
+            App,
+            fixedUpdate,
+            dt
+        );
+    }
+
+    virtual void onEvent(Event& event) override
+    {
+        PYBIND11_OVERRIDE(
+            void,
+            App,
             onEvent,
-            event
+            &event
         );
     }
 };
 
+// Bulk component access: entity IDs as a uint32 array and values as an (N, 3) float32 array, row for row.
+// Each batch crosses into the engine once, so vectorised NumPy updates don't pay for a call per entity.
+using IdArray = py::array_t<EntityID, py::array::c_style | py::array::forcecast>;
+using Vec3Array = py::array_t<float, py::array::c_style | py::array::forcecast>;
+
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "Rows of an (N, 3) array are read as glm::vec3");
+
+template<typename System>
+using GetColumnFn = bool (System::*)(const EntityID*, u32, glm::vec3*);
+template<typename System>
+using SetColumnFn = bool (System::*)(const EntityID*, u32, const glm::vec3*);
+
+template<typename System>
+static Vec3Array getColumn(System& system, GetColumnFn<System> get, const IdArray& ids)
+{
+    py::ssize_t count = ids.size();
+    Vec3Array values({ count, (py::ssize_t)3 });
+
+    // Written straight into the new array's memory
+    if (!(system.*get)(ids.data(), (u32)count, (glm::vec3*)values.mutable_data()))
+        throw py::value_error("An entity doesn't have the component");
+
+    return values;
+}
+
+template<typename Component, typename System>
+static void setColumn(System& system, SetColumnFn<System> set, const IdArray& ids, const Vec3Array& values)
+{
+    if (values.ndim() != 2 || values.shape(0) != ids.size() || values.shape(1) != 3)
+        throw py::value_error("Expected an (N, 3) array with a row for each entity");
+
+    // Checked up front, so a deferred set fails here like an immediate one, and neither is left half applied
+    App& app = App::get();
+    for (py::ssize_t i = 0; i < ids.size(); i++)
+    {
+        std::optional<Entity> entity = app.getEntityById(ids.data()[i]);
+        if (!entity || !entity->hasComponent<Component>())
+            throw py::value_error("An entity doesn't have the component");
+    }
+
+    // With a threaded update the scene is being extracted meanwhile, so a copy is applied at the start of the next frame
+    if (app.isThreadedUpdate())
+    {
+        std::vector<EntityID> idCopy(ids.data(), ids.data() + ids.size());
+        std::vector<glm::vec3> valueCopy((const glm::vec3*)values.data(), (const glm::vec3*)values.data() + ids.size());
+        app.defer([&system, set, idCopy = std::move(idCopy), valueCopy = std::move(valueCopy)]()
+        {
+            if (!(system.*set)(idCopy.data(), (u32)idCopy.size(), valueCopy.data()))
+                KU_WARN("Deferred bulk set stopped at an entity destroyed before it was applied");
+        });
+        return;
+    }
+
+    if (!(system.*set)(ids.data(), (u32)ids.size(), (const glm::vec3*)values.data()))
+        throw py::value_error("An entity doesn't have the component");
+}
+
+// The thread that imported the module, which is the one that runs the app
+static std::thread::id mainThread;
+
+// With a threaded update, the main thread extracts the scene while update() changes it, so a per-entity setter called from
+// the update thread would race extraction. Bound through this, such setters raise instead.
+template<typename Class, typename Return, typename... Args>
+static auto onMainThread(Return (Class::*fn)(Args...))
+{
+    return [fn](Class& self, Args... args) -> Return
+    {
+        if (std::this_thread::get_id() != mainThread && App::get().isThreadedUpdate())
+            throw std::runtime_error("Entities can't be changed from a threaded update; use App.defer() or the bulk setters");
+
+        return (self.*fn)(std::forward<Args>(args)...);
+    };
+}
+
 PYBIND11_MODULE(pykuai, m)
 {
     Log::Init();
+    mainThread = std::this_thread::get_id();
 
     m.doc() = "3D Game Engine";
     py::options options;
     options.disable_enum_members_docstring();
     //options.disable_function_signatures();
 
-    py::class_<App>(m, "App",
-        R"(This class runs your game. It handles windowing, events and layer updates. 
-           It uses layers to execute game logic.
+    py::class_<App, PyApp>(m, "App",
+        R"(This class runs your game. It handles windowing, events and updates.
+           Game logic goes in a subclass overriding update(), and optionally fixedUpdate() and onEvent().
         )")
         .def(py::init<>())
-        .def("pushLayer", &App::pushLayer, "Pushes a layer on to the app's layer stack.")
-        .def("run", &App::run, "Starts the application main loop. Layers on the layer stack get updated every iteration of the loop.")
+        .def("run", &App::run, py::call_guard<py::gil_scoped_release>(),
+            "Starts the application main loop, calling update() every iteration of the loop. The GIL is released while the engine runs.")
+        .def("update", &App::update, "Called every frame. @param dt Delta time : time elapsed between frames.")
+        .def("fixedUpdate", &App::fixedUpdate, "Called at a fixed rate, zero or more times per frame before update.")
+        .def("onEvent", &App::onEvent, "Called every time an event occurs.")
+        .def("setThreadedUpdate", &App::setThreadedUpdate,
+            R"(Run update() on a separate thread, alongside rendering. While on, update() may read the scene but must make its changes
+               through defer() or the bulk setters of Transforms and Physics3D, which are applied once the frame syncs and drawn a frame later.
+               Creating entities, adding components and the per-entity setters raise a RuntimeError there.)", "enabled"_a)
+        .def("isThreadedUpdate", &App::isThreadedUpdate)
+        .def("defer", [](App& app, py::function command)
+            {
+                // Called and destroyed on the main thread, which doesn't hold the GIL while the engine runs
+                std::shared_ptr<py::function> held(new py::function(std::move(command)), [](py::function* fn)
+                    {
+                        py::gil_scoped_acquire gil;
+                        delete fn;
+                    });
+                app.defer([held]()
+                    {
+                        py::gil_scoped_acquire gil;
+                        (*held)();
+                    });
+            }, "Queues a function to call on the main thread once update() returns, or at the start of the next frame while the update is threaded. Safe from any thread.", "command"_a)
         .def_static("get", &App::get, py::return_value_policy::reference, "Returns the app instance.")
-        .def("getWindow", &App::getWindow, py::return_value_policy::reference, "Returns the window instance.");
+        .def("createEntity", onMainThread(&App::createEntity), "Creates an entity with a Transform.")
+        .def("getMainCam", &App::getMainCam, py::return_value_policy::reference, "Returns the entity of the camera that renders to the window.")
+        .def("getWindow", &App::getWindow, py::return_value_policy::reference, "Returns the window instance.")
+        .def("getTransforms", &App::getTransforms, py::return_value_policy::reference, "Returns every entity's transform, for bulk access.")
+        .def("getPhysics3D", &App::getPhysics3D, py::return_value_policy::reference, "Returns the 3D physics system.");
 
     py::class_<Window>(m, "Window")
         .def("getWidth", &Window::getWidth)
         .def("getHeight", &Window::getHeight);
     
-    py::class_<Layer, PyLayer>(m, "Layer", 
-        R"(A layer describes a self - contained section of game logic or rendering. The App class uses layers in order to run a game.
-           The user must create their own layers by inheriting from this class.
-           Any necessary initialisation can be handled in the constructor.
-           Code within the update() function will be called every frame.)
-        )")
-        .def(py::init<>())
-        .def("onAttach", &Layer::onAttach, "Called when the layer is attached to the app via App::pushLayer()")
-        .def("onDetach", &Layer::onDetach, "Called when the layer is removed from the app.")
-        .def("update", &Layer::update, " Called every frame. @param dt Delta time : time elapsed between frames.")
-        .def("onEvent", &Layer::onEvent, py::return_value_policy::reference, "Called when an event reaches this layer.");
-
     py::enum_<EventType>(m, "EventType")
         .value("KEY_RELEASE", EventType::KeyPress)
         .value("KEY_PRESS", EventType::KeyRelease)
@@ -127,10 +215,16 @@ PYBIND11_MODULE(pykuai, m)
 
     py::class_<Input>(m, "Input", "Used to poll mouse and keyboard input, as well as getting input values from the mouse.")
         .def_static("isKeyPressed", &Input::isKeyPressed)
+        .def_static("wasKeyPressed", &Input::wasKeyPressed)
+        .def_static("wasKeyReleased", &Input::wasKeyReleased)
         .def_static("isMouseBtnPressed", &Input::isMouseBtnPressed)
+        .def_static("wasMouseBtnPressed", &Input::wasMouseBtnPressed)
+        .def_static("wasMouseBtnReleased", &Input::wasMouseBtnReleased)
         .def_static("getMousePos", &Input::getMousePos)
         .def_static("getMouseX", &Input::getMouseX)
-        .def_static("getMouseY", &Input::getMouseY);
+        .def_static("getMouseY", &Input::getMouseY)
+        .def_static("getMouseDelta", &Input::getMouseDelta)
+        .def_static("getScrollDelta", &Input::getScrollDelta);
 
     py::enum_<Mouse::Mouse>(m, "Mouse", "Mouse button codes.")
         .value("BTN0", Mouse::Button0)
@@ -189,15 +283,6 @@ PYBIND11_MODULE(pykuai, m)
         .value("L_CTRL", Key::LeftControl)
         .export_values();
 
-    py::class_<Scene>(m, "Scene", 
-        R"(Represents a game scene by holding a list of entity objects. The scene owns a main camera; the view of this camera gets rendered to the viewport.
-           The scene owns a collection of systems that update game logic
-        )")
-        .def(py::init<>())
-        .def("update", &Scene::update)
-        .def("createEntity", &Scene::createEntity, py::return_value_policy::reference)
-        .def("getMainCam", &Scene::getMainCam, py::return_value_policy::reference);
-
     py::class_<glm::vec2>(m, "Vec2", "2D vector of floats.")
         .def(py::init<float, float>())
         .def(py::self + py::self)
@@ -248,15 +333,35 @@ PYBIND11_MODULE(pykuai, m)
         .def("getRight", &Transform::getRight, py::return_value_policy::copy, "Get normalised right-facing vector.")
         .def("getUp", &Transform::getUp, py::return_value_policy::copy, "Get normalised upward-facing vector.")
         .def("getPos", &Transform::getPos, py::return_value_policy::copy, "Gets world position.")
-        .def("setPos", py::overload_cast<float, float, float>(&Transform::setPos), "Sets world position.", "x"_a, "y"_a, "z"_a)
+        .def("setPos", onMainThread(py::overload_cast<float, float, float>(&Transform::setPos)), "Sets world position.", "x"_a, "y"_a, "z"_a)
         .def("getRot", &Transform::getRot, py::return_value_policy::copy, "Gets rotation in Euler angles (in degrees).")
-        .def("setRot", py::overload_cast<float, float, float>(&Transform::setRot), "Sets rotation in Euler angles (in degrees).", "x"_a, "y"_a, "z"_a)
+        .def("setRot", onMainThread(py::overload_cast<float, float, float>(&Transform::setRot)), "Sets rotation in Euler angles (in degrees).", "x"_a, "y"_a, "z"_a)
         .def("getScale", &Transform::getScale, py::return_value_policy::copy, "Gets scale.")
-        .def("setScale", py::overload_cast<float, float, float>(&Transform::setScale), "Sets scale.", "x"_a, "y"_a, "z"_a)
-        .def("translate", py::overload_cast<float, float, float>(&Transform::translate), "Moves object by specified amount in each direction.")
-        .def("translate", py::overload_cast<const glm::vec3&>(&Transform::translate), "Moves this object by applying provided vector to its position.")
-        .def("rotate", py::overload_cast<float, float, float>(&Transform::rotate), "Rotates object by specified amount (in degrees) over each axis.")
-        .def("rotate", py::overload_cast<const glm::vec3&>(&Transform::rotate), "Rotates object by by applying provided vector (in degrees) to its rotation.");
+        .def("setScale", onMainThread(py::overload_cast<float, float, float>(&Transform::setScale)), "Sets scale.", "x"_a, "y"_a, "z"_a)
+        .def("translate", onMainThread(py::overload_cast<float, float, float>(&Transform::translate)), "Moves object by specified amount in each direction.")
+        .def("translate", onMainThread(py::overload_cast<const glm::vec3&>(&Transform::translate)), "Moves this object by applying provided vector to its position.")
+        .def("rotate", onMainThread(py::overload_cast<float, float, float>(&Transform::rotate)), "Rotates object by specified amount (in degrees) over each axis.")
+        .def("rotate", onMainThread(py::overload_cast<const glm::vec3&>(&Transform::rotate)), "Rotates object by by applying provided vector (in degrees) to its rotation.");
+
+    py::class_<TransformSystem>(m, "Transforms", "Every entity's transform, read and written in bulk as NumPy arrays.")
+        .def("getPositions", [](TransformSystem& s, const IdArray& ids) { return getColumn(s, &TransformSystem::getPositions, ids); },
+            "Positions of the entities as an (N, 3) array.", "ids"_a)
+        .def("setPositions", [](TransformSystem& s, const IdArray& ids, const Vec3Array& values) { setColumn<Transform>(s, &TransformSystem::setPositions, ids, values); },
+            "Sets the positions of the entities from an (N, 3) array.", "ids"_a, "positions"_a)
+        .def("getRotations", [](TransformSystem& s, const IdArray& ids) { return getColumn(s, &TransformSystem::getRotations, ids); },
+            "Rotations of the entities in Euler angles (in degrees) as an (N, 3) array.", "ids"_a)
+        .def("setRotations", [](TransformSystem& s, const IdArray& ids, const Vec3Array& values) { setColumn<Transform>(s, &TransformSystem::setRotations, ids, values); },
+            "Sets the rotations of the entities in Euler angles (in degrees) from an (N, 3) array.", "ids"_a, "rotations"_a)
+        .def("getScales", [](TransformSystem& s, const IdArray& ids) { return getColumn(s, &TransformSystem::getScales, ids); },
+            "Scales of the entities as an (N, 3) array.", "ids"_a)
+        .def("setScales", [](TransformSystem& s, const IdArray& ids, const Vec3Array& values) { setColumn<Transform>(s, &TransformSystem::setScales, ids, values); },
+            "Sets the scales of the entities from an (N, 3) array.", "ids"_a, "scales"_a);
+
+    py::class_<Physics3DSystem>(m, "Physics3D", "Simulates entities with Rigidbody and Collider components.")
+        .def("getVelocities", [](Physics3DSystem& s, const IdArray& ids) { return getColumn(s, &Physics3DSystem::getVelocities, ids); },
+            "Rigidbody velocities of the entities as an (N, 3) array.", "ids"_a)
+        .def("setVelocities", [](Physics3DSystem& s, const IdArray& ids, const Vec3Array& values) { setColumn<Rigidbody>(s, &Physics3DSystem::setVelocities, ids, values); },
+            "Sets the Rigidbody velocities of the entities from an (N, 3) array.", "ids"_a, "velocities"_a);
 
     py::enum_<Light::LightType>(m, "LightType")
         .value("DIR", Light::LightType::Directional, "Directional light.")
@@ -275,62 +380,62 @@ PYBIND11_MODULE(pykuai, m)
         .def("getIntensity", &Light::getIntensity, py::return_value_policy::copy)
         .def("getLinear", &Light::getLinear, py::return_value_policy::copy)
         .def("getQuadratic", &Light::getQuadratic, py::return_value_policy::copy)
-        .def("setType", &Light::setType)
-        .def("setCol", py::overload_cast<const glm::vec3&>(&Light::setCol))
-        .def("setCol", py::overload_cast<float, float, float>(&Light::setCol))
-        .def("setIntensity", &Light::setIntensity)
-        .def("setAttenuation", &Light::setAttenuation);
-
-    py::class_<CameraComponent>(m, "Camera", "Device through which the user views the world.")
-        .def("setPersp", &CameraComponent::setPerspective)
-        .def("setOrtho", &CameraComponent::setOrtho)
-        .def("setAspect", &CameraComponent::setAspect)
-        .def("getTransform", &CameraComponent::getTransform, py::return_value_policy::reference);
+        .def("setType", onMainThread(&Light::setType))
+        .def("setCol", onMainThread(py::overload_cast<const glm::vec3&>(&Light::setCol)))
+        .def("setCol", onMainThread(py::overload_cast<float, float, float>(&Light::setCol)))
+        .def("setIntensity", onMainThread(&Light::setIntensity))
+        .def("setAttenuation", onMainThread(&Light::setAttenuation));
+
+    py::class_<Cam>(m, "Camera", "Device through which the user views the world.")
+        .def("setPersp", onMainThread(&Cam::setPerspective), "fov"_a, "aspect"_a, "zNear"_a, "zFar"_a)
+        .def("setOrtho", onMainThread(&Cam::setOrtho), "width"_a, "height"_a, "zNear"_a, "zFar"_a)
+        .def("getNear", &Cam::getNear)
+        .def("getFar", &Cam::getFar);
 
     py::class_<AudioClip, std::shared_ptr<AudioClip>>(m, "AudioClip", "Stores an audio file from a given location.")
-        .def(py::init<const std::string&>(), "Creates audio clip from a sound file.");
-
-    py::class_<AudioListener>(m, "Listener", "Acts like a microphone within a scene to playback sounds. Only one Listener is permitted per scene.")
-        .def("getGain", &AudioListener::getGain, py::return_value_policy::copy)
-        .def("setGain", &AudioListener::setGain);
-
-    py::class_<AudioSourceComponent>(m, "AudioSource", "Acts like a speaker; generates sounds in a scene. Must be provided with an AudioClip to play.")
-        .def("get", &AudioSourceComponent::get, py::return_value_policy::reference);
-
-    py::class_<AudioSource>(m, "Source")
-        .def("getPitch", &AudioSource::getPitch, py::return_value_policy::copy)
-        .def("setPitch", &AudioSource::setPitch)
-        .def("getGain", &AudioSource::getGain, py::return_value_policy::copy)
-        .def("setGain", &AudioSource::setGain)
-        .def("getRolloff", &AudioSource::getRolloff, py::return_value_policy::copy)
-        .def("setRolloff", &AudioSource::setRolloff)
-        .def("getRefDist", &AudioSource::getRefDist, py::return_value_policy::copy)
-        .def("setRefDist", &AudioSource::setRefDist)
-        .def("isLoop", &AudioSource::isLoop, py::return_value_policy::copy)
-        .def("setLoop", &AudioSource::setLoop)
-        .def("setClip", &AudioSource::setAudioClip)
-        .def("play", &AudioSource::play)
-        .def("stop", &AudioSource::stop);
-
-    py::class_<Cubemap, std::shared_ptr<Cubemap>>(m, "Cubemap", "A collection of six textures that form a cube. Used in environment mapping and to create Skybox objects.")
-        .def(py::init<const std::vector<std::string>&>(), "A list of filenames that correspond to each face of the cube. Order of faces : px, nx, py, ny, pz, nz.");
+        .def(py::init<const std::string&>(), py::call_guard<py::gil_scoped_release>(), "Creates audio clip from a sound file.");
+
+    py::class_<Listener>(m, "Listener", "Acts like a microphone within a scene to playback sounds. Only one Listener is permitted per scene.")
+        .def("getGain", &Listener::getGain, py::return_value_policy::copy)
+        .def("setGain", onMainThread(&Listener::setGain));
+
+    py::class_<SoundSource>(m, "AudioSource", "Acts like a speaker; generates sounds in a scene. Must be provided with an AudioClip to play.")
+        .def("getPitch", &SoundSource::getPitch, py::return_value_policy::copy)
+        .def("setPitch", onMainThread(&SoundSource::setPitch))
+        .def("getGain", &SoundSource::getGain, py::return_value_policy::copy)
+        .def("setGain", onMainThread(&SoundSource::setGain))
+        .def("getRolloff", &SoundSource::getRolloff, py::return_value_policy::copy)
+        .def("setRolloff", onMainThread(&SoundSource::setRolloff))
+        .def("getRefDist", &SoundSource::getRefDist, py::return_value_policy::copy)
+        .def("setRefDist", onMainThread(&SoundSource::setRefDist))
+        .def("getPriority", &SoundSource::getPriority, py::return_value_policy::copy)
+        .def("setPriority", onMainThread(&SoundSource::setPriority))
+        .def("isLoop", &SoundSource::isLoop, py::return_value_policy::copy)
+        .def("setLoop", onMainThread(&SoundSource::setLoop))
+        .def("setClip", onMainThread(&SoundSource::setAudioClip))
+        .def("play", onMainThread(&SoundSource::play))
+        .def("pause", onMainThread(&SoundSource::pause))
+        .def("stop", onMainThread(&SoundSource::stop));
+
+    py::class_<Cubemap, std::shared_ptr<Cubemap>>(m, "Cubemap", "A collection of six textures that form a cube. Used in environment mapping.")
+        .def(py::init<const std::vector<std::string>&>(), py::call_guard<py::gil_scoped_release>(), "A list of filenames that correspond to each face of the cube. Order of faces : px, nx, py, ny, pz, nz.");
 
     py::class_<Texture, std::shared_ptr<Texture>>(m, "Texture", "A 2D texture that can support transparency.")
         .def(py::init<>(), "Creates default blank texture.")
-        .def(py::init<const char*>(), "Loads texture from image file.");
+        .def(py::init<const std::string&>(), py::call_guard<py::gil_scoped_release>(), "Loads texture from image file.");
 
     py::class_<Material, std::shared_ptr<Material>>(m, "Material", "Base class for materials. Every material has a shader that sets rendering properties in each render loop.");
 
     py::class_<DefaultMaterial, std::shared_ptr<DefaultMaterial>, Material>(m, "DefaultMaterial", "Default material that uses the Phong model.")
-        .def(py::init<std::shared_ptr<Texture>, std::shared_ptr<Texture>, float>())
+        .def(py::init<>(), "Creates a material with a blank diffuse texture.")
+        .def(py::init<std::shared_ptr<Texture>>(), "Creates a material with a diffuse texture.", "diffuse"_a)
         .def("setDiffuse", &DefaultMaterial::setDiffuse, "Sets the diffuse texture.")
-        .def("setSpecular", &DefaultMaterial::setSpecular, "Sets the specular texture.")
-        .def("setReflection", &DefaultMaterial::setReflection, "Set a reflection cubemap.")
-        .def("getShininess", &DefaultMaterial::getSpecularAmount, "The shininess of the material; higher values are less shiny.")
-        .def("setShininess", &DefaultMaterial::setSpecularAmount, "The shininess of the material; higher values are less shiny.");
+        .def("getTiling", &DefaultMaterial::getTiling, "How many times the texture repeats across each axis.")
+        .def("setTiling", &DefaultMaterial::setTiling, "Sets how many times the texture repeats across each axis.", "x"_a, "y"_a);
 
     py::class_<MeshRenderer>(m, "Renderer", "Renders models or meshes to the screen.")
-        .def("setModel", &MeshRenderer::setModel);
+        .def("getModel", &MeshRenderer::getModel)
+        .def("setModel", onMainThread(&MeshRenderer::setModel));
 
     py::class_<Mesh, std::shared_ptr<Mesh>>(m, "Mesh", "A collection of vertices, normals and texture coordinates that define a polyhedral object. Each mesh has a Material.")
         .def(py::init<const std::vector<float>&, const std::vector<float>&, const std::vector<float>&, const std::vector<uint32_t>&>(), R"(
@@ -342,22 +447,24 @@ PYBIND11_MODULE(pykuai, m)
         )", "positions"_a, "normals"_a, "texCoords"_a, "indices"_a);
 
     py::class_<Model, std::shared_ptr<Model>>(m, "Model", "A 3D object that is comprised of a collection of Meshes.")
-        .def(py::init<const std::string&>(), "Load model from a 3D object file.")
+        .def(py::init<const std::string&>(), py::call_guard<py::gil_scoped_release>(), "Load model from a 3D object file.")
         .def(py::init<std::shared_ptr<Mesh>>(), "Create model by specifying a singlular mesh.")
         .def("getMeshes", &Model::getMeshes, py::return_value_policy::reference, "Returns list of meshes this model is made of.");
 
-    py::class_<Skybox, std::shared_ptr<Skybox>, Model>(m, "Skybox", "A 3D background that is rendered behind everything in the scene. It gives the impression of objects or details at the horizon.")
-        .def(py::init<std::shared_ptr<Cubemap>>());
-
-    py::class_<Entity, std::shared_ptr<Entity>>(m, "Entity", "Base class for all game objects.")
+    py::class_<Entity>(m, "Entity", "Base class for all game objects.")
+        .def("getId", &Entity::getId, "ID of the entity, for bulk access through Transforms and Physics3D.")
         .def("getTransform", &Entity::getTransform, py::return_value_policy::reference)
-        .def("getCam", &Entity::getComponent<CameraComponent>, py::return_value_policy::reference)
+        .def("getCam", &Entity::getComponent<Cam>, py::return_value_policy::reference)
         .def("getLight", &Entity::getComponent<Light>, py::return_value_policy::reference)
         .def("getRenderer", &Entity::getComponent<MeshRenderer>, py::return_value_policy::reference)
-        .def("getListener", &Entity::getComponent<AudioListener>, py::return_value_policy::reference)
-        .def("getAudioSource", &Entity::getComponent<AudioSourceComponent>, py::return_value_policy::reference)
-        .def("addCam", &Entity::addComponent<CameraComponent>, py::return_value_policy::reference)
-        .def("addLight", &Entity::addComponent<Light>, py::return_value_policy::reference)
-        .def("addRenderer", &Entity::addComponent<MeshRenderer>, py::return_value_policy::reference)
-        .def("addAudioSource", &Entity::addComponent<AudioSourceComponent>, py::return_value_policy::reference);
-}
\ No newline at end of file
+        .def("getListener", &Entity::getComponent<Listener>, py::return_value_policy::reference)
+        .def("getAudioSource", &Entity::getComponent<SoundSource>, py::return_value_policy::reference)
+        .def("addCam", onMainThread(&Entity::addComponent<Cam, float&, float&, float&, float&>), py::return_value_policy::reference,
+            "Attaches a perspective camera.", "fov"_a, "aspect"_a, "zNear"_a, "zFar"_a)
+        .def("addLight", onMainThread(&Entity::addComponent<Light>), py::return_value_policy::reference)
+        .def("addRenderer", onMainThread(&Entity::addComponent<MeshRenderer, std::shared_ptr<Model>&>), py::return_value_policy::reference,
+            "Attaches a renderer drawing the given model.", "model"_a)
+        .def("addListener", onMainThread(&Entity::addComponent<Listener>), py::return_value_policy::reference)
+        .def("addAudioSource", onMainThread(&Entity::addComponent<SoundSource, bool&>), py::return_value_policy::reference,
+            "Attaches an audio source. Streamed sources decode their clip as it plays, rather than loading it all up front.", "stream"_a = false);
+}
@@ -1,5 +1,8 @@
 #include "kuai.h"
 
+#include "Physics2DScene.h"
+#include "Physics3DScene.h"
+
 #include <random>
 #include <glm/gtx/string_cast.hpp>
 
@@ -13,14 +16,14 @@ struct ProfileResult
 
 std::vector<ProfileResult> profileResults;
 
-class BaseLayer : public Layer
+class SandboxApp : public App
 {
 public:
-	Rc<Entity> myEntity;
-	Rc<Entity> pointLight;
+	Entity myEntity;
+	Entity pointLight;
 
-	float lastX = (float)App::get().getWindow().getWidth() / 2.0;
-	float lastY = (float)App::get().getWindow().getHeight() / 2.0;
+	float lastX = (float)getWindow()->getWidth() / 2.0;
+	float lastY = (float)getWindow()->getHeight() / 2.0;
 	bool firstMouse = true;
 
 	float speed = 10.0f;
@@ -31,122 +34,96 @@ public:
 
 	Rc<Model> cubeModel = makeRc<Model>("C:/Users/David/Documents/cube.obj");
 
-	std::vector<Rc<Entity>> entities;
+	std::vector<Entity> entities;
 
-	BaseLayer() : Layer("Base"), scene(std::make_unique<Scene>())
+	SandboxApp() : myEntity(createEntity()), pointLight(createEntity())
 	{
 		auto whiteTex = makeRc<Texture>();
 
-		std::vector<std::string> faces =
-		{
-			"C:/Users/David/Pictures/skybox/right.jpg",
-			"C:/Users/David/Pictures/skybox/left.jpg",
-			"C:/Users/David/Pictures/skybox/top.jpg",
-			"C:/Users/David/Pictures/skybox/bottom.jpg",
-			"C:/Users/David/Pictures/skybox/front.jpg",
-			"C:/Users/David/Pictures/skybox/back.jpg"
-		};
-
-		auto& cubemap = makeRc<Cubemap>(faces);
-		auto& skybox = makeRc<Skybox>(cubemap);
-
-		auto& skyboxEntity = scene->createEntity();
-		skyboxEntity->addComponent<MeshRenderer>(skybox);
+		auto grassTex = makeRc<Texture>("C:/Users/David/Pictures/grass.png");
+		auto grassMat = makeRc<DefaultMaterial>(grassTex);
 
-		auto& grassTex = makeRc<Texture>("C:/Users/David/Pictures/grass.png");
-		auto& grassMat = makeRc<DefaultMaterial>(grassTex, grassTex, 10.0f);
-
-		auto& plane = makeRc<Model>("C:/Users/David/Documents/plane.obj");
+		auto plane = makeRc<Model>("C:/Users/David/Documents/plane.obj");
 
 		plane->getMaterials()[0] = grassMat;
 
-		auto& planeEntity = scene->createEntity();
-		planeEntity->addComponent<MeshRenderer>(plane);
-		planeEntity->getTransform().setPos(0, -1, -2);
-		planeEntity->getTransform().setScale(1, 0.5f, 1);
+		Entity planeEntity = createEntity();
+		planeEntity.addComponent<MeshRenderer>(plane);
+		planeEntity.getTransform().setPos(0, -1, -2);
+		planeEntity.getTransform().setScale(1, 0.5f, 1);
 
-		auto& model = makeRc<Model>("C:/Users/David/Documents/bunny.obj");
-		auto& modelMat = makeRc<DefaultMaterial>(whiteTex, whiteTex, 30.0f);
-		//modelMat->setReflection(cubemap);
+		auto model = makeRc<Model>("C:/Users/David/Documents/bunny.obj");
+		auto modelMat = makeRc<DefaultMaterial>(whiteTex);
 		model->getMaterials()[0] = modelMat;
 		
-		myEntity = scene->createEntity();
-		myEntity->getTransform().translate(0, -1, -2);
-
-		myEntity->addComponent<MeshRenderer>(model);
+		myEntity.getTransform().translate(0, -1, -2);
 
-		pointLight = scene->createEntity();
-		pointLight->addComponent<Light>().setIntensity(0.5f);
-		pointLight->getTransform().setPos(-1, 4, -2);
+		myEntity.addComponent<MeshRenderer>(model);
 
-		auto& audio = makeRc<AudioClip>("C:/Users/David/Music/jigsaw.wav");
+		pointLight.addComponent<Light>().setIntensity(0.5f);
+		pointLight.getTransform().setPos(-1, 4, -2);
 
-		myEntity->addComponent<AudioSourceComponent>(false);
-		auto& a = myEntity->getComponent<AudioSourceComponent>();
+		auto audio = makeRc<AudioClip>("C:/Users/David/Music/jigsaw.wav");
 
-		a.get()->setAudioClip(audio);
-		a.get()->setPitch(1.1f);
-		a.get()->play();
+		SoundSource& a = myEntity.addComponent<SoundSource>(false);
+		a.setAudioClip(audio);
+		a.setPitch(1.1f);
+		a.play();
 
-		entities.resize(10000);
-		for (auto& entity : entities)
+		for (u32 i = 0; i < 10000; i++)
 		{
-			entity = scene->createEntity();
+			Entity entity = createEntity();
 
-			entity->getTransform().setPos(-20 + rand() % 33, - 30 +rand() % 55, -30 + rand() % 64);
-			entity->getTransform().setScale(glm::vec3(0.3f, 0.3f, 0.3f));
+			entity.getTransform().setPos(-20 + rand() % 33, - 30 +rand() % 55, -30 + rand() % 64);
+			entity.getTransform().setScale(glm::vec3(0.3f, 0.3f, 0.3f));
 
-			entity->addComponent<MeshRenderer>(cubeModel);
+			entity.addComponent<MeshRenderer>(cubeModel);
+			entities.push_back(entity);
 		}
 	}
 
 	void update(float dt) override
 	{
-		scene->update(dt);
-
 		float velocity = speed * dt;
+		Transform& cam = getMainCam()->getTransform();
 
 		if (Input::isKeyPressed(Key::A))
 		{
-			scene->getMainCam().getTransform().translate(
-				-scene->getMainCam().getTransform().getRight() * velocity);
+			cam.translate(-cam.getRight() * velocity);
 		}
 		if (Input::isKeyPressed(Key::D))
 		{
-			scene->getMainCam().getTransform().translate(
-				scene->getMainCam().getTransform().getRight() * velocity);
+			cam.translate(cam.getRight() * velocity);
 		}
 		if (Input::isKeyPressed(Key::W))
 		{
-			scene->getMainCam().getTransform().translate(
-				scene->getMainCam().getTransform().getForward() * velocity);
+			cam.translate(cam.getForward() * velocity);
 		}
 		if (Input::isKeyPressed(Key::S))
 		{
-			scene->getMainCam().getTransform().translate(
-				-scene->getMainCam().getTransform().getForward() * velocity);
+			cam.translate(-cam.getForward() * velocity);
 		}
 		if (Input::isKeyPressed(Key::Space))
 		{
-			scene->getMainCam().getTransform().translate(0, velocity, 0);
+			cam.translate(0, velocity, 0);
 		}
 		if (Input::isKeyPressed(Key::LeftShift))
 		{
-			scene->getMainCam().getTransform().translate(0, -velocity, 0);
+			cam.translate(0, -velocity, 0);
 		}
 
 		counter += dt;
 		
-		myEntity->getTransform().translate(0, 0, -0.05f);
+		myEntity.getTransform().translate(0, 0, -0.05f);
 	}
 
-	void onEvent(Event* event) override
+	void onEvent(Event& event) override
 	{
-		if (event->getEventType() == EventType::MouseMove)
+		if (event.getEventType() == EventType::MouseMove)
 		{
-			MouseMoveEvent* e = (MouseMoveEvent*)event;
-			float xpos = static_cast<float>(e->getX());
-			float ypos = static_cast<float>(e->getY());
+			MouseMoveEvent& e = (MouseMoveEvent&)event;
+			float xpos = static_cast<float>(e.getX());
+			float ypos = static_cast<float>(e.getY());
 			if (firstMouse)
 			{
 				lastX = xpos;
@@ -163,8 +140,8 @@ public:
 			xoffset *= sensitivity; // yaw
 			yoffset *= sensitivity; // pitch
 
-			Transform t = scene->getMainCam().getTransform();
-			scene->getMainCam().getTransform().rotate(yoffset, -xoffset, 0);
+			Transform& t = getMainCam()->getTransform();
+			t.rotate(yoffset, -xoffset, 0);
 
 			// Make sure that when pitch is out of bounds, screen doesn't get flipped
 			if (t.getRot().x > 89.0f) 
@@ -173,18 +150,28 @@ public:
 				t.setRot(-89.0f, t.getRot().y, t.getRot().z);
 		}
 	}
-
-private:
-	Box<Scene> scene;
 };
 
-int main()
+int main(int argc, char** argv)
 {
 	Log::Init();
 
-	App* app = new App();
-	App::get().getWindow().setVSync(false);
-	app->pushLayer(new BaseLayer());
+	// Headless test scenes are picked by name, e.g. "Sandbox physics3d"
+	std::string scene = argc > 1 ? argv[1] : "";
+	if (scene == "physics3d")
+	{
+		Box<Physics3DScene> app = makeBox<Physics3DScene>();
+		app->run();
+		return app->passed() ? 0 : 1;
+	}
+	if (scene == "physics2d")
+	{
+		Box<Physics2DScene> app = makeBox<Physics2DScene>();
+		app->run();
+		return 0;
+	}
+
+	SandboxApp* app = new SandboxApp();
 
 	app->run();
 
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "kuai.h"
+
+using namespace kuai;
+
+/**
+* 10,000 boxes stacked in 100 columns on a static floor, stepped by the app's Physics2DSystem so Box2D's solver work runs
+* across the job system at scale. Run it headless with KU_HEADLESS=1 KU_HEADLESS_FRAMES=N; the time spent simulating
+* each frame is logged at the end.
+*/
+class Physics2DScene : public App
+{
+public:
+	Physics2DScene() : App(WindowProps("Physics2D Stacks"))
+	{
+		Entity floor = createEntity();
+		floor.getTransform().setPos(0.0f, -0.5f, 0.0f);
+		floor.addComponent<BoxCollider2D>().setSize(COLUMNS * 0.75f, 0.5f);
+
+		for (u32 column = 0; column < COLUMNS; column++)
+		{
+			for (u32 row = 0; row < ROWS; row++)
+			{
+				Entity box = createEntity();
+				box.getTransform().setPos((column - COLUMNS / 2.0f) * 1.2f, 0.5f + row * 1.0f, 0.0f);
+				box.addComponent<BoxCollider2D>(); // A 1x1 box
+				box.addComponent<Rigidbody2D>().useGravity = true;
+			}
+		}
+
+		getMainCam()->getTransform().setPos(0.0f, ROWS * 0.5f, ROWS * 1.5f);
+	}
+
+	~Physics2DScene()
+	{
+		if (frames == 0)
+			return;
+
+		KU_INFO("Physics2D, {0} boxes: simulate {1:.3f} ms mean, {2:.3f} ms worst over {3} frames",
+			COLUMNS * ROWS, totalSimulate / frames, worstSimulate, frames);
+	}
+
+	void update(float dt) override
+	{
+		// Timings are for the last finished frame, so the first has nothing yet
+		if (started)
+		{
+			float simulate = getFrameTimings().simulate;
+			totalSimulate += simulate;
+			worstSimulate = std::max(worstSimulate, simulate);
+			frames++;
+		}
+		started = true;
+	}
+
+private:
+	static const u32 COLUMNS = 100;
+	static const u32 ROWS = 100;
+
+	bool started = false;
+	u32 frames = 0;
+	float totalSimulate = 0.0f;	// Milliseconds
+	float worstSimulate = 0.0f;
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "kuai.h"
+#include "kuai/Components/EntityComponentSystem.h"
+#include "kuai/Core/JobSystem.h"
+#include "kuai/Physics/Physics3D.h"
+
+#include <cstring>
+
+using namespace kuai;
+
+/**
+* Steps the same stack of boxes, spheres and capsules in two worlds each frame, one with a single job worker and one with
+* a worker per hardware thread, and checks every body ends up in exactly the same place. Run it headless with
+* KU_HEADLESS=1 KU_HEADLESS_FRAMES=N to step N fixed frames; the step times of each are logged at the end.
+*/
+class Physics3DScene : public App
+{
+public:
+	Physics3DScene() : App(WindowProps("Physics3D Determinism"))
+	{
+		buildStack(singleWorker);
+		buildStack(manyWorkers);
+	}
+
+	~Physics3DScene()
+	{
+		logTimes("1 worker", singleWorker);
+		logTimes(fmt::format("{0} workers", manyWorkers.threadCount - 1), manyWorkers);
+
+		if (firstDivergence)
+			KU_ERROR("Physics3D diverged between thread counts at step {0}", firstDivergence);
+		else
+			KU_INFO("Physics3D matched bit for bit across thread counts over {0} steps", steps);
+	}
+
+	bool passed() const { return firstDivergence == 0; }
+
+	void update(float dt) override
+	{
+		useWorkers(1);
+		step(singleWorker);
+		useWorkers(0); // As many as the app started with, which the rest of the frame uses too
+		step(manyWorkers);
+		steps++;
+
+		for (u32 i = 0; i < singleWorker.bodies.size(); i++)
+		{
+			Transform& a = singleWorker.bodies[i].getTransform();
+			Transform& b = manyWorkers.bodies[i].getTransform();
+
+			glm::vec3 posA = a.getPos(), posB = b.getPos(), rotA = a.getRot(), rotB = b.getRot();
+			bool same = std::memcmp(&posA, &posB, sizeof(glm::vec3)) == 0 && std::memcmp(&rotA, &rotB, sizeof(glm::vec3)) == 0;
+			if (!same && !firstDivergence)
+				firstDivergence = steps;
+		}
+	}
+
+private:
+	// A world of its own, apart from the app's, so each can be stepped with its own thread count
+	struct World
+	{
+		World()
+		{
+			// Everything a transform looks for when it moves
+			ECS.registerComponent<Transform>();
+			ECS.registerComponent<Cam>();
+			ECS.registerComponent<Light>();
+			ECS.registerComponent<Listener>();
+			ECS.registerComponent<SoundSource>();
+			ECS.registerComponent<Rigidbody>();
+			ECS.registerComponent<Collider>();
+
+			physics = ECS.registerSystem<Physics3DSystem>();
+			physics->acceptSubset(true);
+			ECS.setSystemMask<Physics3DSystem>(BIT(ECS.getComponentType<Rigidbody>()) | BIT(ECS.getComponentType<Collider>()));
+		}
+
+		EntityComponentSystem ECS;
+		Rc<Physics3DSystem> physics;
+		std::vector<Entity> bodies;
+
+		u32 threadCount = 0;
+
+		// Totals over every step, in milliseconds
+		float broadphase = 0.0f;
+		float narrowphase = 0.0f;
+		float solve = 0.0f;
+	};
+
+	static void buildStack(World& world)
+	{
+		Entity ground(&world.ECS);
+		ground.getTransform().setPos(0.0f, -0.5f, 0.0f);
+		ground.addComponent<Collider>().setBox(20.0f, 0.5f, 20.0f);
+
+		// Columns of alternating shapes, each a little off centre so the stacks lean and topple into each other
+		const u32 COLUMNS = 6, LAYERS = 12;
+		for (u32 column = 0; column < COLUMNS; column++)
+		{
+			for (u32 layer = 0; layer < LAYERS; layer++)
+			{
+				Entity body(&world.ECS);
+				body.getTransform().setPos(column * 1.1f - 3.0f + layer * 0.03f, 0.5f + layer * 1.01f, (column % 2) * 0.2f);
+				body.getTransform().setRot(0.0f, layer * 7.0f, 0.0f);
+
+				body.addComponent<Rigidbody>();
+				Collider& collider = body.addComponent<Collider>();
+				switch ((column + layer) % 3)
+				{
+					case 0: collider.setBox(0.5f, 0.5f, 0.5f); break;
+					case 1: collider.setSphere(0.5f); break;
+					case 2: collider.setCapsule(0.3f, 0.2f); break;
+				}
+
+				world.bodies.push_back(body);
+			}
+		}
+	}
+
+	static void useWorkers(u32 workers)
+	{
+		// Between jobs, so nothing is in flight while the workers are swapped
+		JobSystem::cleanup();
+		JobSystem::init(workers);
+	}
+
+	void step(World& world)
+	{
+		world.threadCount = JobSystem::getThreadCount();
+		world.physics->step(getFixedTimestep());
+
+		const Physics3DSystem::Stats& stats = world.physics->getStats();
+		world.broadphase += stats.broadphase;
+		world.narrowphase += stats.narrowphase;
+		world.solve += stats.solve;
+	}
+
+	void logTimes(const std::string& name, const World& world)
+	{
+		if (steps == 0)
+			return;
+
+		const Physics3DSystem::Stats& stats = world.physics->getStats();
+		KU_INFO("Physics3D, {0}: {1} bodies, {2} contacts, {3} islands", name, stats.bodies, stats.contacts, stats.islands);
+		KU_INFO("Physics3D, {0}: broadphase {1:.3f} ms, narrowphase {2:.3f} ms, solve {3:.3f} ms (mean per step)",
+			name, world.broadphase / steps, world.narrowphase / steps, world.solve / steps);
+	}
+
+private:
+	World singleWorker;
+	World manyWorkers;
+
+	u32 steps = 0;
+	u32 firstDivergence = 0; // Step the worlds first differed on, counting from 1, or 0 if they never have
+};
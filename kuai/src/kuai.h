@@ -22,4 +22,5 @@
 #include "kuai/Renderer/Mesh.h"
 #include "kuai/Renderer/Model.h"
 
-#include "kuai/Sound/AudioClip.h"
\ No newline at end of file
+#include "kuai/Sound/AudioClip.h"
+#include "kuai/Sound/Mixer.h"
\ No newline at end of file
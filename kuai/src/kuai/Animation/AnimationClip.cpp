@@ -0,0 +1,50 @@
+#include "kpch.h"
+#include "AnimationClip.h"
+
+namespace kuai {
+	AnimationClip::AnimationClip(const std::string& name, float duration, float sampleRate, u32 jointCount)
+		: name(name), duration(std::max(duration, 0.0f)), sampleRate(sampleRate), jointCount(jointCount)
+	{
+		KU_CORE_ASSERT(sampleRate > 0.0f, "Animation clips need a positive sample rate.");
+
+		// A key at both ends, so the last frame lands exactly on the duration
+		frameCount = (u32)std::ceil(this->duration * sampleRate) + 1;
+
+		translations.resize(frameCount * jointCount, glm::vec4(0.0f));
+		rotations.resize(frameCount * jointCount, glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		scales.resize(frameCount * jointCount, glm::vec4(1.0f, 1.0f, 1.0f, 0.0f));
+	}
+
+	void AnimationClip::setKey(u32 frame, u32 joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale)
+	{
+		u32 index = frame * jointCount + joint;
+		translations[index] = glm::vec4(translation, 0.0f);
+		rotations[index] = rotation;
+		scales[index] = glm::vec4(scale, 0.0f);
+	}
+
+	void AnimationClip::sample(float time, bool loop, Pose& out) const
+	{
+		out.resize(jointCount);
+		if (jointCount == 0)
+			return;
+
+		if (loop && duration > 0.0f)
+		{
+			time = std::fmod(time, duration);
+			if (time < 0.0f)
+				time += duration;
+		}
+
+		float frame = std::clamp(time * sampleRate, 0.0f, (float)(frameCount - 1));
+		u32 frame0 = std::min((u32)frame, frameCount > 1 ? frameCount - 2 : 0);
+		u32 frame1 = std::min(frame0 + 1, frameCount - 1);
+		float t = std::min(frame - frame0, 1.0f);
+
+		u32 offset0 = frame0 * jointCount;
+		u32 offset1 = frame1 * jointCount;
+		lerpVectors(&translations[offset0], &translations[offset1], t, out.translations.data(), jointCount);
+		nlerpRotations(&rotations[offset0], &rotations[offset1], t, out.rotations.data(), jointCount);
+		lerpVectors(&scales[offset0], &scales[offset1], t, out.scales.data(), jointCount);
+	}
+}
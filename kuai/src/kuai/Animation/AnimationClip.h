@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Pose.h"
+
+namespace kuai {
+	/** \class AnimationClip
+	*	\brief Keyframed motion of a skeleton's joints, resampled at a fixed rate when loaded.
+	*
+	*	Every joint has a key on every frame and each frame's keys sit together, so sampling is two straight runs
+	*	of lerps over contiguous memory with no searching for keys.
+	*/
+	class AnimationClip
+	{
+	public:
+		/**
+		* Make a clip for jointCount joints lasting duration seconds, with keys every 1 / sampleRate seconds.
+		* Every key starts at the identity; fill them in with setKey.
+		*/
+		AnimationClip(const std::string& name, float duration, float sampleRate, u32 jointCount);
+
+		/**
+		* Set where a joint is, relative to its parent, on a frame. Rotations are quaternions stored x, y, z, w.
+		*/
+		void setKey(u32 frame, u32 joint, const glm::vec3& translation, const glm::vec4& rotation, const glm::vec3& scale);
+
+		/**
+		* Write the pose at time seconds into out, which is resized to fit. Looping clips wrap around, others hold their ends.
+		*/
+		void sample(float time, bool loop, Pose& out) const;
+
+		const std::string& getName() const { return name; }
+		float getDuration() const { return duration; }
+		float getSampleRate() const { return sampleRate; }
+		u32 getFrameCount() const { return frameCount; }
+		u32 getJointCount() const { return jointCount; }
+
+	private:
+		std::string name;
+		float duration;
+		float sampleRate;
+		u32 frameCount;
+		u32 jointCount;
+
+		// Indexed by frame * jointCount + joint
+		std::vector<glm::vec4> translations;
+		std::vector<glm::vec4> rotations;
+		std::vector<glm::vec4> scales;
+	};
+}
@@ -0,0 +1,88 @@
+#include "kpch.h"
+#include "AnimationSystem.h"
+#include "AnimationClip.h"
+#include "Skeleton.h"
+
+#include "kuai/Components/Entity.h"
+#include "kuai/Components/EntityComponentSystem.h"
+#include "kuai/Core/JobSystem.h"
+#include "kuai/Renderer/Renderer.h"
+
+namespace kuai {
+	// Animators per job; each is a few microseconds of work, so small groups still spread a crowd across every thread
+	static const u32 ANIMATOR_GROUP_SIZE = 8;
+
+	void AnimationSystem::update(float dt)
+	{
+		KU_PROFILE_FUNCTION();
+
+		using Clock = std::chrono::steady_clock;
+		Clock::time_point start = Clock::now();
+
+		// Give every animator with a skinned model its range of the palette
+		jobs.clear();
+		u32 jointCount = 0;
+		for (auto& entity : entities)
+		{
+			Animator& animator = entity.getComponent<Animator>();
+			animator.hasPalette = false;
+
+			if (!entity.hasComponent<MeshRenderer>())
+				continue;
+
+			Skeleton* skeleton = entity.getComponent<MeshRenderer>().getModel()->getSkeleton().get();
+			if (!skeleton || skeleton->getJointCount() == 0)
+				continue;
+
+			animator.hasPalette = true;
+			animator.paletteOffset = jointCount;
+			jointCount += skeleton->getJointCount();
+
+			jobs.push_back({ &animator, skeleton });
+		}
+
+		palettes.resize(jointCount);
+
+		JobSystem::parallelFor(jobs.size(), ANIMATOR_GROUP_SIZE, [this, dt](u32 start, u32 end)
+		{
+			for (u32 i = start; i < end; i++)
+				animate(*jobs[i].animator, *jobs[i].skeleton, dt);
+		});
+
+		Renderer::setBonePalettes(palettes);
+
+		stats.animators = jobs.size();
+		stats.joints = jointCount;
+		stats.update = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+	}
+
+	void AnimationSystem::animate(Animator& animator, const Skeleton& skeleton, float dt)
+	{
+		float step = dt * animator.speed;
+		animator.time += step;
+
+		// Clips made for another skeleton can't be sampled onto this one
+		if (animator.clip && animator.clip->getJointCount() == skeleton.getJointCount())
+			animator.clip->sample(animator.time, animator.loop, animator.pose);
+		else
+			animator.pose = skeleton.getBindPose();
+
+		if (animator.prevClip)
+		{
+			animator.prevTime += step;
+			animator.fadeElapsed += dt;
+
+			if (animator.fadeElapsed >= animator.fadeTime || animator.prevClip->getJointCount() != skeleton.getJointCount())
+			{
+				animator.prevClip = nullptr;
+			}
+			else
+			{
+				animator.prevClip->sample(animator.prevTime, animator.prevLoop, animator.fadePose);
+				blendPoses(animator.fadePose, animator.pose, animator.fadeElapsed / animator.fadeTime, animator.pose);
+			}
+		}
+
+		skeleton.calcPalette(animator.pose, &palettes[animator.paletteOffset]);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "kuai/Components/System.h"
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	// Forward declarations
+	class Animator;
+	class Skeleton;
+
+	/** \class AnimationSystem
+	*	\brief Advances every Animator and turns its pose into skinning matrices for the GPU.
+	*
+	*	Animators are sampled, blended and posed in parallel on the job system, each writing its own range of one
+	*	shared palette. The palette is uploaded to a storage buffer that the skinned shader reads, so skinned meshes
+	*	are still drawn instanced, each instance finding its matrices by its offset.
+	*/
+	class AnimationSystem : public System
+	{
+	public:
+		/**
+		* Advance animations by dt and build this frame's skinning matrices. Runs once a frame before rendering is gathered.
+		*/
+		void update(float dt) override;
+
+		/**
+		* Counts and time (in milliseconds) for the last update.
+		*/
+		struct Stats
+		{
+			u32 animators = 0;
+			u32 joints = 0;
+			float update = 0.0f;
+		};
+		const Stats& getStats() const { return stats; }
+
+	private:
+		struct Job
+		{
+			Animator* animator;
+			const Skeleton* skeleton;
+		};
+
+		void animate(Animator& animator, const Skeleton& skeleton, float dt);
+
+	private:
+		std::vector<Job> jobs;
+		std::vector<glm::mat4> palettes;
+
+		Stats stats;
+	};
+}
@@ -0,0 +1,71 @@
+#include "kpch.h"
+#include "Pose.h"
+
+#ifdef KU_SIMD_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace kuai {
+	void blendPoses(const Pose& a, const Pose& b, float weight, Pose& out)
+	{
+		KU_CORE_ASSERT(a.getJointCount() == b.getJointCount() && a.getJointCount() == out.getJointCount(), "Blended poses need the same joints.");
+
+		u32 count = a.getJointCount();
+		lerpVectors(a.translations.data(), b.translations.data(), weight, out.translations.data(), count);
+		nlerpRotations(a.rotations.data(), b.rotations.data(), weight, out.rotations.data(), count);
+		lerpVectors(a.scales.data(), b.scales.data(), weight, out.scales.data(), count);
+	}
+
+	void lerpVectors(const glm::vec4* a, const glm::vec4* b, float t, glm::vec4* out, u32 count)
+	{
+#ifdef KU_SIMD_SSE
+		const __m128 vt = _mm_set1_ps(t);
+		for (u32 i = 0; i < count; i++)
+		{
+			__m128 va = _mm_loadu_ps(&a[i].x);
+			__m128 vb = _mm_loadu_ps(&b[i].x);
+			_mm_storeu_ps(&out[i].x, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vt)));
+		}
+#else
+		for (u32 i = 0; i < count; i++)
+		{
+			out[i] = a[i] + (b[i] - a[i]) * t;
+		}
+#endif
+	}
+
+	void nlerpRotations(const glm::vec4* a, const glm::vec4* b, float t, glm::vec4* out, u32 count)
+	{
+#ifdef KU_SIMD_SSE
+		const __m128 vt = _mm_set1_ps(t);
+		const __m128 signMask = _mm_set1_ps(-0.0f);
+		for (u32 i = 0; i < count; i++)
+		{
+			__m128 va = _mm_loadu_ps(&a[i].x);
+			__m128 vb = _mm_loadu_ps(&b[i].x);
+
+			// Dot product in every lane
+			__m128 dot = _mm_mul_ps(va, vb);
+			dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(2, 3, 0, 1)));
+			dot = _mm_add_ps(dot, _mm_shuffle_ps(dot, dot, _MM_SHUFFLE(1, 0, 3, 2)));
+
+			// q and -q are the same rotation; flip b onto a's side so the blend takes the short way round
+			vb = _mm_xor_ps(vb, _mm_and_ps(dot, signMask));
+
+			__m128 r = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), vt));
+
+			__m128 lengthSq = _mm_mul_ps(r, r);
+			lengthSq = _mm_add_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(2, 3, 0, 1)));
+			lengthSq = _mm_add_ps(lengthSq, _mm_shuffle_ps(lengthSq, lengthSq, _MM_SHUFFLE(1, 0, 3, 2)));
+
+			_mm_storeu_ps(&out[i].x, _mm_div_ps(r, _mm_sqrt_ps(lengthSq)));
+		}
+#else
+		for (u32 i = 0; i < count; i++)
+		{
+			glm::vec4 target = glm::dot(a[i], b[i]) < 0.0f ? -b[i] : b[i];
+			out[i] = glm::normalize(a[i] + (target - a[i]) * t);
+		}
+#endif
+	}
+}
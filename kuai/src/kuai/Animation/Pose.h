@@ -0,0 +1,42 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	/**
+	* Every joint of a skeleton positioned relative to its parent. Translations, rotations (quaternions stored x, y, z, w)
+	* and scales are kept in separate arrays of four floats each, so poses are sampled and blended one register per joint.
+	*/
+	struct Pose
+	{
+		std::vector<glm::vec4> translations;	// w unused
+		std::vector<glm::vec4> rotations;
+		std::vector<glm::vec4> scales;			// w unused
+
+		void resize(u32 jointCount)
+		{
+			translations.resize(jointCount);
+			rotations.resize(jointCount);
+			scales.resize(jointCount);
+		}
+
+		u32 getJointCount() const { return translations.size(); }
+	};
+
+	/**
+	* Blend from a towards b by weight, into out (which may be a or b). All three must have the same joint count.
+	*/
+	void blendPoses(const Pose& a, const Pose& b, float weight, Pose& out);
+
+	// @cond
+	/**
+	* out[i] = a[i] + (b[i] - a[i]) * t, for count elements.
+	*/
+	void lerpVectors(const glm::vec4* a, const glm::vec4* b, float t, glm::vec4* out, u32 count);
+
+	/**
+	* Normalised lerp between quaternions along the shortest arc, for count elements.
+	*/
+	void nlerpRotations(const glm::vec4* a, const glm::vec4* b, float t, glm::vec4* out, u32 count);
+	// @endcond
+}
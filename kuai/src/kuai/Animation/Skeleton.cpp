@@ -0,0 +1,52 @@
+#include "kpch.h"
+#include "Skeleton.h"
+
+namespace kuai {
+	u32 Skeleton::addJoint(const std::string& name, i32 parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+	{
+		KU_CORE_ASSERT(parent < (i32)parents.size(), "A joint's parent must be added before it.");
+		KU_CORE_ASSERT(parents.size() < MAX_JOINTS, "Too many joints in skeleton.");
+
+		u32 joint = parents.size();
+		names.push_back(name);
+		parents.push_back(parent);
+		inverseBinds.push_back(glm::mat4(1.0f));
+
+		bindPose.translations.push_back(glm::vec4(translation, 0.0f));
+		bindPose.rotations.push_back(glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w));
+		bindPose.scales.push_back(glm::vec4(scale, 0.0f));
+
+		return joint;
+	}
+
+	i32 Skeleton::findJoint(const std::string& name) const
+	{
+		auto it = std::find(names.begin(), names.end(), name);
+		return it == names.end() ? -1 : (i32)(it - names.begin());
+	}
+
+	void Skeleton::calcPalette(const Pose& pose, glm::mat4* palette) const
+	{
+		u32 count = getJointCount();
+
+		// Parents come first, so one pass takes every joint to model space; the palette holds those transforms until the second pass
+		for (u32 i = 0; i < count; i++)
+		{
+			const glm::vec4& r = pose.rotations[i];
+			const glm::vec4& s = pose.scales[i];
+
+			glm::mat4 local = glm::mat4_cast(glm::quat(r.w, r.x, r.y, r.z));
+			local[0] *= s.x;
+			local[1] *= s.y;
+			local[2] *= s.z;
+			local[3] = glm::vec4(glm::vec3(pose.translations[i]), 1.0f);
+
+			palette[i] = parents[i] < 0 ? local : palette[parents[i]] * local;
+		}
+
+		for (u32 i = 0; i < count; i++)
+		{
+			palette[i] = globalInverse * palette[i] * inverseBinds[i];
+		}
+	}
+}
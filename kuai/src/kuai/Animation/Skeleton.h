@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Pose.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+namespace kuai {
+	const u32 MAX_JOINTS = 65536; // Skin weights store joint indices as u16
+
+	/** \class Skeleton
+	*	\brief The joint hierarchy a skinned model is animated by. Parents always come before their children.
+	*/
+	class Skeleton
+	{
+	public:
+		/**
+		* Add a joint, returning its index. parent must already have been added, or be -1 for a root.
+		* The transform places the joint relative to its parent when the mesh was bound to it.
+		*/
+		u32 addJoint(const std::string& name, i32 parent, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
+		/**
+		* Set the matrix taking a mesh's space into a joint's space at bind time (Assimp's bone offset matrix).
+		*/
+		void setInverseBind(u32 joint, const glm::mat4& inverseBind) { inverseBinds[joint] = inverseBind; }
+
+		/**
+		* Set the matrix taking the skeleton's root space into the model's space.
+		*/
+		void setGlobalInverse(const glm::mat4& globalInverse) { this->globalInverse = globalInverse; }
+
+		u32 getJointCount() const { return parents.size(); }
+		i32 getParent(u32 joint) const { return parents[joint]; }
+		const std::string& getJointName(u32 joint) const { return names[joint]; }
+
+		/**
+		* Index of the joint with the given name, or -1 if there isn't one.
+		*/
+		i32 findJoint(const std::string& name) const;
+
+		/**
+		* The pose the skeleton was bound to the mesh in.
+		*/
+		const Pose& getBindPose() const { return bindPose; }
+
+		/**
+		* Turn a pose into skinning matrices, one per joint, taking bind space vertices to their posed position in model space.
+		*/
+		void calcPalette(const Pose& pose, glm::mat4* palette) const;
+
+	private:
+		std::vector<std::string> names;
+		std::vector<i32> parents;
+		std::vector<glm::mat4> inverseBinds;
+		Pose bindPose;
+
+		glm::mat4 globalInverse = glm::mat4(1.0f);
+	};
+}
@@ -9,6 +9,8 @@
 #include "kuai/Sound/AudioManager.h"
 #include "kuai/Sound/AudioSource.h"
 
+#include "kuai/Animation/AnimationClip.h"
+
 namespace kuai {
 	glm::vec3 Transform::getPos() const
 	{
@@ -104,6 +106,31 @@ namespace kuai {
 		return modelMatrix;
 	}
 
+	glm::mat4 Transform::getInterpolatedModelMatrix(float alpha) const
+	{
+		if (!movedInStep || pos != stepPos || rot != stepRot || scale != stepScale)
+			return modelMatrix;
+
+		return glm::translate(glm::mat4(1.0f), glm::mix(prevPos, pos, alpha)) *
+			glm::toMat4(glm::slerp(glm::quat(prevRot), glm::quat(rot), alpha)) *
+			glm::scale(glm::mat4(1.0f), glm::mix(prevScale, scale, alpha));
+	}
+
+	void Transform::beginFixedStep()
+	{
+		prevPos = pos;
+		prevRot = rot;
+		prevScale = scale;
+	}
+
+	void Transform::endFixedStep()
+	{
+		stepPos = pos;
+		stepRot = rot;
+		stepScale = scale;
+		movedInStep = pos != prevPos || rot != prevRot || scale != prevScale;
+	}
+
 	void Transform::updateComponents()
 	{	
 		if (hasComponent<Cam>())
@@ -129,6 +156,7 @@ namespace kuai {
 
 	void Transform::calcModelMatrix()
 	{
+		version++;
 		modelMatrix = glm::translate(glm::mat4(1.0f), pos) *
 			glm::toMat4(glm::quat(rot)) *
 			glm::scale(glm::mat4(1.0f), scale);
@@ -150,7 +178,7 @@ namespace kuai {
 
 	SoundSource::~SoundSource()
 	{
-		AudioManager::destroyAudioSource(source->getId());
+		AudioManager::destroyAudioSource(source);
 	}
 
 	void SoundSource::play()
@@ -213,6 +241,16 @@ namespace kuai {
 		source->setRefDist(refDist);
 	}
 
+	i32 SoundSource::getPriority() const
+	{
+		return source->getPriority();
+	}
+
+	void SoundSource::setPriority(i32 priority)
+	{
+		source->setPriority(priority);
+	}
+
 	bool SoundSource::isLoop() const
 	{
 		return source->isLoop();
@@ -223,6 +261,16 @@ namespace kuai {
 		source->setLoop(loop);
 	}
 
+	u32 SoundSource::getBus() const
+	{
+		return source->getBus();
+	}
+
+	void SoundSource::setBus(u32 bus)
+	{
+		source->setBus(bus);
+	}
+
 	void SoundSource::update()
 	{
 		source->setPos(getTransform().getPos());
@@ -269,6 +317,128 @@ namespace kuai {
 		this->friction = friction;
 	}
 
+	Collider::Shape Collider::getShape() const
+	{
+		return shape;
+	}
+
+	glm::vec3 Collider::getHalfExtents() const
+	{
+		return halfExtents;
+	}
+
+	void Collider::setBox(float x, float y, float z)
+	{
+		shape = Shape::Box;
+		halfExtents = glm::vec3(x, y, z);
+		version++;
+	}
+
+	float Collider::getRadius() const
+	{
+		return radius;
+	}
+
+	void Collider::setSphere(float radius)
+	{
+		shape = Shape::Sphere;
+		this->radius = radius;
+		version++;
+	}
+
+	float Collider::getHalfHeight() const
+	{
+		return halfHeight;
+	}
+
+	void Collider::setCapsule(float radius, float halfHeight)
+	{
+		shape = Shape::Capsule;
+		this->radius = radius;
+		this->halfHeight = halfHeight;
+		version++;
+	}
+
+	glm::vec3 Collider::getOffset() const
+	{
+		return offset;
+	}
+
+	void Collider::setOffset(float x, float y, float z)
+	{
+		offset = glm::vec3(x, y, z);
+		version++;
+	}
+
+	float Collider::getRestitution() const
+	{
+		return restitution;
+	}
+
+	void Collider::setRestitution(float restitution)
+	{
+		this->restitution = restitution;
+		version++;
+	}
+
+	float Collider::getFriction() const
+	{
+		return friction;
+	}
+
+	void Collider::setFriction(float friction)
+	{
+		this->friction = friction;
+		version++;
+	}
+
+	void Animator::play(Rc<AnimationClip> clip, float fadeTime, bool loop)
+	{
+		if (this->clip && fadeTime > 0.0f)
+		{
+			prevClip = this->clip;
+			prevTime = time;
+			prevLoop = this->loop;
+			this->fadeTime = fadeTime;
+			fadeElapsed = 0.0f;
+		}
+		else
+		{
+			prevClip = nullptr;
+		}
+
+		this->clip = clip;
+		this->loop = loop;
+		time = 0.0f;
+	}
+
+	void Animator::stop()
+	{
+		clip = nullptr;
+		prevClip = nullptr;
+		time = 0.0f;
+	}
+
+	Rc<AnimationClip> Animator::getClip() const
+	{
+		return clip;
+	}
+
+	bool Animator::isPlaying() const
+	{
+		return clip && (loop || time < clip->getDuration());
+	}
+
+	float Animator::getTime() const
+	{
+		return time;
+	}
+
+	void Animator::setTime(float time)
+	{
+		this->time = time;
+	}
+
 	Light::LightType Light::getType() const
 	{
 		return type;
@@ -329,5 +499,22 @@ namespace kuai {
 	{
 		this->angle = angle;
 	}
+
+	float Light::getRange() const
+	{
+		// Solve intensity / (1 + linear * d + quadratic * d^2) = cutoff for d
+		const float cutoff = 0.01f;
+		if (intensity <= cutoff)
+			return 0.0f; // Already below the cutoff at the light itself
+
+		float c = 1.0f - intensity / cutoff;
+
+		if (quadratic > 0.0f)
+			return std::max((-linear + glm::sqrt(linear * linear - 4.0f * quadratic * c)) / (2.0f * quadratic), 0.0f);
+		if (linear > 0.0f)
+			return std::max(-c / linear, 0.0f);
+
+		return std::numeric_limits<float>::max(); // No attenuation, so the light reaches everything
+	}
 }
 
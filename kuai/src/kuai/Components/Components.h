@@ -12,6 +12,8 @@
 
 #include "kuai/Sound/AudioClip.h"
 
+#include "kuai/Animation/Pose.h"
+
 #include "kuai/Events/Event.h"
 
 #include <glm/glm.hpp>
@@ -81,17 +83,39 @@ namespace kuai {
 		glm::vec3 getForward() const;
 
 		glm::mat4 getModelMatrix() const;
+		/**
+		* Model matrix blended between the states before and after the last fixed step; alpha is how far through the next step the frame is.
+		* Transforms moved outside fixedUpdate since that step just return their current matrix.
+		*/
+		glm::mat4 getInterpolatedModelMatrix(float alpha) const;
 
 	private:
 		void updateComponents();
 
 		void calcModelMatrix();
 
+		void beginFixedStep();
+		void endFixedStep();
+
 		glm::vec3 pos = { 0.0f, 0.0f, 0.0f };
 		glm::vec3 rot = { 0.0f, 0.0f, 0.0f };
 		glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
 
 		glm::mat4 modelMatrix = glm::mat4(1.0f);
+
+		// State either side of the last fixed step, for interpolation
+		glm::vec3 prevPos = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 prevRot = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 prevScale = { 1.0f, 1.0f, 1.0f };
+		glm::vec3 stepPos = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 stepRot = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 stepScale = { 1.0f, 1.0f, 1.0f };
+		bool movedInStep = false;
+
+		u32 version = 0; // Bumped on every change, so systems tracking the transform can spot it cheaply
+
+		friend class TransformSystem;
+		friend class SpatialIndexSystem;
 	};
 
 	class Rigidbody2D : public Component
@@ -135,6 +159,84 @@ namespace kuai {
 		float friction = 0.5f;
 	};
 
+	/** \class Rigidbody
+	*	\brief Moves an entity with 3D rigid body physics. Needs a Collider to collide with anything.
+	*/
+	class Rigidbody : public Component
+	{
+	public:
+		Rigidbody() = default;
+
+		float mass = 1.0f;
+		float drag = 0.0f;
+		float angularDrag = 0.05f;
+
+		glm::vec3 velocity = { 0.0f, 0.0f, 0.0f };
+		glm::vec3 angularVelocity = { 0.0f, 0.0f, 0.0f }; // Radians per second
+
+		bool useGravity = true;
+
+		/**
+		* Kinematic bodies move only by their velocity or Transform; they push dynamic bodies but nothing pushes them.
+		*/
+		bool isKinematic = false;
+	};
+
+	/** \class Collider
+	*	\brief Gives an entity a 3D collision shape: a box, sphere or capsule. Sizes are scaled by the Transform.
+	*		   An entity with a collider but no Rigidbody is static.
+	*/
+	class Collider : public Component
+	{
+	public:
+		enum class Shape
+		{
+			Box = 0,
+			Sphere = 1,
+			Capsule = 2
+		};
+
+		Collider() = default;
+
+		Shape getShape() const;
+
+		glm::vec3 getHalfExtents() const;
+		void setBox(float x, float y, float z);
+
+		float getRadius() const;
+		void setSphere(float radius);
+
+		/**
+		* Distance from the centre to the centre of each end cap; the capsule runs along the local y axis.
+		*/
+		float getHalfHeight() const;
+		void setCapsule(float radius, float halfHeight);
+
+		glm::vec3 getOffset() const;
+		void setOffset(float x, float y, float z);
+
+		float getRestitution() const;
+		void setRestitution(float restitution);
+
+		float getFriction() const;
+		void setFriction(float friction);
+
+	private:
+		Shape shape = Shape::Box;
+
+		glm::vec3 halfExtents = { 0.5f, 0.5f, 0.5f };
+		float radius = 0.5f;
+		float halfHeight = 0.5f;
+		glm::vec3 offset = { 0.0f, 0.0f, 0.0f };
+
+		float restitution = 0.2f;
+		float friction = 0.5f;
+
+		u32 version = 0; // Bumped by every change, so physics can spot edits cheaply
+
+		friend class Physics3DSystem;
+	};
+
 	/** \class MeshRenderer
 	*	\brief Renders models or meshes to the screen.
 	*/
@@ -156,6 +258,64 @@ namespace kuai {
 		Rc<Model> model;
 	};
 
+	// Forward declaration
+	class AnimationClip;
+
+	/** \class Animator
+	*	\brief Plays animation clips on the skinned model of the entity's MeshRenderer, crossfading from one to the next.
+	*		   Skinned meshes are only drawn on entities with an Animator.
+	*/
+	class Animator : public Component
+	{
+	public:
+		Animator() = default;
+
+		/**
+		* Play clip from its start, blending in over fadeTime seconds from whatever was playing before.
+		* Clips must have been made for the model's skeleton, such as those from Model::getAnimations().
+		*/
+		void play(Rc<AnimationClip> clip, float fadeTime = 0.0f, bool loop = true);
+
+		/**
+		* Stop playing, returning the model to its bind pose.
+		*/
+		void stop();
+
+		Rc<AnimationClip> getClip() const;
+
+		/**
+		* Whether a clip is playing; clips that don't loop stop once they reach their end, holding their last pose.
+		*/
+		bool isPlaying() const;
+
+		float getTime() const;
+		void setTime(float time);
+
+		float speed = 1.0f; // Playback rate, 1 being the clip's own speed
+
+	private:
+		Rc<AnimationClip> clip;
+		float time = 0.0f;
+		bool loop = true;
+
+		// Clip being faded out
+		Rc<AnimationClip> prevClip;
+		float prevTime = 0.0f;
+		bool prevLoop = true;
+		float fadeTime = 0.0f;
+		float fadeElapsed = 0.0f;
+
+		// Scratch space for sampling, kept so animating doesn't allocate every frame
+		Pose pose;
+		Pose fadePose;
+
+		bool hasPalette = false;	// Whether a palette was made for this animator last frame
+		u32 paletteOffset = 0;		// Index of its first skinning matrix in the frame's palettes
+
+		friend class AnimationSystem;
+		friend class RenderSystem;
+	};
+
 	class SpriteRenderer : public Component
 	{
 	public:
@@ -221,6 +381,11 @@ namespace kuai {
 		float getAngle() const;
 		void setAngle(float angle);
 
+		/**
+		* Distance at which this light's contribution becomes negligible. Used to cull lights.
+		*/
+		float getRange() const;
+
 	private:
 		LightType type = LightType::Point;
 
@@ -260,6 +425,7 @@ namespace kuai {
 
 	/** \class SoundSource
 	*	\brief Acts like a speaker; generates sounds in a scene. Must be provided with an AudioClip to play.
+	*		   Only the loudest sources are mixed; the rest play silently until they can be heard again.
 	*/
 	class SoundSource : public Component
 	{
@@ -286,9 +452,21 @@ namespace kuai {
 		float getRefDist() const;
 		void setRefDist(float refDist);
 
+		/**
+		* Sources with a higher priority are given voices before any with a lower one, however quiet (default 0).
+		*/
+		i32 getPriority() const;
+		void setPriority(i32 priority);
+
 		bool isLoop() const;
 		void setLoop(bool loop);
 
+		/**
+		* The Mixer bus the sound plays through (default Mixer::SFX, or Mixer::MUSIC when streamed).
+		*/
+		u32 getBus() const;
+		void setBus(u32 bus);
+
 	private:
 		void update();
 
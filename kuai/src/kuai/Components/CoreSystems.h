@@ -2,7 +2,13 @@
 
 #include "System.h"
 
+#include "kuai/Core/JobSystem.h"
+#include "kuai/Renderer/Renderer.h"
+#include "kuai/Renderer/Frustum.h"
+#include "kuai/Renderer/MeshOptimizer.h"
+#include "kuai/Renderer/RenderGraph.h"
 #include "kuai/Renderer/TextureArray.h"
+#include "kuai/Physics/SpatialIndex.h"
 
 namespace kuai {
 
@@ -13,6 +19,79 @@ namespace kuai {
 		EVENT_CLASS_CATEGORY(SystemEventCategory)
 	};
 
+	/**
+	* Snapshots every transform around each fixed step so rendering can interpolate between steps.
+	*/
+	class TransformSystem : public System
+	{
+	public:
+		void update(float dt) {}
+
+		void beginFixedStep()
+		{
+			for (auto& entity : entities)
+			{
+				entity.getTransform().beginFixedStep();
+			}
+		}
+
+		void endFixedStep()
+		{
+			for (auto& entity : entities)
+			{
+				entity.getTransform().endFixedStep();
+			}
+		}
+
+		// Bulk access for scripting, so a whole batch of entities crosses into the engine in one call.
+		// Each returns false at the first entity without a transform, having handled the ones before it.
+		// Rotations are in degrees, as with Transform::getRot().
+
+		bool getPositions(const EntityID* ids, u32 count, glm::vec3* out) { return gather(ids, count, out, &Transform::getPos); }
+		bool getRotations(const EntityID* ids, u32 count, glm::vec3* out) { return gather(ids, count, out, &Transform::getRot); }
+		bool getScales(const EntityID* ids, u32 count, glm::vec3* out) { return gather(ids, count, out, &Transform::getScale); }
+
+		bool setPositions(const EntityID* ids, u32 count, const glm::vec3* values)
+		{
+			return scatter(ids, count, values, [](Transform& transform, const glm::vec3& pos) { transform.setPos(pos); });
+		}
+
+		bool setRotations(const EntityID* ids, u32 count, const glm::vec3* values)
+		{
+			return scatter(ids, count, values, [](Transform& transform, const glm::vec3& rot) { transform.setRot(rot); });
+		}
+
+		bool setScales(const EntityID* ids, u32 count, const glm::vec3* values)
+		{
+			return scatter(ids, count, values, [](Transform& transform, const glm::vec3& scale) { transform.setScale(scale); });
+		}
+
+	private:
+		bool gather(const EntityID* ids, u32 count, glm::vec3* out, glm::vec3 (Transform::*get)() const)
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				if (!ECS->hasComponent<Transform>(ids[i]))
+					return false;
+				out[i] = (ECS->getComponent<Transform>(ids[i]).*get)();
+			}
+			return true;
+		}
+
+		template<typename Set>
+		bool scatter(const EntityID* ids, u32 count, const glm::vec3* values, Set set)
+		{
+			// Through the setters, so components following the transform and the spatial index see the change
+			for (u32 i = 0; i < count; i++)
+			{
+				if (!ECS->hasComponent<Transform>(ids[i]))
+					return false;
+				set(ECS->getComponent<Transform>(ids[i]), values[i]);
+			}
+			return true;
+		}
+	};
+
 	class RenderSystem : public System
 	{
 	public:
@@ -23,16 +102,62 @@ namespace kuai {
 
 		void update(float dt)
 		{
-			// Update model matrices every frame
-			// TODO: inefficient, only update when transform moves
+			KU_PROFILE_FUNCTION();
+
+			// Gather the mesh instances of entities some camera can see, with their world space bounding spheres,
+			// ready to be culled precisely by each camera
+			std::lock_guard<std::mutex> lock(dataMutex);
+
 			for (auto& pair : shaderToEntities)
 			{
-				std::vector<glm::mat4> modelMatrices;
-				for (auto& innerPair : pair.second)
+				shaderToInstances[pair.first].clear();
+				// Materials are gathered here too, so rendering never has to look at the scene
+				shaderToMaterials[pair.first].clear();
+			}
+
+			float alpha = App::get().getInterpolationAlpha();
+			for (EntityID id : App::get().getSpatialIndex().getVisibleEntities())
+			{
+				if (!ECS->hasComponent<MeshRenderer>(id))
+					continue;
+
+				glm::mat4 modelMatrix = ECS->getComponent<Transform>(id).getInterpolatedModelMatrix(alpha);
+				float maxScale = std::sqrt(std::max({ glm::dot(modelMatrix[0], modelMatrix[0]), glm::dot(modelMatrix[1], modelMatrix[1]), glm::dot(modelMatrix[2], modelMatrix[2]) }));
+
+				Rc<Model> model = ECS->getComponent<MeshRenderer>(id).getModel();
+				auto& modelMaterials = model->getMaterials();
+
+				// Skinned instances find their joint matrices from the palette offset kept in the model matrix's bottom row
+				const Animator* animator = ECS->hasComponent<Animator>(id) ? &ECS->getComponent<Animator>(id) : nullptr;
+				bool posed = animator && animator->hasPalette;
+
+				for (size_t i = 0; i < model->getMeshes().size(); i++)
 				{
-					modelMatrices.push_back(ECS->getComponent<Transform>(innerPair.first).getModelMatrix());
+					Shader* shader = modelMaterials[i]->getShader();
+					if (shader->getVertexFormat() == VertexFormat::SKINNED && !posed)
+						continue;
+
+					// The model's materials go to each of its shaders once
+					bool seen = false;
+					for (size_t j = 0; j < i && !seen; j++)
+						seen = modelMaterials[j]->getShader() == shader;
+					if (!seen)
+					{
+						std::vector<Rc<Material>>& materials = shaderToMaterials[shader];
+						materials.insert(materials.end(), modelMaterials.begin(), modelMaterials.end());
+					}
+
+					Mesh* mesh = model->getMeshes()[i].get();
+
+					Instance instance;
+					instance.modelMatrix = modelMatrix;
+					if (shader->getVertexFormat() == VertexFormat::SKINNED)
+						instance.modelMatrix[0][3] = (float)animator->paletteOffset;
+					instance.centre = glm::vec3(modelMatrix * glm::vec4(mesh->getBoundsCentre(), 1.0f));
+					instance.radius = mesh->getBoundsRadius() * maxScale;
+					instance.meshId = mesh->getId();
+					shaderToInstances[shader].push_back(instance);
 				}
-				shaderToModelMatrices[pair.first] = modelMatrices;
 			}
 		}
 
@@ -42,202 +167,292 @@ namespace kuai {
 
 			Rc<Model> model = ECS->getComponent<MeshRenderer>(id).getModel();
 
+			std::lock_guard<std::mutex> lock(dataMutex);
+
 			// For every mesh in the model
 			for (size_t i = 0; i < model->getMeshes().size(); i++)
 			{
 				Rc<Mesh> mesh = model->getMeshes()[i];
-				u32 meshId = mesh->getId();
 				Shader* shader = model->getMaterials()[i]->getShader();
 
-				IndirectCommand& cmd = shaderToMeshCommand[shader][meshId];
-				cmd.instanceCount = ++shaderMeshToNumInstances[shader][meshId]; // Increment instance count by one
-
-				if (cmd.instanceCount == 1) // First instance, so add its vertex data and indices to back of the list
+				MeshGeometry& geometry = shaderToMeshes[shader][mesh->getId()];
+				if (geometry.instances++ == 0) // First instance, so add its vertex data and indices to back of the list
 				{
 					std::vector<Vertex>& vertexData = shaderToVertexData[shader];
 					std::vector<u32>& indices = shaderToIndices[shader];
-					// Setup this mesh's render command
-					cmd.count = mesh->indices.size();				// Number of indices mesh uses
-					cmd.firstIndex = indices.size();				// Offset of first index
-					cmd.baseVertex = vertexData.size();				// Offset of first vertex
-					cmd.baseInstance = shaderToInstances[shader];	// Offset of first instance
-
-					shaderToVertexDataSizes[shader][meshId] = mesh->vertexData.size();
-					shaderToIndicesSizes[shader][meshId] = mesh->indices.size();
+
+					geometry.firstIndex = indices.size();		// Offset of first index
+					geometry.baseVertex = vertexData.size();	// Offset of first vertex
+					geometry.vertexCount = mesh->vertexData.size();
+					geometry.indexCount = mesh->indices.size();
+					geometry.lods = mesh->getLods();
+
 					// Insert the data at the end
 					vertexData.insert(vertexData.end(), mesh->vertexData.begin(), mesh->vertexData.end());
 					indices.insert(indices.end(), mesh->indices.begin(), mesh->indices.end());
 
+					if (shader->getVertexFormat() == VertexFormat::SKINNED)
+					{
+						// Meshes without weights of their own follow the first joint
+						std::vector<SkinWeights>& skinWeights = shaderToSkinWeights[shader];
+						if (mesh->isSkinned())
+							skinWeights.insert(skinWeights.end(), mesh->getSkinWeights().begin(), mesh->getSkinWeights().end());
+						else
+							skinWeights.resize(skinWeights.size() + mesh->vertexData.size(), { { 0, 0, 0, 0 }, { 1.0f, 0.0f, 0.0f, 0.0f } });
+					}
+
 					dataChanged = true;
 				}
 
 				shaderToEntities[shader][id] = 1;
-
-				shaderToMeshCommand[shader][meshId] = cmd;
-
-				shaderToInstances[shader]++;
 			}
-
-			setCommands();
 		}
 
 		void removeEntity(EntityID id) override
 		{
 			Rc<Model> model = ECS->getComponent<MeshRenderer>(id).getModel();
 
+			std::unique_lock<std::mutex> lock(dataMutex);
+
 			for (size_t i = 0; i < model->getMeshes().size(); i++)
 			{
-				Rc<Mesh> mesh = model->getMeshes()[i];
-				u32 meshId = mesh->getId();
+				u32 meshId = model->getMeshes()[i]->getId();
 				Shader* shader = model->getMaterials()[i]->getShader();
 
-				IndirectCommand& cmd = shaderToMeshCommand[shader][meshId];
-				cmd.instanceCount = --shaderMeshToNumInstances[shader][meshId]; // Decrement instance count by one
+				auto& meshes = shaderToMeshes[shader];
+				MeshGeometry& geometry = meshes[meshId];
 
-				if (cmd.instanceCount == 0) // No more instances of this mesh left -> remove its vertex data and indices from lists
+				if (--geometry.instances == 0) // No more instances of this mesh left -> remove its vertex data and indices from lists
 				{
 					std::vector<Vertex>& vertexData = shaderToVertexData[shader];
 					std::vector<u32>& indices = shaderToIndices[shader];
 
-					size_t vertexDataSize = shaderToVertexDataSizes[shader][meshId];
-					size_t indicesSize = shaderToIndicesSizes[shader][meshId];
+					u32 firstIndex = geometry.firstIndex;
+					u32 indexCount = geometry.indexCount;
+					u32 vertexCount = geometry.vertexCount;
 
-					vertexData.erase(vertexData.begin() + cmd.baseVertex, vertexData.begin() + cmd.baseVertex + vertexDataSize);
-					indices.erase(indices.begin() + cmd.firstIndex, indices.begin() + cmd.firstIndex + indicesSize);
+					vertexData.erase(vertexData.begin() + geometry.baseVertex, vertexData.begin() + geometry.baseVertex + vertexCount);
+					if (shader->getVertexFormat() == VertexFormat::SKINNED)
+					{
+						std::vector<SkinWeights>& skinWeights = shaderToSkinWeights[shader];
+						skinWeights.erase(skinWeights.begin() + geometry.baseVertex, skinWeights.begin() + geometry.baseVertex + vertexCount);
+					}
+					indices.erase(indices.begin() + firstIndex, indices.begin() + firstIndex + indexCount);
+					meshes.erase(meshId);
 
 					// Take away vertex data size and indices size from offset for all meshes that are further along in the list
-					for (auto& pair : shaderToMeshCommand)
+					for (auto& pair : meshes)
 					{
-						for (auto& innerPair : pair.second)
+						if (pair.second.firstIndex > firstIndex)
 						{
-							if (innerPair.second.baseInstance > cmd.baseInstance)
-							{
-								innerPair.second.baseVertex -= vertexDataSize;
-								innerPair.second.firstIndex -= indicesSize;
-							}
+							pair.second.baseVertex -= vertexCount;
+							pair.second.firstIndex -= indexCount;
 						}
 					}
 
-					shaderToVertexDataSizes[shader].erase(meshId);
-					shaderToIndicesSizes[shader].erase(meshId);
-					shaderMeshToNumInstances[shader].erase(meshId);
-
 					dataChanged = true;
 				}
-				// Decrement base instances of all meshes that are further along the list as we deleted an instance 
-				for (auto& pair : shaderToMeshCommand)
-				{
-					for (auto& innerPair : pair.second)
-					{
-						if (innerPair.second.baseInstance > cmd.baseInstance)
-						{
-							innerPair.second.baseInstance--;
-						}
-					}
-				}
 
-				if (cmd.instanceCount == 0)
-				{
-					shaderToMeshCommand[shader].erase(meshId); // Remove the render command
-				}
-	
 				shaderToEntities[shader].erase(id);
-
-				shaderToInstances[shader]--;
 			}
-
-			setCommands();
+			lock.unlock();
 
 			System::removeEntity(id);
 		}
 
-		void setCommands()
+		void render()
 		{
-			// Resize model matrices
-			for (auto& pair : shaderToInstances)
+			KU_PROFILE_FUNCTION();
+
+			Renderer::clear();
+
+			// Entities can be added and removed by the next frame's simulation while this one renders
+			std::lock_guard<std::mutex> lock(dataMutex);
+
+			const glm::mat4& viewMatrix = Renderer::getViewMatrix();
+			const glm::mat4& projMatrix = Renderer::getProjMatrix();
+			Frustum frustum(projMatrix * viewMatrix);
+
+			// Projected radius = radius * projScale / depth for perspective cameras, radius * projScale for orthographic ones
+			float projScale = projMatrix[1][1];
+			bool perspective = projMatrix[3][3] == 0.0f;
+
+			// Each shader is recorded into its own command list in parallel, then the lists are replayed in order
+			shaders.clear();
+			// Entries are created up front as the recording jobs may only look them up
+			for (auto& pair : shaderToMeshes)
 			{
-				pair.first->getVertexArray()->getVertexBuffers()[1]->reset(nullptr, pair.second * sizeof(glm::mat4), DrawHint::DYNAMIC);
+				shaders.push_back(pair.first);
+				batches[pair.first];
+				shaderToInstances[pair.first];
+				shaderToMaterials[pair.first];
+				shaderToVertexData[pair.first];
+				shaderToIndices[pair.first];
+				shaderToSkinWeights[pair.first];
 			}
 
-			int i = 0;
-			for (auto& pair : shaderToMeshCommand)
+			JobSystem::parallelFor(shaders.size(), 1, [&](u32 start, u32 end)
 			{
-				pair.first->bind();
-				std::vector<IndirectCommand> commands;
-				for (auto& innerPair : pair.second)
+				for (u32 i = start; i < end; i++)
 				{
-					commands.push_back(innerPair.second);
+					recordShader(shaders[i], frustum, viewMatrix, projScale, perspective);
 				}
+			});
 
-				pair.first->setIndirectBufData(commands);
-				i++;
+			for (Shader* shader : shaders)
+			{
+				RenderCommandList& commandList = batches[shader].commandList;
+				commandList.execute();
+				commandList.reset();
 			}
+			dataChanged = false;
 		}
 
-		void render()
+		void renderCallback(RenderEvent& e) { render(); }
+
+	private:
+		// Records one shader's draw for the current camera. Runs on any thread, so only touches this shader's batch.
+		void recordShader(Shader* shader, const Frustum& frustum, const glm::mat4& viewMatrix, float projScale, bool perspective)
 		{
-			Renderer::clear();
+			KU_PROFILE_FUNCTION();
+
+			ShaderBatch& batch = batches.at(shader);
+			RenderCommandList& commandList = batch.commandList;
+			auto& meshes = shaderToMeshes.at(shader);
+
+			commandList.bindShader(shader);
 
-			for (auto& pair : shaderToInstances)
+			// TODO: change this to a big texture array or something that doesn't send possibly duplicate materials
+			for (auto& material : shaderToMaterials.at(shader))
 			{
-				Shader* shader = pair.first;
-				shader->bind();
+				commandList.bindMaterial(material.get(), 0);
+			}
 
-				for (auto& pair : shaderToEntities[shader])
+			if (dataChanged)
+			{
+				auto& vertexData = shaderToVertexData.at(shader);
+				VertexBuffer* vertexBuffer = shader->getVertexArray()->getVertexBuffers()[0].get();
+				if (shader->getVertexFormat() == VertexFormat::COMPACT)
 				{
-					Rc<Model> model = ECS->getComponent<MeshRenderer>(pair.first).getModel();
-
-					for (int i = 0; i < model->getMeshes().size(); i++)
-					{
-						// TODO: change this to a big texture array or something that doesn't send possibly duplicate materials
-						Rc<Mesh> mesh = model->getMeshes()[i];
-						Rc<Material> material = model->getMaterials()[i];
-						material->bind(0);
-					}
+					MeshOptimizer::packVertices(vertexData, batch.compactVertexData);
+					commandList.resetVertexData(vertexBuffer, batch.compactVertexData.data(), batch.compactVertexData.size() * sizeof(CompactVertex));
+				}
+				else
+				{
+					commandList.resetVertexData(vertexBuffer, vertexData.data(), vertexData.size() * sizeof(Vertex));
 				}
 
-				if (dataChanged)
+				if (shader->getVertexFormat() == VertexFormat::SKINNED)
 				{
-					auto& vertexData = shaderToVertexData[shader];
-					shader->getVertexArray()->getVertexBuffers()[0]->reset(vertexData.data(), vertexData.size() * sizeof(Vertex), DrawHint::DYNAMIC);
+					auto& skinWeights = shaderToSkinWeights.at(shader);
+					commandList.resetVertexData(shader->getVertexArray()->getVertexBuffers()[2].get(), skinWeights.data(), skinWeights.size() * sizeof(SkinWeights));
+				}
 
-					auto& indices = shaderToIndices[shader];
+				auto& indices = shaderToIndices.at(shader);
 
-					shader->getVertexArray()->setIndexBuffer(makeRc<IndexBuffer>(indices.data(), indices.size()));
-				}
-				else
+				commandList.setIndexData(shader->getVertexArray().get(), indices.data(), indices.size());
+			}
+
+			// Cull instances against the camera and sort the survivors into buckets by mesh and level of detail
+			for (Instance& instance : shaderToInstances.at(shader))
+			{
+				auto it = meshes.find(instance.meshId);
+				if (it == meshes.end() || !frustum.intersectsSphere(instance.centre, instance.radius))
+					continue;
+
+				MeshGeometry& geometry = it->second;
+
+				float screenSize = instance.radius * projScale;
+				if (perspective)
+					screenSize /= std::max(-(viewMatrix * glm::vec4(instance.centre, 1.0f)).z, 0.0001f);
+
+				geometry.visible[selectLod(geometry.lods, screenSize)].push_back(instance.modelMatrix);
+			}
+
+			// One command per visible mesh level, with its instances' matrices laid out contiguously from baseInstance
+			batch.commands.clear();
+			batch.modelMatrices.clear();
+			for (auto& meshPair : meshes)
+			{
+				MeshGeometry& geometry = meshPair.second;
+				for (u32 lod = 0; lod < geometry.lods.size(); lod++)
 				{
-					auto& modelMatrices = shaderToModelMatrices[shader];
-					shader->getVertexArray()->getVertexBuffers()[1]->setData(modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+					std::vector<glm::mat4>& visible = geometry.visible[lod];
+					if (visible.empty())
+						continue;
+
+					IndirectCommand cmd;
+					cmd.count = geometry.lods[lod].indexCount;
+					cmd.instanceCount = visible.size();
+					cmd.firstIndex = geometry.firstIndex + geometry.lods[lod].firstIndex;
+					cmd.baseVertex = geometry.baseVertex;
+					cmd.baseInstance = batch.modelMatrices.size();
+					batch.commands.push_back(cmd);
+
+					batch.modelMatrices.insert(batch.modelMatrices.end(), visible.begin(), visible.end());
+					visible.clear();
 				}
-
-				Renderer::render(*shader);
 			}
-			dataChanged = false;
+
+			if (batch.commands.empty())
+				return;
+
+			commandList.resetVertexData(shader->getVertexArray()->getVertexBuffers()[1].get(), batch.modelMatrices.data(), batch.modelMatrices.size() * sizeof(glm::mat4));
+			commandList.setIndirectCommands(shader, batch.commands.data(), batch.commands.size());
+			commandList.draw(shader);
 		}
 
-		void renderCallback(RenderEvent& e) { render(); }
+		// A mesh's place in its shader's vertex and index lists
+		struct MeshGeometry
+		{
+			u32 instances = 0;
+			u32 firstIndex = 0;
+			u32 baseVertex = 0;
+			u32 vertexCount = 0;
+			u32 indexCount = 0;
+
+			std::vector<MeshLod> lods;
+			std::array<std::vector<glm::mat4>, MAX_LODS> visible; // Model matrices of instances that passed culling, per level of detail
+		};
+
+		struct Instance
+		{
+			glm::mat4 modelMatrix;
+			glm::vec3 centre;
+			float radius;
+			u32 meshId;
+		};
 
-	private:
 		// Maps shader to entities within its control
 		std::unordered_map<Shader*, std::unordered_map<u32, u32>> shaderToEntities;
-		// Total number of instances shader owns
-		std::unordered_map<Shader*, size_t> shaderToInstances;
+		// Every mesh instance drawn by each shader this frame
+		std::unordered_map<Shader*, std::vector<Instance>> shaderToInstances;
 
-		// Maps shader and mesh to the number of instances they have.
-		std::unordered_map<Shader*, std::unordered_map<u32, size_t>> shaderMeshToNumInstances;
+		// For each shader and for each mesh, store where its geometry lives
+		std::unordered_map<Shader*, std::unordered_map<u32, MeshGeometry>> shaderToMeshes;
 
-		// Map each shader to a list of vertices, indices and model matrices.
+		// Map each shader to a list of vertices and indices.
 		std::unordered_map<Shader*, std::vector<Vertex>> shaderToVertexData;
 		std::unordered_map<Shader*, std::vector<u32>> shaderToIndices;
-		std::unordered_map<Shader*, std::vector<glm::mat4>> shaderToModelMatrices;
+		// Joint weights of every vertex, parallel to the vertex list, for skinned shaders
+		std::unordered_map<Shader*, std::vector<SkinWeights>> shaderToSkinWeights;
 
-		// For each shader and for each mesh, store the sizes of their vertex and index lists.
-		std::unordered_map<Shader*, std::unordered_map<u32, size_t>> shaderToVertexDataSizes;
-		std::unordered_map<Shader*, std::unordered_map<u32, size_t>> shaderToIndicesSizes;
+		// Per shader recording state, reused every render so the lists and scratch space keep their memory
+		struct ShaderBatch
+		{
+			RenderCommandList commandList;
+			std::vector<IndirectCommand> commands;
+			std::vector<glm::mat4> modelMatrices;
+			std::vector<CompactVertex> compactVertexData;
+		};
+		std::unordered_map<Shader*, ShaderBatch> batches;
+		std::vector<Shader*> shaders;
+
+		// Materials of every instance drawn with each shader, gathered in update
+		std::unordered_map<Shader*, std::vector<Rc<Material>>> shaderToMaterials;
 
-		// For each shader and for each mesh, store its corresponding render command.
-		std::unordered_map<Shader*, std::unordered_map<u32, IndirectCommand>> shaderToMeshCommand;
+		// Guards the geometry lists, which entity changes edit while the render thread reads them
+		std::mutex dataMutex;
 
 		bool dataChanged = false;
 	};
@@ -264,9 +479,11 @@ namespace kuai {
 
 			cmd.instanceCount++;
 
-			texArray->insert(ECS->getComponent<SpriteRenderer>(id).getTexture());
-
-			setCommand();
+			Rc<Texture> texture = ECS->getComponent<SpriteRenderer>(id).getTexture();
+			RenderCommandList commandList;
+			commandList.callback([this, texture]() { texArray->insert(texture); });
+			setCommand(commandList);
+			Renderer::submit(std::move(commandList));
 		}
 
 		void removeEntity(EntityID id) override
@@ -275,34 +492,48 @@ namespace kuai {
 
 			cmd.instanceCount--;
 
-			texArray->remove(ECS->getComponent<SpriteRenderer>(id).getTexture());
-
-			setCommand();
+			Rc<Texture> texture = ECS->getComponent<SpriteRenderer>(id).getTexture();
+			RenderCommandList commandList;
+			commandList.callback([this, texture]() { texArray->remove(texture); });
+			setCommand(commandList);
+			Renderer::submit(std::move(commandList));
 		}
 
-		void setCommand()
+		// Entities change during simulation, which may not own the GL context, so the buffer changes are recorded
+		void setCommand(RenderCommandList& commandList)
 		{
-			Shader::sprite->getVertexArray()->getVertexBuffers()[1]->reset(nullptr, cmd.instanceCount * sizeof(float) * 2, DrawHint::DYNAMIC);
-			Shader::sprite->getVertexArray()->getVertexBuffers()[2]->reset(nullptr, cmd.instanceCount * sizeof(glm::mat4), DrawHint::DYNAMIC);
-
-			Shader::sprite->setIndirectBufData({ cmd });
+			u32 instanceCount = cmd.instanceCount;
+			commandList.callback([instanceCount]()
+			{
+				Shader::sprite->getVertexArray()->getVertexBuffers()[1]->reset(nullptr, instanceCount * sizeof(float) * 2, DrawHint::DYNAMIC);
+				Shader::sprite->getVertexArray()->getVertexBuffers()[2]->reset(nullptr, instanceCount * sizeof(glm::mat4), DrawHint::DYNAMIC);
+			});
+			// The count as of this change, not whatever cmd holds when the list is replayed
+			IndirectCommand frameCmd = cmd;
+			commandList.setIndirectCommands(Shader::sprite, &frameCmd, 1);
 		}
 
 		void update(float dt)
 		{
+			KU_PROFILE_FUNCTION();
+
 			texData.clear();
 			modelMatrices.clear();
+			float alpha = App::get().getInterpolationAlpha();
 			for (auto& entity : entities)
 			{
 				SpriteRenderer& sr = entity.getComponent<SpriteRenderer>();
 
 				texData.push_back(sr.getTexture()->getId());
 				texData.push_back(sr.getTilingFactor());
-				modelMatrices.push_back(entity.getTransform().getModelMatrix());
+				modelMatrices.push_back(entity.getTransform().getInterpolatedModelMatrix(alpha));
 			}
 
-			Shader::sprite->getVertexArray()->getVertexBuffers()[1]->setData(texData.data(), texData.size() * sizeof(float));
-			Shader::sprite->getVertexArray()->getVertexBuffers()[2]->setData(modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+			// Recorded rather than uploaded directly, so this can run alongside the other systems off the main thread
+			RenderCommandList commandList;
+			commandList.setVertexData(Shader::sprite->getVertexArray()->getVertexBuffers()[1].get(), texData.data(), texData.size() * sizeof(float));
+			commandList.setVertexData(Shader::sprite->getVertexArray()->getVertexBuffers()[2].get(), modelMatrices.data(), modelMatrices.size() * sizeof(glm::mat4));
+			Renderer::submit(std::move(commandList));
 		}
 
 		void render()
@@ -325,49 +556,47 @@ namespace kuai {
 	class LightSystem : public System
 	{
 	public:
-		void insertEntity(EntityID id) override
-		{
-			System::insertEntity(id);
-
-			int numLights = std::max((int)entities.size(), 10);
-			Shader::base->setUniform("Lights", "numLights", &numLights, sizeof(int));
-		}
-
-		void removeEntity(EntityID id) override
+		void update(float dt)
 		{
-			System::removeEntity(id);
+			KU_PROFILE_FUNCTION();
 
-			int numLights = std::max((int)entities.size(), 10);
-			Shader::base->setUniform("Lights", "numLights", &numLights, sizeof(int));
-		}
+			lights.clear();
+			lights.reserve(entities.size());
 
-		void update(float dt)
-		{
-			u32 id = 0;
+			// Directional lights go first; they light every cluster so the shader handles them separately
+			u32 dirLightCount = 0;
 			for (auto& entity : entities)
 			{
-				Light& l = entity.getComponent<Light>();
-
-				int type = (int)l.getType();
-				float intensity = l.getIntensity();
-				float linear = l.getLinear();
-				float quadratic = l.getQuadratic();
-				float cutoff = glm::cos(glm::radians(l.getAngle()));
-
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].type", &type, sizeof(int));
+				if (entity.getComponent<Light>().getType() == Light::LightType::Directional)
+				{
+					lights.push_back(toGpuLight(entity.getComponent<Light>()));
+					dirLightCount++;
+				}
+			}
 
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].pos", &l.getTransform().getPos()[0], sizeof(glm::vec3));
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].dir", &l.getTransform().getForward()[0], sizeof(glm::vec3));
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].col", &l.getCol()[0], sizeof(glm::vec3));
+			for (auto& entity : entities)
+			{
+				if (entity.getComponent<Light>().getType() != Light::LightType::Directional)
+				{
+					lights.push_back(toGpuLight(entity.getComponent<Light>()));
+				}
+			}
 
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].intensity", &intensity, sizeof(float));
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].linear", &linear, sizeof(float));
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].quadratic", &quadratic, sizeof(float));
-				Shader::base->setUniform("Lights", "lights[" + std::to_string(id) + "].cutoff", &cutoff, sizeof(float));
+			Renderer::setLights(lights, dirLightCount);
+		}
 
-				id++;
-			}
+	private:
+		GpuLight toGpuLight(Light& l)
+		{
+			GpuLight light;
+			light.posRange = glm::vec4(l.getTransform().getPos(), l.getRange());
+			light.dirCutoff = glm::vec4(l.getTransform().getForward(), glm::cos(glm::radians(l.getAngle())));
+			light.colIntensity = glm::vec4(l.getCol(), l.getIntensity());
+			light.params = glm::vec4(l.getLinear(), l.getQuadratic(), (float)l.getType(), 0.0f);
+			return light;
 		}
+
+		std::vector<GpuLight> lights;
 	};
 
 	class CameraSystem : public System
@@ -375,23 +604,65 @@ namespace kuai {
 	public:
 		void update(float dt)
 		{
+			KU_PROFILE_FUNCTION();
+
+			Window* window = App::get().getWindow();
+
+			graph.reset();
+			// Headless windows stand in for the screen with a framebuffer
+			RenderResource backbuffer = window->getFramebuffer()
+				? graph.importFramebuffer("Backbuffer", window->getFramebuffer())
+				: graph.importBackbuffer("Backbuffer", window->getWidth(), window->getHeight());
+
 			for (auto& entity : entities)
 			{
-				Cam& cam = entity.getComponent<Cam>();
-				Renderer::setCamera(cam);
-
-				if (cam.getTarget())
-				{
-					cam.getTarget()->bind();
-					ECS->notifySystems(RenderEvent());
-					cam.getTarget()->unbind();
-					Renderer::setViewport(0, 0, App::get().getWindow()->getWidth(), App::get().getWindow()->getHeight());
-				}
-				else if (cam.isMain)
-				{
-					ECS->notifySystems(RenderEvent());
-				}
+				Cam* cam = &entity.getComponent<Cam>();
+
+				// Cameras with a target draw into it and only the main camera draws to the screen.
+				// Any other camera writes nothing, so the graph culls its pass.
+				RenderResource target = INVALID_RENDER_RESOURCE;
+				if (cam->getTarget())
+					target = graph.importFramebuffer("CameraTarget", cam->getTarget());
+				else if (cam->isMain)
+					target = backbuffer;
+
+				graph.addPass("Camera",
+					[target](RenderGraph::Builder& builder)
+					{
+						if (target != INVALID_RENDER_RESOURCE)
+							builder.write(target);
+					},
+					// The camera is copied so the pass draws it as it was now, even if it runs on the render thread while the scene moves on
+					[this, camera = Camera(*cam)](RenderGraph::Context& context) mutable
+					{
+						Renderer::setCamera(camera);
+						RenderEvent e;
+						ECS->notifySystems(e);
+					});
 			}
+
+			App::get().onRenderGraph(graph, backbuffer);
+
+			graph.compile();
+
+			windowWidth = window->getWidth();
+			windowHeight = window->getHeight();
 		}
+
+		/**
+		* Run the graph built by the last update. Must be called on the thread owning the GL context.
+		*/
+		void render()
+		{
+			KU_PROFILE_FUNCTION();
+
+			graph.execute();
+
+			Renderer::setViewport(0, 0, windowWidth, windowHeight);
+		}
+
+	private:
+		RenderGraph graph;
+		u32 windowWidth = 0, windowHeight = 0;
 	};
 }
\ No newline at end of file
@@ -1,83 +1,15 @@
 #pragma once
 
 #include <memory>
-#include <list>
 
 #include "EntityManager.h"
 #include "ComponentManager.h"
 #include "SystemManager.h"
 
-#include "kuai/Events/Event.h"
+#include "kuai/Events/EventBus.h"
 
 namespace kuai {
 
-	class IFnHandler
-	{
-	public:
-		void exec(Event& event) { call(event); }
-	private:
-		virtual void call(Event& event) = 0;
-	};
-	
-	// Class to hold reference to member function and offset of method to be called
-	template<class T, class EventType>
-	class FnHandler : public IFnHandler
-	{
-	public:
-		typedef void (T::* MemberFn)(EventType&);
-
-		FnHandler(T* instance, MemberFn memberFn) : instance{ instance }, memberFn{ memberFn } {}
-
-		void call(Event& event)
-		{
-			// Cast event to the correct type and call member function
-			(instance->*memberFn)(*(EventType*)(&event));
-		}
-	private:
-		T* instance; // Pointer to instance class
-
-		MemberFn memberFn;
-	};
-
-	using HandlerList = std::list<IFnHandler*>;
-
-	class EventBus
-	{
-	public:
-		template<typename EventType>
-		void notify(EventType& event)
-		{
-			HandlerList* handlers = subscribers[typeid(EventType).name()];
-			
-			if (!handlers)
-				return;
-
-			for (auto& handler : *handlers) 
-			{
-				if (handler != nullptr) 
-				{
-					handler->exec(event);
-				}
-			}
-		}
-
-		template<typename T, typename EventType>
-		void subscribe(T* instance, void (T::*memberFn)(EventType&))
-		{
-			HandlerList* handlers = subscribers[typeid(EventType).name()];
-
-			if (!handlers) // First time init
-			{
-				handlers = new HandlerList();
-				subscribers[typeid(EventType).name()] = handlers;
-			}
-			
-			handlers->push_back(new FnHandler<T, EventType>(instance, memberFn));
-		}
-	private:
-		std::unordered_map<const char*, HandlerList*> subscribers;
-	};
-
 	class EntityComponentSystem
 	{
 	public:
@@ -179,12 +111,37 @@ namespace kuai {
 			eventBus->notify(event);
 		}
 
+		/**
+		* Queue an event for systems to handle at the start of the next frame. Safe from any thread.
+		*/
+		template<typename EventType>
+		void postEvent(const EventType& event)
+		{
+			eventBus->post(event);
+		}
+
+		/**
+		* Handle the events posted since the last call. Called by the App once a frame.
+		*/
+		void dispatchEvents()
+		{
+			eventBus->dispatchQueued();
+		}
+
+		/**
+		* Subscribing and unsubscribing are for the main thread, while the render thread is idle; see EventBus.
+		*/
 		template<typename T, typename EventType>
 		void subscribeSystem(T* instance, void (T::* memberFn)(EventType&))
 		{
 			eventBus->subscribe(instance, memberFn);
 		}
 
+		void unsubscribeSystem(void* instance)
+		{
+			eventBus->unsubscribe(instance);
+		}
+
 	private:
 		Box<EntityManager> entityManager;
 		Box<ComponentManager> componentManager;
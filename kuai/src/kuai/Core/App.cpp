@@ -2,14 +2,25 @@
 #include "App.h"
 #include "Log.h"
 
+#include "Input.h"
+#include "JobSystem.h"
+
 #include "kuai/Renderer/Renderer.h"
+#include "kuai/Renderer/RenderState.h"
 #include "kuai/Renderer/Geometry.h"
 
 #include "kuai/Sound/AudioManager.h"
+#include "kuai/Sound/Mixer.h"
 
 #include "kuai/Components/EntityComponentSystem.h"
 #include "kuai/Components/CoreSystems.h"
 
+#include "kuai/Physics/Physics2D.h"
+#include "kuai/Physics/Physics3D.h"
+#include "kuai/Physics/SpatialIndex.h"
+
+#include "kuai/Animation/AnimationSystem.h"
+
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
@@ -19,14 +30,16 @@ namespace kuai {
 
 	App* App::instance = nullptr;
 
-	App::App()
+	App::App(const WindowProps& props)
 	{
 		Log::Init();
 
 		KU_CORE_ASSERT(!instance, "Application already exists");
 		instance = this;
 
-		addWindow(WindowProps());
+		JobSystem::init();
+
+		addWindow(props);
 		running = true;
 
 		Renderer::init();
@@ -43,8 +56,34 @@ namespace kuai {
 		ECS->registerComponent<Light>();
 		ECS->registerComponent<MeshRenderer>();
 		ECS->registerComponent<SpriteRenderer>();
+		ECS->registerComponent<Rigidbody2D>();
+		ECS->registerComponent<BoxCollider2D>();
+		ECS->registerComponent<Rigidbody>();
+		ECS->registerComponent<Collider>();
 		ECS->registerComponent<Listener>();
 		ECS->registerComponent<SoundSource>();
+		ECS->registerComponent<Animator>();
+
+		transformSys = ECS->registerSystem<TransformSystem>();
+		transformSys->acceptSubset(true);
+		ECS->setSystemMask<TransformSystem>(BIT(ECS->getComponentType<Transform>()));
+
+		physics2DSys = ECS->registerSystem<Physics2DSystem>();
+		physics2DSys->acceptSubset(true);
+		ECS->setSystemMask<Physics2DSystem>(BIT(ECS->getComponentType<Rigidbody2D>()) | BIT(ECS->getComponentType<BoxCollider2D>()));
+
+		physics3DSys = ECS->registerSystem<Physics3DSystem>();
+		physics3DSys->acceptSubset(true);
+		ECS->setSystemMask<Physics3DSystem>(BIT(ECS->getComponentType<Rigidbody>()) | BIT(ECS->getComponentType<Collider>()));
+
+		spatialSys = ECS->registerSystem<SpatialIndexSystem>();
+		spatialSys->acceptSubset(true);
+		ECS->setSystemMask<SpatialIndexSystem>(BIT(ECS->getComponentType<Transform>()));
+		Mixer::setOcclusionScene(spatialSys.get()); // Sounds behind the scene's meshes are muffled
+
+		animationSys = ECS->registerSystem<AnimationSystem>();
+		animationSys->acceptSubset(true);
+		ECS->setSystemMask<AnimationSystem>(BIT(ECS->getComponentType<Animator>()));
 
 		cameraSys = ECS->registerSystem<CameraSystem>();
 		cameraSys->acceptSubset(true);
@@ -79,27 +118,179 @@ namespace kuai {
 
 	void App::run() 
 	{
+		using Clock = std::chrono::steady_clock;
+		auto millisSince = [](Clock::time_point start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); };
+
 		while (running) 
 		{
+			if (pipelined != renderThread.isRunning())
+			{
+				if (pipelined)
+					renderThread.start(getWindow());
+				else
+					renderThread.stop();
+			}
+
+			if (threadedUpdate != updateThread.isRunning())
+			{
+				if (threadedUpdate)
+					updateThread.start();
+				else
+					updateThread.stop();
+			}
+
 			float elapsedTime = timer.getElapsed(); // Time since last frame
 			//KU_CORE_INFO("FPS: {0}", 1.0f / elapsedTime);
-						
-			if (!minimised)
+
+			for (auto& window : windows)
 			{
-				update(elapsedTime);
-				cameraSys->update(elapsedTime);
-				renderSys->update(elapsedTime);
-				spriteSys->update(elapsedTime);
-				lightSys->update(elapsedTime);
+				window->pollEvents();
 			}
-			for (auto& window : windows)
+			Input::beginFrame(); // Rolls what the windows captured into this frame's snapshot
+			Clock::time_point inputTime = Clock::now(); // Everything simulated this frame sees input from here on
+
+			// Events posted from other threads since last frame, before anything simulates
+			ECS->dispatchEvents();
+
+			if (!minimised)
 			{
-				window->update();
+				// What the last frame's threaded update deferred, before anything simulates or is extracted
+				applyDeferred();
+
+				// Run as many fixed steps as the frame took, leaving the remainder for next frame.
+				// A long stall (breakpoint, loading) is capped rather than replayed all at once.
+				accumulator += std::min(elapsedTime, fixedTimestep * maxFixedSteps);
+				auto transforms = std::static_pointer_cast<TransformSystem>(transformSys);
+				for (u32 step = 0; step < maxFixedSteps && accumulator >= fixedTimestep; step++)
+				{
+					transforms->beginFixedStep();
+					fixedUpdate(fixedTimestep);
+					physics2DSys->step(fixedTimestep);
+					physics3DSys->step(fixedTimestep);
+					transforms->endFixedStep();
+					accumulator -= fixedTimestep;
+				}
+				accumulator = std::min(accumulator, fixedTimestep);
+				interpolationAlpha = accumulator / fixedTimestep;
+
+				float fixedTime = millisSince(inputTime);
+
+				auto timedUpdate = [this, elapsedTime, millisSince]()
+				{
+					Clock::time_point updateStart = Clock::now();
+					update(elapsedTime);
+					updateTime = millisSince(updateStart);
+				};
+
+				// Threaded, the update overlaps extraction and its changes wait for the next frame; otherwise extraction sees them
+				bool threaded = updateThread.isRunning();
+				if (threaded)
+				{
+					updateThread.submit(timedUpdate);
+				}
+				else
+				{
+					timedUpdate();
+					applyDeferred();
+					AudioManager::update(elapsedTime);
+				}
+
+				// The render systems' state is read by the frame being rendered, so extraction waits for it to finish
+				renderThread.waitIdle();
+				Clock::time_point extractStart = Clock::now();
+
+				// Bring the scene's bounds up to date and find what the cameras can see, which the render systems draw from
+				spatialSys->update(elapsedTime);
+				// Poses skinned meshes, which the render system needs each instance's palette offset from
+				animationSys->update(elapsedTime);
+
+				// These only read the scene and record their GL work, so they run side by side
+				JobCounter counter{ 0 };
+				JobSystem::execute(counter, [this, elapsedTime]() { lightSys->update(elapsedTime); });
+				JobSystem::execute(counter, [this, elapsedTime]() { renderSys->update(elapsedTime); });
+				JobSystem::execute(counter, [this, elapsedTime]() { spriteSys->update(elapsedTime); });
+				JobSystem::wait(counter);
+
+				cameraSys->update(elapsedTime); // Builds the render graph, so goes after everything it draws
+
+				float extractTime = millisSince(extractStart);
+
+				if (threaded)
+				{
+					updateThread.waitIdle();
+					AudioManager::update(elapsedTime); // Plays what the update started
+				}
+
+				{
+					std::lock_guard<std::mutex> lock(timingsMutex);
+					timings.simulate = fixedTime + updateTime;
+					timings.extract = extractTime;
+				}
 			}
+
+			// Only what was submitted up to here is this frame's; the next frame's simulation records for the one after
+			Renderer::closeFrame();
+
+			// Replay the recorded work and present, on the render thread if there is one
+			auto renderFrame = [this, inputTime, millisSince, draw = !minimised]()
+			{
+				Clock::time_point renderStart = Clock::now();
+
+				Renderer::flush();
+				if (draw)
+					std::static_pointer_cast<CameraSystem>(cameraSys)->render();
+
+				for (auto& window : windows)
+				{
+					window->swapBuffers();
+				}
+				RenderState::endFrame();
+
+				std::lock_guard<std::mutex> lock(timingsMutex);
+				timings.render = millisSince(renderStart);
+				timings.inputLatency = millisSince(inputTime);
+			};
+
+			if (renderThread.isRunning())
+				renderThread.submit(renderFrame);
+			else
+				renderFrame();
+
+			framePacer.wait();
 		}
 
+		updateThread.stop();
+		renderThread.stop();
+
 		AudioManager::cleanup();
 		Renderer::cleanup();
+		JobSystem::cleanup();
+	}
+
+	App::FrameTimings App::getFrameTimings()
+	{
+		std::lock_guard<std::mutex> lock(timingsMutex);
+		return timings;
+	}
+
+	void App::defer(std::function<void()> command)
+	{
+		std::lock_guard<std::mutex> lock(deferredMutex);
+		deferred.push_back(std::move(command));
+	}
+
+	void App::applyDeferred()
+	{
+		{
+			std::lock_guard<std::mutex> lock(deferredMutex);
+			std::swap(applying, deferred);
+		}
+
+		for (auto& command : applying)
+		{
+			command();
+		}
+		applying.clear();
 	}
 
 	void App::addWindow(const WindowProps& props)
@@ -143,7 +334,12 @@ namespace kuai {
 		}
 
 		minimised = false;
-		Renderer::setViewport(0, 0, e.getWidth(), e.getHeight());
+
+		// Applied before the next frame renders, on whichever thread owns the context
+		u32 width = e.getWidth(), height = e.getHeight();
+		RenderCommandList commandList;
+		commandList.callback([width, height]() { Renderer::setViewport(0, 0, width, height); });
+		Renderer::submit(std::move(commandList));
 
 		return false;
 	}
@@ -159,6 +355,11 @@ namespace kuai {
 		return windows[0].get();
 	}
 
+	TransformSystem& App::getTransforms()
+	{
+		return *std::static_pointer_cast<TransformSystem>(transformSys);
+	}
+
 	std::optional<Entity> App::getEntityById(EntityID id)
 	{
 		if (ECS->hasComponent<Transform>(id)) // Every entity has a transform
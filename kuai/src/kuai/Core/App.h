@@ -6,12 +6,21 @@
 #include "kuai/Events/AppEvent.h"
 #include "Window.h"
 #include "Timer.h"
+#include "FramePacer.h"
+#include "UpdateThread.h"
 
 #include "kuai/Components/Entity.h"
+#include "kuai/Renderer/RenderGraph.h"
+#include "kuai/Renderer/RenderThread.h"
 
 namespace kuai {
-	// Forward declaration
+	// Forward declarations
 	class EntityComponentSystem;
+	class TransformSystem;
+	class Physics2DSystem;
+	class Physics3DSystem;
+	class SpatialIndexSystem;
+	class AnimationSystem;
 
 	/** \class App
 	*   \brief This class runs your game. It handles windowing, events and updates.
@@ -19,7 +28,7 @@ namespace kuai {
 	*/
 	class App {
 	public:
-		App();
+		App(const WindowProps& props = WindowProps());
 		virtual ~App();
 
 		/**
@@ -32,11 +41,23 @@ namespace kuai {
 		*/
 		virtual void update(float dt) = 0;
 
+		/**
+		* Called at a fixed rate, zero or more times per frame before update. Put physics and any
+		* game logic that mustn't depend on the frame rate here; transforms moved here are drawn interpolated.
+		*/
+		virtual void fixedUpdate(float dt) {}
+
 		/**
 		* Called every time an event occurs.
 		*/
 		virtual void onEvent(Event& e) {}
 
+		/**
+		* Called each frame after the camera passes are added to the render graph, to add passes of your own
+		* (shadows, post-processing...). Camera targets can be found with RenderGraph::getResource("CameraTarget").
+		*/
+		virtual void onRenderGraph(RenderGraph& graph, RenderResource backbuffer) {}
+
 		void addWindow(const WindowProps& props);
 
 		void removeWindow();
@@ -63,6 +84,82 @@ namespace kuai {
 
 		Entity* getMainCam() { return mainCam.get(); }
 
+		/**
+		* Every entity's transform, with bulk access for moving many at once.
+		*/
+		TransformSystem& getTransforms();
+
+		Physics2DSystem& getPhysics2D() { return *physics2DSys; }
+		Physics3DSystem& getPhysics3D() { return *physics3DSys; }
+
+		/**
+		* Bounds of every entity, for frustum, ray, sphere and box queries. Updated once a frame, after update().
+		*/
+		SpatialIndexSystem& getSpatialIndex() { return *spatialSys; }
+
+		/**
+		* Plays every Animator, once a frame after update().
+		*/
+		AnimationSystem& getAnimation() { return *animationSys; }
+
+		/**
+		* Set the time between fixed updates in seconds (default 1/60).
+		*/
+		void setFixedTimestep(float timestep) { fixedTimestep = timestep; }
+		float getFixedTimestep() const { return fixedTimestep; }
+
+		/**
+		* Limit how many fixed updates a slow frame can run to catch up; time beyond that is dropped so the game slows down instead.
+		*/
+		void setMaxFixedSteps(u32 steps) { maxFixedSteps = std::max(steps, 1u); }
+
+		/**
+		* How far the current frame is between the last fixed update and the next, from 0 to 1.
+		*/
+		float getInterpolationAlpha() const { return interpolationAlpha; }
+
+		/**
+		* Cap the frame rate, sleeping instead of spinning between frames. Zero removes the cap.
+		*/
+		void setFrameRateLimit(float fps) { framePacer.setTargetFrameRate(fps); }
+
+		/**
+		* Render each frame on a separate thread while the next frame is simulated. This raises throughput
+		* at the cost of a frame of latency. While on, the GL context belongs to the render thread, so GL work
+		* from update() (creating textures, models or framebuffers) must be recorded and passed to Renderer::submit(),
+		* and passes added in onRenderGraph() must not touch scene state. Off by default.
+		*/
+		void setPipelinedRendering(bool enabled) { pipelined = enabled; }
+		bool isPipelinedRendering() const { return pipelined; }
+
+		/**
+		* Run update() on a separate thread, alongside extracting and rendering the frame, instead of before them.
+		* While on, update() may read the scene but must make its changes through defer(), which applies them at the
+		* start of the next frame, before anything simulates; they are drawn a frame later. Input queries and events
+		* are unaffected, as both are handled on the main thread before update() starts. Off by default.
+		*/
+		void setThreadedUpdate(bool enabled) { threadedUpdate = enabled; }
+		bool isThreadedUpdate() const { return threadedUpdate; }
+
+		/**
+		* Queue a change to the scene, applied on the main thread in the order queued: straight after update(), or
+		* with a threaded update, at the start of the next frame. Never while a frame is between extraction and
+		* rendering. Safe from any thread.
+		*/
+		void defer(std::function<void()> command);
+
+		/**
+		* Times for the most recently finished frame, in milliseconds.
+		*/
+		struct FrameTimings
+		{
+			float simulate = 0.0f;		// fixedUpdate and update
+			float extract = 0.0f;		// Gathering what to draw from the scene
+			float render = 0.0f;		// Replaying GL work and presenting
+			float inputLatency = 0.0f;	// From polling the input a frame was simulated with to that frame being presented
+		};
+		FrameTimings getFrameTimings();
+
 		void setMainCam(Entity& camEntity);
 
 	private:
@@ -71,6 +168,11 @@ namespace kuai {
 		*/
 		void onEventP(Event& e);
 
+		/**
+		* Apply every command deferred so far. Main thread, while the update thread is idle.
+		*/
+		void applyDeferred();
+
 		bool onWindowClose(WindowCloseEvent& e);
 		bool onWindowResize(WindowResizeEvent& e);
 
@@ -78,11 +180,37 @@ namespace kuai {
 		std::vector<Box<Window>> windows;
 
 		Timer timer;
+		FramePacer framePacer;
+
+		RenderThread renderThread;
+		bool pipelined = false;
+
+		UpdateThread updateThread;
+		bool threadedUpdate = false;
+		float updateTime = 0.0f; // Milliseconds, written by whichever thread ran update()
+
+		std::vector<std::function<void()>> deferred;
+		std::vector<std::function<void()>> applying; // Swapped with deferred, so commands can defer more while applied
+		std::mutex deferredMutex;
+
+		FrameTimings timings;
+		std::mutex timingsMutex;
+
 		bool running = true;
 		bool minimised = false;
 
 		EntityComponentSystem* ECS;
 
+		float fixedTimestep = 1.0f / 60.0f;
+		u32 maxFixedSteps = 5;
+		float accumulator = 0.0f;
+		float interpolationAlpha = 0.0f;
+
+		Rc<System> transformSys;
+		Rc<Physics2DSystem> physics2DSys;
+		Rc<Physics3DSystem> physics3DSys;
+		Rc<SpatialIndexSystem> spatialSys;
+		Rc<AnimationSystem> animationSys;
 		Rc<System> cameraSys;
 		Rc<System> renderSys;
 		Rc<System> spriteSys;
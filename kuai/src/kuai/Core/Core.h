@@ -23,6 +23,11 @@
 
 #define BIT(x) (1 << x)
 
+// SSE is available on every x64 target; used for 4-wide maths in hot loops
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define KU_SIMD_SSE
+#endif
+
 namespace kuai {
 	// Abbreviations for integer types
 	using i8  = int8_t;
@@ -0,0 +1,67 @@
+#include "kpch.h"
+#include "FramePacer.h"
+
+#include <thread>
+
+#ifdef KU_PLATFORM_WINDOWS
+	#include <timeapi.h>
+#endif
+
+namespace kuai {
+	FramePacer::~FramePacer()
+	{
+		setTargetFrameRate(0.0f);
+	}
+
+	void FramePacer::setTargetFrameRate(float fps)
+	{
+#ifdef KU_PLATFORM_WINDOWS
+		// The default 15.6ms scheduler tick makes sleeps far too coarse to pace with
+		if (fps > 0.0f && targetFrameRate <= 0.0f)
+			timeBeginPeriod(1);
+		else if (fps <= 0.0f && targetFrameRate > 0.0f)
+			timeEndPeriod(1);
+#endif
+
+		targetFrameRate = std::max(fps, 0.0f);
+		period = targetFrameRate > 0.0f
+			? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(1.0f / targetFrameRate))
+			: Clock::duration::zero();
+		nextFrame = Clock::now() + period;
+	}
+
+	void FramePacer::wait()
+	{
+		if (targetFrameRate <= 0.0f)
+			return;
+
+		KU_PROFILE_FUNCTION();
+
+		Clock::time_point now = Clock::now();
+
+		auto spinFrom = nextFrame - std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(sleepOvershoot));
+		while (now < spinFrom)
+		{
+			// Sleep in short slices so a single long overrun can't eat the whole frame
+			auto slice = std::min<Clock::duration>(spinFrom - now, std::chrono::milliseconds(1));
+			std::this_thread::sleep_for(slice);
+
+			Clock::time_point after = Clock::now();
+			// Weighted to settle at about twice the typical overrun, for headroom
+			float overshoot = std::chrono::duration<float>(after - now - slice).count();
+			sleepOvershoot = std::clamp(sleepOvershoot * 0.95f + overshoot * 0.1f, 0.0001f, 0.004f);
+			now = after;
+		}
+
+		while (now < nextFrame)
+		{
+			std::this_thread::yield();
+			now = Clock::now();
+		}
+
+		// Schedule from the deadline rather than from now so the average rate holds, but don't try to catch up after a long frame
+		nextFrame += period;
+		if (nextFrame < now)
+			nextFrame = now + period;
+	}
+}
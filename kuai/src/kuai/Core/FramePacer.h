@@ -0,0 +1,37 @@
+#pragma once
+
+#include <chrono>
+
+namespace kuai {
+	/** \class FramePacer
+	*	\brief Holds the frame loop to a target frame rate without burning a core while it waits.
+	*
+	*	Sleeps through most of the wait, then spins for the last stretch that the OS sleep can't be trusted with.
+	*/
+	class FramePacer
+	{
+	public:
+		~FramePacer();
+
+		/**
+		* Set the frame rate to hold to. Zero (the default) turns pacing off.
+		*/
+		void setTargetFrameRate(float fps);
+		float getTargetFrameRate() const { return targetFrameRate; }
+
+		/**
+		* Block until the next frame is due. Call once per frame.
+		*/
+		void wait();
+
+	private:
+		using Clock = std::chrono::steady_clock;
+
+		float targetFrameRate = 0.0f;
+		Clock::duration period = Clock::duration::zero();
+		Clock::time_point nextFrame;
+
+		// How far sleeps tend to overrun, in seconds; the wait is handed to the spin this far from the deadline
+		float sleepOvershoot = 0.001f;
+	};
+}
@@ -0,0 +1,314 @@
+#include "kpch.h"
+#include "Input.h"
+
+#include <fstream>
+
+namespace kuai {
+	// Marks the start of a recording file, followed by its version
+	static const char RECORDING_MAGIC[4] = { 'K', 'U', 'I', 'N' };
+	static const u32 RECORDING_VERSION = 1;
+
+	static const std::chrono::steady_clock::time_point captureStart = std::chrono::steady_clock::now();
+	static bool mousePosKnown = false; // No delta until the cursor has been seen once
+
+	InputEvent Input::ring[RING_SIZE];
+	u32 Input::ringHead = 0;
+	u32 Input::ringTail = 0;
+
+	Input::Snapshot Input::snapshot;
+	u32 Input::frame = 0;
+
+	bool Input::recording = false;
+	u32 Input::recordStart = 0;
+	std::vector<InputEvent> Input::recorded;
+
+	bool Input::replaying = false;
+	u32 Input::replayStart = 0;
+	size_t Input::replayNext = 0;
+	std::vector<InputEvent> Input::replayEvents;
+
+	bool Input::isKeyPressed(KeyCode keycode)
+	{
+		return keycode < KEY_COUNT && snapshot.keys[keycode];
+	}
+
+	bool Input::wasKeyPressed(KeyCode keycode)
+	{
+		return keycode < KEY_COUNT && snapshot.keysPressed[keycode];
+	}
+
+	bool Input::wasKeyReleased(KeyCode keycode)
+	{
+		return keycode < KEY_COUNT && snapshot.keysReleased[keycode];
+	}
+
+	bool Input::isMouseBtnPressed(MouseBtnCode button)
+	{
+		return button < MOUSE_BTN_COUNT && snapshot.buttons[button];
+	}
+
+	bool Input::wasMouseBtnPressed(MouseBtnCode button)
+	{
+		return button < MOUSE_BTN_COUNT && snapshot.buttonsPressed[button];
+	}
+
+	bool Input::wasMouseBtnReleased(MouseBtnCode button)
+	{
+		return button < MOUSE_BTN_COUNT && snapshot.buttonsReleased[button];
+	}
+
+	glm::vec2 Input::getMousePos()
+	{
+		return snapshot.mousePos + snapshot.windowOrigin;
+	}
+
+	float Input::getMouseX()
+	{
+		return Input::getMousePos().x;
+	}
+
+	float Input::getMouseY()
+	{
+		return Input::getMousePos().y;
+	}
+
+	glm::vec2 Input::getMouseDelta()
+	{
+		return snapshot.mouseDelta;
+	}
+
+	glm::vec2 Input::getScrollDelta()
+	{
+		return snapshot.scrollDelta;
+	}
+
+	void Input::push(InputEvent event)
+	{
+		event.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - captureStart).count();
+
+		// Full, so roll the oldest in early rather than lose it; a lost release would leave its key held.
+		// It counts towards the coming frame, the one it would have been rolled into.
+		if (ringTail - ringHead == RING_SIZE)
+			roll(ring[ringHead++ % RING_SIZE], frame + 1);
+
+		ring[ringTail++ % RING_SIZE] = event;
+	}
+
+	void Input::beginFrame()
+	{
+		frame++;
+
+		snapshot.keysPressed.reset();
+		snapshot.keysReleased.reset();
+		snapshot.buttonsPressed.reset();
+		snapshot.buttonsReleased.reset();
+		snapshot.mouseDelta = glm::vec2(0.0f);
+		snapshot.scrollDelta = glm::vec2(0.0f);
+
+		if (replaying)
+		{
+			// Real input is dropped so it can't mix with the replay
+			ringHead = ringTail;
+
+			while (replayNext < replayEvents.size() && replayEvents[replayNext].frame <= frame - replayStart)
+				apply(replayEvents[replayNext++]);
+
+			if (replayNext == replayEvents.size())
+			{
+				replaying = false;
+				replayEvents.clear();
+			}
+			return;
+		}
+
+		snapshot.windowOrigin = getWindowOrigin();
+
+		while (ringHead != ringTail)
+			roll(ring[ringHead++ % RING_SIZE], frame);
+	}
+
+	void Input::roll(InputEvent& event, u32 eventFrame)
+	{
+		apply(event);
+
+		if (recording)
+		{
+			event.frame = eventFrame - recordStart;
+			recorded.push_back(event);
+		}
+	}
+
+	void Input::apply(const InputEvent& event)
+	{
+		switch (event.type)
+		{
+			case InputEvent::Type::KeyPress:
+			{
+				if (event.code >= KEY_COUNT)
+					break;
+				if (!snapshot.keys[event.code])
+					snapshot.keysPressed.set(event.code);
+				snapshot.keys.set(event.code);
+				break;
+			}
+			case InputEvent::Type::KeyRelease:
+			{
+				if (event.code >= KEY_COUNT)
+					break;
+				if (snapshot.keys[event.code])
+					snapshot.keysReleased.set(event.code);
+				snapshot.keys.reset(event.code);
+				break;
+			}
+			case InputEvent::Type::MouseBtnPress:
+			{
+				if (event.code >= MOUSE_BTN_COUNT)
+					break;
+				if (!snapshot.buttons[event.code])
+					snapshot.buttonsPressed.set(event.code);
+				snapshot.buttons.set(event.code);
+				break;
+			}
+			case InputEvent::Type::MouseBtnRelease:
+			{
+				if (event.code >= MOUSE_BTN_COUNT)
+					break;
+				if (snapshot.buttons[event.code])
+					snapshot.buttonsReleased.set(event.code);
+				snapshot.buttons.reset(event.code);
+				break;
+			}
+			case InputEvent::Type::MouseMove:
+			{
+				if (mousePosKnown)
+					snapshot.mouseDelta += event.value - snapshot.mousePos;
+				snapshot.mousePos = event.value;
+				mousePosKnown = true;
+				break;
+			}
+			case InputEvent::Type::MouseScroll:
+			{
+				snapshot.scrollDelta += event.value;
+				break;
+			}
+		}
+	}
+
+	void Input::startRecording()
+	{
+		recording = true;
+		recordStart = frame + 1;
+		recorded.clear();
+
+		// Whatever is already held goes first, so a replay starts in the same state
+		auto held = [](InputEvent::Type type, u16 code)
+		{
+			InputEvent event;
+			event.type = type;
+			event.code = code;
+			recorded.push_back(event);
+		};
+
+		for (u16 key = 0; key < KEY_COUNT; key++)
+		{
+			if (snapshot.keys[key])
+				held(InputEvent::Type::KeyPress, key);
+		}
+
+		for (u16 button = 0; button < MOUSE_BTN_COUNT; button++)
+		{
+			if (snapshot.buttons[button])
+				held(InputEvent::Type::MouseBtnPress, button);
+		}
+
+		InputEvent cursor;
+		cursor.type = InputEvent::Type::MouseMove;
+		cursor.value = snapshot.mousePos;
+		recorded.push_back(cursor);
+	}
+
+	std::vector<InputEvent> Input::stopRecording()
+	{
+		recording = false;
+		return std::move(recorded);
+	}
+
+	void Input::replay(const std::vector<InputEvent>& events)
+	{
+		recording = false;
+
+		replaying = !events.empty();
+		replayStart = frame + 1;
+		replayNext = 0;
+		replayEvents = events;
+
+		// Starts from nothing held, as the recording did before its held keys were added
+		glm::vec2 windowOrigin = snapshot.windowOrigin;
+		snapshot = Snapshot();
+		snapshot.windowOrigin = windowOrigin;
+		mousePosKnown = false;
+	}
+
+	bool Input::saveRecording(const std::string& filename, const std::vector<InputEvent>& events)
+	{
+		std::ofstream file(filename, std::ios::binary);
+		if (!file)
+		{
+			KU_CORE_ERROR("Failed to save input recording: {0}", filename);
+			return false;
+		}
+
+		u32 count = (u32)events.size();
+		file.write(RECORDING_MAGIC, sizeof(RECORDING_MAGIC));
+		file.write((const char*)&RECORDING_VERSION, sizeof(RECORDING_VERSION));
+		file.write((const char*)&count, sizeof(count));
+
+		// Field by field, so padding never reaches the file
+		for (const InputEvent& event : events)
+		{
+			file.write((const char*)&event.type, sizeof(event.type));
+			file.write((const char*)&event.code, sizeof(event.code));
+			file.write((const char*)&event.value, sizeof(event.value));
+			file.write((const char*)&event.time, sizeof(event.time));
+			file.write((const char*)&event.frame, sizeof(event.frame));
+		}
+
+		return (bool)file;
+	}
+
+	std::vector<InputEvent> Input::loadRecording(const std::string& filename)
+	{
+		std::vector<InputEvent> events;
+
+		std::ifstream file(filename, std::ios::binary);
+		char magic[4] = {};
+		u32 version = 0, count = 0;
+		file.read(magic, sizeof(magic));
+		file.read((char*)&version, sizeof(version));
+		file.read((char*)&count, sizeof(count));
+
+		if (!file || std::memcmp(magic, RECORDING_MAGIC, sizeof(magic)) != 0 || version != RECORDING_VERSION)
+		{
+			KU_CORE_ERROR("Failed to load input recording: {0}", filename);
+			return events;
+		}
+
+		events.resize(count);
+		for (InputEvent& event : events)
+		{
+			file.read((char*)&event.type, sizeof(event.type));
+			file.read((char*)&event.code, sizeof(event.code));
+			file.read((char*)&event.value, sizeof(event.value));
+			file.read((char*)&event.time, sizeof(event.time));
+			file.read((char*)&event.frame, sizeof(event.frame));
+		}
+
+		if (!file)
+		{
+			KU_CORE_ERROR("Input recording is truncated: {0}", filename);
+			events.clear();
+		}
+
+		return events;
+	}
+}
@@ -1,12 +1,39 @@
 #pragma once
 
+#include <bitset>
+
 #include "KeyCodes.h"
 #include "MouseBtnCodes.h"
 #include "glm/glm.hpp"
 
 namespace kuai {
+	/**
+	* A single key, button, cursor or scroll change, as the window reported it.
+	*/
+	struct InputEvent
+	{
+		enum class Type : u8
+		{
+			KeyPress, KeyRelease,
+			MouseBtnPress, MouseBtnRelease,
+			MouseMove, MouseScroll
+		};
+
+		Type type = Type::KeyPress;
+		u16 code = 0;		// Key or mouse button
+		glm::vec2 value = glm::vec2(0.0f); // Cursor position in the window, or scroll offset
+		double time = 0.0;	// Seconds since input started being captured
+		u32 frame = 0;		// Frame it was handled on, counted from the start of recording
+	};
+
 	/** \class Input
 	*	\brief Used to poll mouse and keyboard input, as well as getting input values from the mouse.
+	*
+	*	The window's callbacks write every change into a fixed-size ring buffer. Once a frame, before anything
+	*	simulates, the buffer is rolled into a snapshot of which keys and buttons are held, which changed, and how far
+	*	the cursor and scroll wheel moved; every query reads from that snapshot rather than the window system, so the
+	*	whole frame sees the same input. The events can be recorded and replayed later, frame for frame, for
+	*	deterministic tests.
 	*/
 	class Input
 	{
@@ -16,13 +43,113 @@ namespace kuai {
 		*/
 		static bool isKeyPressed(KeyCode keycode);
 
+		/**
+		* Returns true if the key went down or up since the last frame
+		*/
+		static bool wasKeyPressed(KeyCode keycode);
+		static bool wasKeyReleased(KeyCode keycode);
+
 		/**
 		* Returns true if mouse button is being pressed
 		*/
 		static bool isMouseBtnPressed(MouseBtnCode button);
 
+		static bool wasMouseBtnPressed(MouseBtnCode button);
+		static bool wasMouseBtnReleased(MouseBtnCode button);
+
 		static glm::vec2 getMousePos();
 		static float getMouseX();
 		static float getMouseY();
+
+		/**
+		* How far the cursor moved since the last frame
+		*/
+		static glm::vec2 getMouseDelta();
+
+		/**
+		* How far the scroll wheel moved since the last frame
+		*/
+		static glm::vec2 getScrollDelta();
+
+		/**
+		* Start keeping every event handled from the next frame on.
+		*/
+		static void startRecording();
+
+		/**
+		* Stop recording and return what was recorded, oldest first.
+		*/
+		static std::vector<InputEvent> stopRecording();
+
+		/**
+		* Feed recorded events back in, each on the same frame relative to the start as when it was recorded, instead
+		* of the window's. Real input is ignored until the replay is finished.
+		*/
+		static void replay(const std::vector<InputEvent>& events);
+		static bool isReplaying() { return replaying; }
+
+		static bool saveRecording(const std::string& filename, const std::vector<InputEvent>& events);
+		static std::vector<InputEvent> loadRecording(const std::string& filename);
+
+		// @cond
+		/**
+		* Capture an event from the window. Main thread, where the window system calls back.
+		*/
+		static void push(InputEvent event);
+
+		/**
+		* Roll every event since the last frame into the snapshot. Called by the App once a frame, after polling the window.
+		*/
+		static void beginFrame();
+		// @endcond
+
+	private:
+		/**
+		* Apply an event from the ring and, if recording, keep it against the frame it was rolled into.
+		*/
+		static void roll(InputEvent& event, u32 eventFrame);
+		static void apply(const InputEvent& event);
+
+		/**
+		* Where the active window's client area is on the screen. Platform specific.
+		*/
+		static glm::vec2 getWindowOrigin();
+
+	private:
+		static const u32 KEY_COUNT = 349;		// GLFW_KEY_LAST + 1
+		static const u32 MOUSE_BTN_COUNT = Mouse::ButtonLast + 1;
+		static const u32 RING_SIZE = 1024;	// Events held between frames; a power of two
+
+		struct Snapshot
+		{
+			std::bitset<KEY_COUNT> keys;
+			std::bitset<KEY_COUNT> keysPressed;
+			std::bitset<KEY_COUNT> keysReleased;
+
+			std::bitset<MOUSE_BTN_COUNT> buttons;
+			std::bitset<MOUSE_BTN_COUNT> buttonsPressed;
+			std::bitset<MOUSE_BTN_COUNT> buttonsReleased;
+
+			glm::vec2 mousePos = glm::vec2(0.0f);
+			glm::vec2 mouseDelta = glm::vec2(0.0f);
+			glm::vec2 scrollDelta = glm::vec2(0.0f);
+			glm::vec2 windowOrigin = glm::vec2(0.0f);
+		};
+
+		static InputEvent ring[RING_SIZE];
+		static u32 ringHead;	// Next event to roll into the snapshot
+		static u32 ringTail;	// Next free slot
+
+		static Snapshot snapshot;
+		static u32 frame;
+
+		static bool recording;
+		static u32 recordStart;
+		static std::vector<InputEvent> recorded;
+
+		static bool replaying;
+		static u32 replayStart;
+		static size_t replayNext;
+		static std::vector<InputEvent> replayEvents;
 	};
-}
\ No newline at end of file
+}
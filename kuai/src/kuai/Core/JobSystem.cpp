@@ -0,0 +1,155 @@
+#include "kpch.h"
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace kuai {
+
+	struct Job
+	{
+		JobSystem::JobFn fn;
+		JobCounter* counter;
+	};
+
+	static std::vector<std::thread> workers;
+	static std::deque<Job> jobQueue;
+	static std::mutex queueMutex;
+	static std::condition_variable queueCond;
+	static bool running = false;
+
+	static thread_local u32 threadIndex = 0;
+
+	void JobSystem::init(u32 threadCount)
+	{
+		if (running)
+			return;
+
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		running = true;
+		for (u32 i = 0; i < threadCount; i++)
+		{
+			workers.emplace_back(&JobSystem::workerLoop, i + 1);
+		}
+
+		KU_CORE_INFO("Started Job System ({0} workers)", threadCount);
+	}
+
+	void JobSystem::cleanup()
+	{
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			running = false;
+		}
+		queueCond.notify_all();
+
+		for (auto& worker : workers)
+		{
+			worker.join();
+		}
+		workers.clear();
+		jobQueue.clear();
+	}
+
+	void JobSystem::execute(JobCounter& counter, const JobFn& job)
+	{
+		counter.fetch_add(1);
+
+		if (workers.empty()) // No workers, so run job immediately on the calling thread
+		{
+			job();
+			counter.fetch_sub(1);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			jobQueue.push_back({ job, &counter });
+		}
+		queueCond.notify_one();
+	}
+
+	void JobSystem::parallelFor(u32 count, u32 groupSize, const RangeFn& fn)
+	{
+		if (count == 0)
+			return;
+
+		groupSize = std::max(groupSize, 1u);
+
+		JobCounter counter{ 0 };
+		// Keep the first range for the calling thread; everything else goes to the workers
+		for (u32 start = groupSize; start < count; start += groupSize)
+		{
+			u32 end = std::min(start + groupSize, count);
+			execute(counter, [&fn, start, end]() { fn(start, end); });
+		}
+
+		fn(0, std::min(groupSize, count));
+
+		wait(counter);
+	}
+
+	void JobSystem::wait(const JobCounter& counter)
+	{
+		while (counter.load() > 0)
+		{
+			if (!runNextJob())
+				std::this_thread::yield();
+		}
+	}
+
+	u32 JobSystem::getThreadCount()
+	{
+		return (u32)workers.size() + 1;
+	}
+
+	u32 JobSystem::getThreadIndex()
+	{
+		return threadIndex;
+	}
+
+	bool JobSystem::runNextJob()
+	{
+		Job job;
+		{
+			std::lock_guard<std::mutex> lock(queueMutex);
+			if (jobQueue.empty())
+				return false;
+
+			job = std::move(jobQueue.front());
+			jobQueue.pop_front();
+		}
+
+		job.fn();
+		job.counter->fetch_sub(1);
+
+		return true;
+	}
+
+	void JobSystem::workerLoop(u32 index)
+	{
+		threadIndex = index;
+
+		while (true)
+		{
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(queueMutex);
+				queueCond.wait(lock, [] { return !jobQueue.empty() || !running; });
+
+				if (!running)
+					return;
+
+				job = std::move(jobQueue.front());
+				jobQueue.pop_front();
+			}
+
+			job.fn();
+			job.counter->fetch_sub(1);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+
+// @cond
+namespace kuai {
+	/**
+	* Counts the number of outstanding jobs in a batch; a batch is finished when it reaches zero.
+	*/
+	using JobCounter = std::atomic<u32>;
+
+	/**
+	* Fixed pool of worker threads that run small jobs in parallel.
+	* The thread that waits on a batch helps execute queued jobs, so jobs may spawn and wait on other jobs.
+	*/
+	class JobSystem
+	{
+	public:
+		using JobFn = std::function<void()>;
+		using RangeFn = std::function<void(u32 start, u32 end)>;
+
+		/**
+		* Start the worker threads. A thread count of zero uses one worker per hardware thread (minus the main thread).
+		*/
+		static void init(u32 threadCount = 0);
+		static void cleanup();
+
+		/**
+		* Queue a job and increment the counter; the counter is decremented when the job completes.
+		*/
+		static void execute(JobCounter& counter, const JobFn& job);
+
+		/**
+		* Split [0, count) into ranges of at most groupSize and run them across all threads. Blocks until every range is done.
+		*/
+		static void parallelFor(u32 count, u32 groupSize, const RangeFn& fn);
+
+		/**
+		* Block until the counter reaches zero, running queued jobs in the meantime.
+		*/
+		static void wait(const JobCounter& counter);
+
+		/**
+		* Number of threads that can run jobs (workers plus the main thread).
+		*/
+		static u32 getThreadCount();
+
+		/**
+		* Index of the calling thread; 0 is the main thread, workers are numbered from 1.
+		*/
+		static u32 getThreadIndex();
+
+	private:
+		static bool runNextJob();
+		static void workerLoop(u32 index);
+	};
+}
+// @endcond
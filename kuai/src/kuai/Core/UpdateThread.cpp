@@ -0,0 +1,119 @@
+#include "kpch.h"
+#include "UpdateThread.h"
+
+namespace kuai {
+	UpdateThread::~UpdateThread()
+	{
+		if (!running)
+			return;
+
+		// Can't throw from here, so an error still pending is only logged
+		try
+		{
+			stop();
+		}
+		catch (const std::exception& e)
+		{
+			KU_CORE_ERROR("Update failed while stopping: {0}", e.what());
+		}
+	}
+
+	void UpdateThread::start()
+	{
+		if (running)
+			return;
+
+		quit = false;
+		running = true;
+
+		thread = std::thread(&UpdateThread::loop, this);
+
+		KU_CORE_INFO("Started update thread");
+	}
+
+	void UpdateThread::stop()
+	{
+		if (!running)
+			return;
+
+		// Joined before rethrowing, so the thread is never left behind
+		std::exception_ptr lastError;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cond.wait(lock, [this]() { return !busy; });
+			quit = true;
+			std::swap(lastError, error);
+		}
+		cond.notify_all();
+		thread.join();
+
+		running = false;
+
+		if (lastError)
+			std::rethrow_exception(lastError);
+	}
+
+	void UpdateThread::submit(const UpdateFn& update)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return !busy; });
+
+		pending = update;
+		busy = true;
+		lock.unlock();
+		cond.notify_all();
+	}
+
+	void UpdateThread::waitIdle()
+	{
+		if (!running)
+			return;
+
+		KU_PROFILE_FUNCTION();
+
+		std::exception_ptr lastError;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			cond.wait(lock, [this]() { return !busy; });
+			std::swap(lastError, error);
+		}
+
+		if (lastError)
+			std::rethrow_exception(lastError);
+	}
+
+	void UpdateThread::loop()
+	{
+		while (true)
+		{
+			UpdateFn update;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cond.wait(lock, [this]() { return busy || quit; });
+
+				if (quit && !busy)
+					break;
+
+				update = std::move(pending);
+			}
+
+			// Handed back to the main thread at the next wait, rather than ending the process from here
+			std::exception_ptr updateError;
+			try
+			{
+				update();
+			}
+			catch (...)
+			{
+				updateError = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				error = updateError;
+				busy = false;
+			}
+			cond.notify_all();
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+// @cond
+namespace kuai {
+	/**
+	* Thread that runs the game's update for one frame at a time, so it overlaps extraction and rendering
+	* on the main thread. Kept apart from the JobSystem's workers, which extraction needs free.
+	*/
+	class UpdateThread
+	{
+	public:
+		using UpdateFn = std::function<void()>;
+
+		~UpdateThread();
+
+		void start();
+		/**
+		* Finish the update in flight and stop the thread.
+		*/
+		void stop();
+
+		bool isRunning() const { return running; }
+
+		/**
+		* Hand an update to the thread. Waits for the previous one first, so at most one is in flight.
+		*/
+		void submit(const UpdateFn& update);
+		/**
+		* Block until the thread has finished its update, rethrowing anything the update threw.
+		* Returns immediately if it isn't running.
+		*/
+		void waitIdle();
+
+	private:
+		void loop();
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable cond;
+
+		UpdateFn pending;
+		std::exception_ptr error;
+		bool busy = false;
+		bool quit = false;
+		bool running = false;
+	};
+}
+// @endcond
@@ -0,0 +1,41 @@
+#include "kpch.h"
+#include "Window.h"
+
+#ifdef KU_PLATFORM_WINDOWS
+	#include "kuai/Platform/Windows/WinWindow.h"
+#else
+	#include "kuai/Platform/Linux/LinuxWindow.h"
+#endif
+#ifdef KU_HEADLESS
+	#include "kuai/Platform/Headless/HeadlessWindow.h"
+#endif
+
+namespace kuai {
+	Box<Window> Window::create(const WindowProps& props)
+	{
+		WindowProps windowProps = props;
+
+		// Let CI switch any app to headless without rebuilding it
+		if (const char* headless = std::getenv("KU_HEADLESS"))
+			windowProps.headless = std::string(headless) != "0";
+		if (const char* frameCount = std::getenv("KU_HEADLESS_FRAMES"))
+			windowProps.frameCount = std::strtoul(frameCount, nullptr, 10);
+		if (const char* frameDumpDir = std::getenv("KU_HEADLESS_DUMP_DIR"))
+			windowProps.frameDumpDir = frameDumpDir;
+
+		if (windowProps.headless)
+		{
+#ifdef KU_HEADLESS
+			return makeBox<HeadlessWindow>(windowProps);
+#else
+			KU_CORE_ERROR("Headless window requested but kuai was built without KU_HEADLESS");
+#endif
+		}
+
+#ifdef KU_PLATFORM_WINDOWS
+		return makeBox<WinWindow>(windowProps);
+#else
+		return makeBox<LinuxWindow>(windowProps);
+#endif
+	}
+}
@@ -6,6 +6,8 @@
 #include "kuai/Events/Event.h"
 
 namespace kuai {
+	// Forward declaration
+	class Framebuffer;
 
 	/**
 	* Properties of a window, i.e., title, width and height.
@@ -18,6 +20,12 @@ namespace kuai {
 		uint32_t screenX;
 		uint32_t screenY;
 
+		// Render offscreen with no display, e.g. for benchmarks and image tests on build machines.
+		// Can also be turned on with the KU_HEADLESS environment variable.
+		bool headless = false;
+		uint32_t frameCount = 0;	// Headless only: close after this many frames, 0 runs until closed
+		std::string frameDumpDir;	// Headless only: write every frame to this directory as a PPM if not empty
+
 		WindowProps(const std::string& title = "Demo",
 			uint32_t width = 1024,
 			uint32_t height = 768,
@@ -40,7 +48,23 @@ namespace kuai {
 
 		virtual ~Window() {}
 
-		virtual void update() = 0;
+		/**
+		* Handle pending events then present the frame.
+		*/
+		virtual void update() { pollEvents(); swapBuffers(); }
+
+		/**
+		* Handle pending OS events. Must be called on the main thread.
+		*/
+		virtual void pollEvents() = 0;
+		/**
+		* Present the frame. Must be called on the thread the context is current on.
+		*/
+		virtual void swapBuffers() = 0;
+		/**
+		* Make the window's GL context current on the calling thread, or release it so another thread can take it.
+		*/
+		virtual void makeContextCurrent(bool current) = 0;
 
 		virtual uint32_t getWidth() const = 0;
 		virtual uint32_t getHeight() const = 0;
@@ -58,6 +82,11 @@ namespace kuai {
 		virtual void* getNativeWindow() const = 0;
 		virtual bool isActive() const = 0;
 
+		/**
+		* Returns the framebuffer standing in for the screen, or nullptr if the window draws to the default framebuffer.
+		*/
+		virtual Framebuffer* getFramebuffer() const { return nullptr; }
+
 		static Box<Window> create(const WindowProps& props = WindowProps());
 	};
 }
\ No newline at end of file
@@ -53,13 +53,12 @@ namespace kuai {
 
 	class EventDispatcher 
 	{
-		template<typename T>
-		using EventFn = std::function<bool(T&)>;
 	public:
 		EventDispatcher(Event& event) : event(event) {}
 
-		template<typename T>
-		bool dispatch(EventFn<T> func)
+		// Takes any callable bool(T&) directly, rather than wrapping it in a std::function for every event
+		template<typename T, typename F>
+		bool dispatch(const F& func)
 		{
 			if (event.getEventType() == T::getStaticType()) // Check if passed event type matches event type of template argument
 			{ 
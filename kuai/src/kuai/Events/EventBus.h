@@ -0,0 +1,240 @@
+#pragma once
+
+#include <atomic>
+
+#include "Event.h"
+
+namespace kuai {
+	/**
+	* Events posted from any thread, taken off by one consumer, without locking. Producers push onto an atomic list;
+	* the consumer takes the whole list in one exchange, so it never contends with them over individual nodes.
+	*/
+	class EventQueue
+	{
+	public:
+		struct Node
+		{
+			virtual ~Node() = default;
+
+			Node* next = nullptr;
+			Event* event = nullptr;
+			u32 type = 0;
+		};
+
+		template<typename EventType>
+		struct TypedNode : Node
+		{
+			TypedNode(const EventType& event) : typedEvent(event)
+			{
+				this->event = &typedEvent;
+				type = (u32)EventType::getStaticType();
+			}
+
+			EventType typedEvent;
+		};
+
+		~EventQueue()
+		{
+			Node* node = takeAll();
+			while (node)
+			{
+				Node* next = node->next;
+				delete node;
+				node = next;
+			}
+		}
+
+		/**
+		* Any thread.
+		*/
+		void push(Node* node)
+		{
+			Node* top = head.load(std::memory_order_relaxed);
+			do
+			{
+				node->next = top;
+			} while (!head.compare_exchange_weak(top, node, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		/**
+		* Take every node pushed so far, oldest first. Consumer only.
+		*/
+		Node* takeAll()
+		{
+			Node* node = head.exchange(nullptr, std::memory_order_acquire);
+
+			// Pushed newest first, so reverse into the order they were posted
+			Node* reversed = nullptr;
+			while (node)
+			{
+				Node* next = node->next;
+				node->next = reversed;
+				reversed = node;
+				node = next;
+			}
+
+			return reversed;
+		}
+
+	private:
+		std::atomic<Node*> head{ nullptr };
+	};
+
+	/** \class EventBus
+	*	\brief Passes events between systems, either straight away or queued until the next dispatch.
+	*
+	*	Handlers of each event type are kept in one array, indexed by the type's EventType, and called through a plain
+	*	function pointer. Subscribing and dispatching queued events are for the main thread, but events may be posted from
+	*	any thread (audio, physics, loading) and are handled together, grouped by type, when the main thread next dispatches.
+	*
+	*	notify() may also be called from the render thread, alongside the main thread. The handler arrays aren't locked, so
+	*	subscribe() and unsubscribe() may only be called while the render thread is idle (e.g. while systems are created, or
+	*	during simulation before a frame is handed to it).
+	*/
+	class EventBus
+	{
+	public:
+		/**
+		* Call every handler of the event's type now.
+		*/
+		template<typename EventType>
+		void notify(EventType& event)
+		{
+			dispatch((u32)EventType::getStaticType(), event);
+		}
+
+		/**
+		* Queue a copy of the event for the next dispatchQueued(). Safe from any thread.
+		*/
+		template<typename EventType>
+		void post(const EventType& event)
+		{
+			queue.push(new EventQueue::TypedNode<EventType>(event));
+		}
+
+		/**
+		* Handle every event posted since the last call, each type's in the order they were posted. Once a frame.
+		*/
+		void dispatchQueued()
+		{
+			EventQueue::Node* node = queue.takeAll();
+			if (!node)
+				return;
+
+			// Group by type, so each array of handlers is walked in one go
+			while (node)
+			{
+				if (node->type >= batches.size())
+					batches.resize(node->type + 1);
+				batches[node->type].push_back(node);
+				node = node->next;
+			}
+
+			for (u32 type = 0; type < batches.size(); type++)
+			{
+				for (EventQueue::Node* queued : batches[type])
+					dispatch(type, *queued->event);
+
+				for (EventQueue::Node* queued : batches[type])
+					delete queued;
+				batches[type].clear();
+			}
+		}
+
+		/**
+		* Main thread, while the render thread is idle.
+		*/
+		template<typename T, typename EventType>
+		void subscribe(T* instance, void (T::*memberFn)(EventType&))
+		{
+			using MemberFn = void (T::*)(EventType&);
+			static_assert(sizeof(MemberFn) <= sizeof(Handler::memberFn), "Member function pointer is too large to store");
+
+			u32 type = (u32)EventType::getStaticType();
+			if (type >= handlers.size())
+				handlers.resize(type + 1);
+
+			Handler handler;
+			handler.instance = instance;
+			handler.call = &callMember<T, EventType>;
+			std::memcpy(handler.memberFn, &memberFn, sizeof(MemberFn));
+			handlers[type].push_back(handler);
+		}
+
+		/**
+		* Stop calling any of instance's handlers. Main thread, while the render thread is idle.
+		*/
+		void unsubscribe(void* instance)
+		{
+			for (std::vector<Handler>& typeHandlers : handlers)
+			{
+				for (Handler& handler : typeHandlers)
+				{
+					if (handler.instance == instance)
+					{
+						handler.instance = nullptr;
+						removed = true;
+					}
+				}
+			}
+
+			// Removed handlers are left in place while something is being dispatched, and cleared out afterwards
+			if (!dispatching)
+				compact();
+		}
+
+	private:
+		struct Handler
+		{
+			void* instance = nullptr;
+			void (*call)(const Handler& handler, Event& event) = nullptr;
+			alignas(void*) unsigned char memberFn[3 * sizeof(void*)]; // Big enough for any member function pointer
+		};
+
+		template<typename T, typename EventType>
+		static void callMember(const Handler& handler, Event& event)
+		{
+			void (T::*memberFn)(EventType&);
+			std::memcpy(&memberFn, handler.memberFn, sizeof(memberFn));
+
+			// Cast event to the correct type and call member function
+			(((T*)handler.instance)->*memberFn)(static_cast<EventType&>(event));
+		}
+
+		void dispatch(u32 type, Event& event)
+		{
+			if (type >= handlers.size())
+				return;
+
+			dispatching++;
+
+			// By index, so handlers subscribing more handlers don't invalidate the walk
+			for (size_t i = 0; i < handlers[type].size(); i++)
+			{
+				Handler handler = handlers[type][i];
+				if (handler.instance)
+					handler.call(handler, event);
+			}
+
+			if (--dispatching == 0 && removed)
+				compact();
+		}
+
+		void compact()
+		{
+			removed = false;
+			for (std::vector<Handler>& typeHandlers : handlers)
+			{
+				typeHandlers.erase(std::remove_if(typeHandlers.begin(), typeHandlers.end(),
+					[](const Handler& handler) { return !handler.instance; }), typeHandlers.end());
+			}
+		}
+
+	private:
+		std::vector<std::vector<Handler>> handlers; // Indexed by EventType
+		EventQueue queue;
+		std::vector<std::vector<EventQueue::Node*>> batches; // Reused by each dispatchQueued()
+		std::atomic<u32> dispatching{ 0 }; // Counts both threads' notifies; the arrays themselves rely on the rule above
+		bool removed = false;
+	};
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	/**
+	* Axis aligned bounding box, stored as its minimum and maximum corners.
+	*/
+	struct AABB
+	{
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+
+		AABB() = default;
+		AABB(const glm::vec3& min, const glm::vec3& max) : min(min), max(max) {}
+
+		glm::vec3 getCentre() const { return (min + max) * 0.5f; }
+		glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+		float getSurfaceArea() const
+		{
+			glm::vec3 size = max - min;
+			return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+		}
+
+		bool overlaps(const AABB& other) const
+		{
+			return min.x <= other.max.x && max.x >= other.min.x
+				&& min.y <= other.max.y && max.y >= other.min.y
+				&& min.z <= other.max.z && max.z >= other.min.z;
+		}
+
+		bool contains(const AABB& other) const
+		{
+			return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z
+				&& max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+		}
+
+		static AABB merge(const AABB& a, const AABB& b)
+		{
+			return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+		}
+	};
+}
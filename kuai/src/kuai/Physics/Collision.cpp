@@ -0,0 +1,499 @@
+#include "kpch.h"
+#include "Collision.h"
+
+namespace kuai {
+	static const float EPSILON = 1e-6f;
+
+	// An edge axis only wins over a face axis when it separates noticeably less, which keeps resting contacts from flickering between the two
+	static const float RELATIVE_TOLERANCE = 0.95f;
+	static const float ABSOLUTE_TOLERANCE = 0.01f;
+
+	AABB CollisionShape::getAABB() const
+	{
+		glm::vec3 extents;
+		switch (type)
+		{
+			case ShapeType::BOX:
+				extents = glm::abs(axes[0]) * halfExtents.x + glm::abs(axes[1]) * halfExtents.y + glm::abs(axes[2]) * halfExtents.z;
+				break;
+			case ShapeType::SPHERE:
+				extents = glm::vec3(radius);
+				break;
+			case ShapeType::CAPSULE:
+				extents = glm::abs(axes[1]) * halfHeight + glm::vec3(radius);
+				break;
+		}
+		return AABB(centre - extents, centre + extents);
+	}
+
+	void closestPointsSegments(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2, glm::vec3& c1, glm::vec3& c2)
+	{
+		glm::vec3 d1 = q1 - p1;
+		glm::vec3 d2 = q2 - p2;
+		glm::vec3 r = p1 - p2;
+		float a = glm::dot(d1, d1);
+		float e = glm::dot(d2, d2);
+		float f = glm::dot(d2, r);
+
+		float s = 0.0f, t = 0.0f;
+		if (a <= EPSILON && e <= EPSILON)
+		{
+			// Both are points
+		}
+		else if (a <= EPSILON)
+		{
+			t = glm::clamp(f / e, 0.0f, 1.0f);
+		}
+		else
+		{
+			float c = glm::dot(d1, r);
+			if (e <= EPSILON)
+			{
+				s = glm::clamp(-c / a, 0.0f, 1.0f);
+			}
+			else
+			{
+				float b = glm::dot(d1, d2);
+				float denom = a * e - b * b;
+
+				// Parallel segments have no single closest pair, so start from p1
+				s = denom > EPSILON ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+				t = (b * s + f) / e;
+
+				if (t < 0.0f)
+				{
+					t = 0.0f;
+					s = glm::clamp(-c / a, 0.0f, 1.0f);
+				}
+				else if (t > 1.0f)
+				{
+					t = 1.0f;
+					s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+				}
+			}
+		}
+
+		c1 = p1 + d1 * s;
+		c2 = p2 + d2 * t;
+	}
+
+	static glm::vec3 closestPointSegment(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b)
+	{
+		glm::vec3 ab = b - a;
+		float lengthSqr = glm::dot(ab, ab);
+		if (lengthSqr <= EPSILON)
+			return a;
+
+		return a + ab * glm::clamp(glm::dot(p - a, ab) / lengthSqr, 0.0f, 1.0f);
+	}
+
+	// Spheres and capsules are both a segment with a radius; a sphere's segment is a single point
+	static void getSegment(const CollisionShape& shape, glm::vec3& p, glm::vec3& q)
+	{
+		float halfHeight = shape.type == ShapeType::CAPSULE ? shape.halfHeight : 0.0f;
+		p = shape.centre - shape.axes[1] * halfHeight;
+		q = shape.centre + shape.axes[1] * halfHeight;
+	}
+
+	static bool roundedRounded(const CollisionShape& a, const CollisionShape& b, Manifold& manifold)
+	{
+		glm::vec3 pa, qa, pb, qb;
+		getSegment(a, pa, qa);
+		getSegment(b, pb, qb);
+
+		glm::vec3 ca, cb;
+		closestPointsSegments(pa, qa, pb, qb, ca, cb);
+
+		glm::vec3 d = cb - ca;
+		float radii = a.radius + b.radius;
+		float distSqr = glm::dot(d, d);
+		if (distSqr > radii * radii)
+			return false;
+
+		float dist = std::sqrt(distSqr);
+		glm::vec3 normal = dist > EPSILON ? d / dist : glm::vec3(0.0f, 1.0f, 0.0f);
+		float depth = radii - dist;
+
+		manifold.normal = normal;
+		manifold.points[0].pos = ca + normal * (a.radius - depth * 0.5f);
+		manifold.points[0].depth = depth;
+		manifold.count = 1;
+		return true;
+	}
+
+	/**
+	* Test a sphere at p against a box. The normal points from the box to the sphere.
+	*/
+	static bool boxSphere(const CollisionShape& box, const glm::vec3& p, float radius, ContactPoint& point, glm::vec3& normal)
+	{
+		glm::vec3 local = glm::transpose(box.axes) * (p - box.centre);
+		glm::vec3 clamped = glm::clamp(local, -box.halfExtents, box.halfExtents);
+
+		glm::vec3 localNormal(0.0f);
+		glm::vec3 surface = clamped;
+		float depth;
+
+		if (local != clamped)
+		{
+			glm::vec3 diff = local - clamped;
+			float distSqr = glm::dot(diff, diff);
+			if (distSqr > radius * radius)
+				return false;
+
+			float dist = std::sqrt(distSqr);
+			localNormal = diff / dist;
+			depth = radius - dist;
+		}
+		else
+		{
+			// Centre is inside the box, so push out through the nearest face
+			u32 axis = 0;
+			float minDist = box.halfExtents.x - std::abs(local.x);
+			for (u32 i = 1; i < 3; i++)
+			{
+				float dist = box.halfExtents[i] - std::abs(local[i]);
+				if (dist < minDist)
+				{
+					minDist = dist;
+					axis = i;
+				}
+			}
+
+			float sign = local[axis] < 0.0f ? -1.0f : 1.0f;
+			localNormal[axis] = sign;
+			surface[axis] = sign * box.halfExtents[axis];
+			depth = radius + minDist;
+		}
+
+		normal = box.axes * localNormal;
+
+		glm::vec3 boxSurface = box.centre + box.axes * surface;
+		glm::vec3 sphereSurface = p - normal * radius;
+		point.pos = (boxSurface + sphereSurface) * 0.5f;
+		point.depth = depth;
+		return true;
+	}
+
+	static bool boxRounded(const CollisionShape& box, const CollisionShape& shape, Manifold& manifold)
+	{
+		glm::vec3 p, q;
+		getSegment(shape, p, q);
+
+		if (shape.type == ShapeType::SPHERE)
+		{
+			if (!boxSphere(box, p, shape.radius, manifold.points[0], manifold.normal))
+				return false;
+
+			manifold.count = 1;
+			return true;
+		}
+
+		// A capsule lying on a face touches at both ends
+		float deepest = std::numeric_limits<float>::lowest();
+		for (const glm::vec3& end : { p, q })
+		{
+			ContactPoint point;
+			glm::vec3 normal;
+			if (boxSphere(box, end, shape.radius, point, normal))
+			{
+				if (point.depth > deepest)
+				{
+					deepest = point.depth;
+					manifold.normal = normal;
+				}
+				manifold.points[manifold.count++] = point;
+			}
+		}
+
+		if (manifold.count > 0)
+			return true;
+
+		// Otherwise it crosses an edge or face somewhere along its length; find where by projecting back and forth between the two
+		glm::vec3 closest = (p + q) * 0.5f;
+		for (u32 i = 0; i < 4; i++)
+		{
+			glm::vec3 local = glm::clamp(glm::transpose(box.axes) * (closest - box.centre), -box.halfExtents, box.halfExtents);
+			closest = closestPointSegment(box.centre + box.axes * local, p, q);
+		}
+
+		if (!boxSphere(box, closest, shape.radius, manifold.points[0], manifold.normal))
+			return false;
+
+		manifold.count = 1;
+		return true;
+	}
+
+	static float projectBox(const CollisionShape& box, const glm::vec3& axis)
+	{
+		return box.halfExtents.x * std::abs(glm::dot(box.axes[0], axis))
+			+ box.halfExtents.y * std::abs(glm::dot(box.axes[1], axis))
+			+ box.halfExtents.z * std::abs(glm::dot(box.axes[2], axis));
+	}
+
+	/**
+	* Clip a polygon to the side of a plane where dot(normal, p) <= offset.
+	*/
+	static u32 clipPolygon(const glm::vec3* in, u32 count, const glm::vec3& normal, float offset, glm::vec3* out)
+	{
+		u32 outCount = 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			const glm::vec3& a = in[i];
+			const glm::vec3& b = in[(i + 1) % count];
+			float da = glm::dot(normal, a) - offset;
+			float db = glm::dot(normal, b) - offset;
+
+			if (da <= 0.0f)
+				out[outCount++] = a;
+
+			if ((da < 0.0f && db > 0.0f) || (da > 0.0f && db < 0.0f))
+				out[outCount++] = a + (b - a) * (da / (da - db));
+		}
+		return outCount;
+	}
+
+	/**
+	* Keep the deepest point, the point farthest from it, and the points either side of the line between them that span the most area.
+	*/
+	static void reducePoints(ContactPoint* points, u32 count, const glm::vec3& normal, Manifold& manifold)
+	{
+		if (count <= Manifold::MAX_POINTS)
+		{
+			for (u32 i = 0; i < count; i++)
+			{
+				manifold.points[i] = points[i];
+			}
+			manifold.count = count;
+			return;
+		}
+
+		u32 i0 = 0;
+		for (u32 i = 1; i < count; i++)
+		{
+			if (points[i].depth > points[i0].depth)
+				i0 = i;
+		}
+
+		u32 i1 = i0;
+		float maxDistSqr = -1.0f;
+		for (u32 i = 0; i < count; i++)
+		{
+			glm::vec3 d = points[i].pos - points[i0].pos;
+			if (glm::dot(d, d) > maxDistSqr)
+			{
+				maxDistSqr = glm::dot(d, d);
+				i1 = i;
+			}
+		}
+
+		u32 i2 = i0, i3 = i0;
+		float maxArea = 0.0f, minArea = 0.0f;
+		glm::vec3 edge = points[i1].pos - points[i0].pos;
+		for (u32 i = 0; i < count; i++)
+		{
+			float area = glm::dot(glm::cross(edge, points[i].pos - points[i0].pos), normal);
+			if (area > maxArea)
+			{
+				maxArea = area;
+				i2 = i;
+			}
+			if (area < minArea)
+			{
+				minArea = area;
+				i3 = i;
+			}
+		}
+
+		manifold.count = 0;
+		for (u32 i : { i0, i1, i2, i3 })
+		{
+			bool duplicate = false;
+			for (u32 j = 0; j < manifold.count; j++)
+				duplicate |= manifold.points[j].pos == points[i].pos;
+
+			if (!duplicate)
+				manifold.points[manifold.count++] = points[i];
+		}
+	}
+
+	/**
+	* Clip the face of the incident box most opposed to normal against a face of the reference box.
+	*/
+	static void faceContact(const CollisionShape& ref, const CollisionShape& inc, u32 refAxis, const glm::vec3& normal, Manifold& manifold)
+	{
+		u32 incAxis = 0;
+		float maxDot = -1.0f;
+		for (u32 i = 0; i < 3; i++)
+		{
+			float d = std::abs(glm::dot(inc.axes[i], normal));
+			if (d > maxDot)
+			{
+				maxDot = d;
+				incAxis = i;
+			}
+		}
+
+		glm::vec3 incNormal = inc.axes[incAxis] * (glm::dot(inc.axes[incAxis], normal) > 0.0f ? -1.0f : 1.0f);
+		glm::vec3 faceCentre = inc.centre + incNormal * inc.halfExtents[incAxis];
+		glm::vec3 u = inc.axes[(incAxis + 1) % 3] * inc.halfExtents[(incAxis + 1) % 3];
+		glm::vec3 v = inc.axes[(incAxis + 2) % 3] * inc.halfExtents[(incAxis + 2) % 3];
+
+		// Each clip can add a vertex, so four planes can take the quad to eight
+		glm::vec3 polygon[8] = { faceCentre + u + v, faceCentre - u + v, faceCentre - u - v, faceCentre + u - v };
+		glm::vec3 clipped[8];
+		u32 count = 4;
+
+		for (u32 i = 1; i < 3 && count > 0; i++)
+		{
+			u32 axis = (refAxis + i) % 3;
+			glm::vec3 side = ref.axes[axis];
+			float centre = glm::dot(side, ref.centre);
+
+			count = clipPolygon(polygon, count, side, centre + ref.halfExtents[axis], clipped);
+			count = clipPolygon(clipped, count, -side, -centre + ref.halfExtents[axis], polygon);
+		}
+
+		// Keep what's below the reference face
+		float refOffset = glm::dot(normal, ref.centre) + ref.halfExtents[refAxis];
+
+		ContactPoint points[8];
+		u32 pointCount = 0;
+		for (u32 i = 0; i < count; i++)
+		{
+			float separation = glm::dot(normal, polygon[i]) - refOffset;
+			if (separation <= 0.0f)
+			{
+				points[pointCount].pos = polygon[i] - normal * (separation * 0.5f);
+				points[pointCount].depth = -separation;
+				pointCount++;
+			}
+		}
+
+		reducePoints(points, pointCount, normal, manifold);
+	}
+
+	static bool boxBox(const CollisionShape& a, const CollisionShape& b, Manifold& manifold)
+	{
+		glm::vec3 d = b.centre - a.centre;
+
+		// Separating axis test: the axis that separates the most (least penetrating) is the contact normal
+		float faceA = std::numeric_limits<float>::lowest(), faceB = std::numeric_limits<float>::lowest(), edge = std::numeric_limits<float>::lowest();
+		u32 faceAAxis = 0, faceBAxis = 0, edgeA = 0, edgeB = 0;
+		glm::vec3 edgeNormal(0.0f);
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			float separation = std::abs(glm::dot(d, a.axes[i])) - a.halfExtents[i] - projectBox(b, a.axes[i]);
+			if (separation > 0.0f)
+				return false;
+			if (separation > faceA)
+			{
+				faceA = separation;
+				faceAAxis = i;
+			}
+		}
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			float separation = std::abs(glm::dot(d, b.axes[i])) - b.halfExtents[i] - projectBox(a, b.axes[i]);
+			if (separation > 0.0f)
+				return false;
+			if (separation > faceB)
+			{
+				faceB = separation;
+				faceBAxis = i;
+			}
+		}
+
+		for (u32 i = 0; i < 3; i++)
+		{
+			for (u32 j = 0; j < 3; j++)
+			{
+				glm::vec3 axis = glm::cross(a.axes[i], b.axes[j]);
+				float length = glm::length(axis);
+				if (length < 1e-4f) // Parallel edges; the face axes cover this
+					continue;
+
+				axis /= length;
+				float separation = std::abs(glm::dot(d, axis)) - projectBox(a, axis) - projectBox(b, axis);
+				if (separation > 0.0f)
+					return false;
+				if (separation > edge)
+				{
+					edge = separation;
+					edgeA = i;
+					edgeB = j;
+					edgeNormal = axis;
+				}
+			}
+		}
+
+		float best = faceA;
+		if (faceB > RELATIVE_TOLERANCE * best + ABSOLUTE_TOLERANCE)
+			best = faceB;
+
+		if (edge > RELATIVE_TOLERANCE * best + ABSOLUTE_TOLERANCE)
+		{
+			glm::vec3 normal = glm::dot(edgeNormal, d) < 0.0f ? -edgeNormal : edgeNormal;
+
+			// The edge of each box furthest towards the other
+			glm::vec3 pa = a.centre, pb = b.centre;
+			for (u32 k = 0; k < 3; k++)
+			{
+				if (k != edgeA)
+					pa += a.axes[k] * a.halfExtents[k] * (glm::dot(a.axes[k], normal) > 0.0f ? 1.0f : -1.0f);
+				if (k != edgeB)
+					pb += b.axes[k] * b.halfExtents[k] * (glm::dot(b.axes[k], normal) > 0.0f ? -1.0f : 1.0f);
+			}
+
+			glm::vec3 ea = a.axes[edgeA] * a.halfExtents[edgeA];
+			glm::vec3 eb = b.axes[edgeB] * b.halfExtents[edgeB];
+
+			glm::vec3 ca, cb;
+			closestPointsSegments(pa - ea, pa + ea, pb - eb, pb + eb, ca, cb);
+
+			manifold.normal = normal;
+			manifold.points[0].pos = (ca + cb) * 0.5f;
+			manifold.points[0].depth = -edge;
+			manifold.count = 1;
+			return true;
+		}
+
+		if (best == faceA)
+		{
+			glm::vec3 normal = a.axes[faceAAxis] * (glm::dot(d, a.axes[faceAAxis]) < 0.0f ? -1.0f : 1.0f);
+			faceContact(a, b, faceAAxis, normal, manifold);
+			manifold.normal = normal;
+		}
+		else
+		{
+			glm::vec3 normal = b.axes[faceBAxis] * (glm::dot(d, b.axes[faceBAxis]) > 0.0f ? -1.0f : 1.0f);
+			faceContact(b, a, faceBAxis, normal, manifold);
+			manifold.normal = -normal;
+		}
+
+		return manifold.count > 0;
+	}
+
+	bool collide(const CollisionShape& a, const CollisionShape& b, Manifold& manifold)
+	{
+		manifold.count = 0;
+
+		if (a.type == ShapeType::BOX && b.type == ShapeType::BOX)
+			return boxBox(a, b, manifold);
+
+		if (a.type == ShapeType::BOX)
+			return boxRounded(a, b, manifold);
+
+		if (b.type == ShapeType::BOX)
+		{
+			if (!boxRounded(b, a, manifold))
+				return false;
+
+			manifold.normal = -manifold.normal;
+			return true;
+		}
+
+		return roundedRounded(a, b, manifold);
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "AABB.h"
+
+// @cond
+namespace kuai {
+	enum class ShapeType : u8
+	{
+		BOX, SPHERE, CAPSULE
+	};
+
+	/**
+	* A collision shape placed in the world.
+	*/
+	struct CollisionShape
+	{
+		ShapeType type = ShapeType::BOX;
+
+		glm::vec3 centre = glm::vec3(0.0f);
+		glm::mat3 axes = glm::mat3(1.0f);	// Columns are the shape's local x, y and z axes
+
+		glm::vec3 halfExtents = glm::vec3(0.5f);	// Box
+		float radius = 0.5f;						// Sphere and capsule
+		float halfHeight = 0.0f;					// Capsule, from the centre to the centre of each cap along local y
+
+		AABB getAABB() const;
+	};
+
+	struct ContactPoint
+	{
+		glm::vec3 pos;	// Halfway between the two surfaces
+		float depth;	// Penetration, positive when overlapping
+	};
+
+	/**
+	* Up to four contact points sharing a normal, enough to rest a face on a face.
+	*/
+	struct Manifold
+	{
+		static const u32 MAX_POINTS = 4;
+
+		glm::vec3 normal = glm::vec3(0.0f);	// Points from the first shape to the second
+		ContactPoint points[MAX_POINTS];
+		u32 count = 0;
+	};
+
+	/**
+	* Test two shapes for contact. Boxes are tested against each other with the separating axis test and clipped
+	* to a face or edge contact; spheres and capsules are treated as rounded segments. Returns true if touching.
+	*/
+	bool collide(const CollisionShape& a, const CollisionShape& b, Manifold& manifold);
+
+	/**
+	* Closest points between segments p1-q1 and p2-q2.
+	*/
+	void closestPointsSegments(const glm::vec3& p1, const glm::vec3& q1, const glm::vec3& p2, const glm::vec3& q2, glm::vec3& c1, glm::vec3& c2);
+}
+// @endcond
@@ -0,0 +1,430 @@
+#include "kpch.h"
+#include "DynamicTree.h"
+
+namespace kuai {
+	// Fat boxes are stretched this many steps ahead along a proxy's displacement
+	static const float DISPLACEMENT_MULTIPLIER = 4.0f;
+
+	// Buckets along the split axis when rebuilding
+	static const u32 REBUILD_BINS = 12;
+
+	i32 DynamicTree::allocateNode()
+	{
+		if (freeList == NULL_NODE)
+		{
+			nodes.emplace_back();
+			return (i32)nodes.size() - 1;
+		}
+
+		i32 node = freeList;
+		freeList = nodes[node].parent;
+		nodes[node] = Node();
+		return node;
+	}
+
+	void DynamicTree::freeNode(i32 node)
+	{
+		nodes[node].parent = freeList;
+		nodes[node].height = -1;
+		freeList = node;
+	}
+
+	i32 DynamicTree::createProxy(const AABB& aabb, u32 userData)
+	{
+		i32 proxy = allocateNode();
+
+		glm::vec3 r(margin);
+		nodes[proxy].aabb = AABB(aabb.min - r, aabb.max + r);
+		nodes[proxy].userData = userData;
+		nodes[proxy].height = 0;
+
+		insertLeaf(proxy);
+		proxyCount++;
+
+		return proxy;
+	}
+
+	void DynamicTree::destroyProxy(i32 proxy)
+	{
+		KU_CORE_ASSERT(nodes[proxy].isLeaf(), "Destroyed a dynamic tree node that isn't a proxy.");
+
+		removeLeaf(proxy);
+		freeNode(proxy);
+		proxyCount--;
+	}
+
+	bool DynamicTree::moveProxy(i32 proxy, const AABB& aabb, const glm::vec3& displacement)
+	{
+		KU_CORE_ASSERT(nodes[proxy].isLeaf(), "Moved a dynamic tree node that isn't a proxy.");
+
+		// Still inside its fat box, so nothing to do
+		if (nodes[proxy].aabb.contains(aabb))
+			return false;
+
+		removeLeaf(proxy);
+
+		glm::vec3 r(margin);
+		AABB fat(aabb.min - r, aabb.max + r);
+
+		glm::vec3 d = DISPLACEMENT_MULTIPLIER * displacement;
+		fat.min += glm::min(d, glm::vec3(0.0f));
+		fat.max += glm::max(d, glm::vec3(0.0f));
+
+		nodes[proxy].aabb = fat;
+		insertLeaf(proxy);
+
+		return true;
+	}
+
+	void DynamicTree::insertLeaf(i32 leaf)
+	{
+		if (root == NULL_NODE)
+		{
+			root = leaf;
+			nodes[root].parent = NULL_NODE;
+			return;
+		}
+
+		// Walk down to the cheapest sibling by the surface area heuristic
+		AABB leafAABB = nodes[leaf].aabb;
+		i32 index = root;
+		while (!nodes[index].isLeaf())
+		{
+			i32 child1 = nodes[index].child1;
+			i32 child2 = nodes[index].child2;
+
+			float area = nodes[index].aabb.getSurfaceArea();
+			float combinedArea = AABB::merge(nodes[index].aabb, leafAABB).getSurfaceArea();
+
+			// Cost of making a new parent for this node and the leaf
+			float cost = 2.0f * combinedArea;
+			// Minimum cost of pushing the leaf further down
+			float inheritanceCost = 2.0f * (combinedArea - area);
+
+			auto descendCost = [this, &leafAABB, inheritanceCost](i32 child)
+			{
+				AABB merged = AABB::merge(leafAABB, nodes[child].aabb);
+				if (nodes[child].isLeaf())
+					return merged.getSurfaceArea() + inheritanceCost;
+				return merged.getSurfaceArea() - nodes[child].aabb.getSurfaceArea() + inheritanceCost;
+			};
+
+			float cost1 = descendCost(child1);
+			float cost2 = descendCost(child2);
+
+			if (cost < cost1 && cost < cost2)
+				break;
+
+			index = cost1 < cost2 ? child1 : child2;
+		}
+
+		i32 sibling = index;
+
+		i32 oldParent = nodes[sibling].parent;
+		i32 newParent = allocateNode();
+		nodes[newParent].parent = oldParent;
+		nodes[newParent].aabb = AABB::merge(leafAABB, nodes[sibling].aabb);
+		nodes[newParent].height = nodes[sibling].height + 1;
+		nodes[newParent].child1 = sibling;
+		nodes[newParent].child2 = leaf;
+		nodes[sibling].parent = newParent;
+		nodes[leaf].parent = newParent;
+
+		if (oldParent != NULL_NODE)
+		{
+			if (nodes[oldParent].child1 == sibling)
+				nodes[oldParent].child1 = newParent;
+			else
+				nodes[oldParent].child2 = newParent;
+		}
+		else
+		{
+			root = newParent;
+		}
+
+		// Walk back up fixing heights and boxes
+		index = nodes[leaf].parent;
+		while (index != NULL_NODE)
+		{
+			index = balance(index);
+
+			i32 child1 = nodes[index].child1;
+			i32 child2 = nodes[index].child2;
+
+			nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+			nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+
+			index = nodes[index].parent;
+		}
+	}
+
+	void DynamicTree::removeLeaf(i32 leaf)
+	{
+		if (leaf == root)
+		{
+			root = NULL_NODE;
+			return;
+		}
+
+		i32 parent = nodes[leaf].parent;
+		i32 grandParent = nodes[parent].parent;
+		i32 sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+		if (grandParent == NULL_NODE)
+		{
+			root = sibling;
+			nodes[sibling].parent = NULL_NODE;
+			freeNode(parent);
+			return;
+		}
+
+		// Replace the parent with the sibling
+		if (nodes[grandParent].child1 == parent)
+			nodes[grandParent].child1 = sibling;
+		else
+			nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		freeNode(parent);
+
+		i32 index = grandParent;
+		while (index != NULL_NODE)
+		{
+			index = balance(index);
+
+			i32 child1 = nodes[index].child1;
+			i32 child2 = nodes[index].child2;
+
+			nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+			nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+			index = nodes[index].parent;
+		}
+	}
+
+	i32 DynamicTree::balance(i32 iA)
+	{
+		Node& A = nodes[iA];
+		if (A.isLeaf() || A.height < 2)
+			return iA;
+
+		i32 iB = A.child1;
+		i32 iC = A.child2;
+		i32 heightDiff = nodes[iC].height - nodes[iB].height;
+
+		// Rotate the taller child up into A's place
+		auto rotate = [this, iA](i32 iUp, i32 iOther, bool upIsChild2)
+		{
+			Node& A = nodes[iA];
+			Node& up = nodes[iUp];
+
+			i32 iF = up.child1;
+			i32 iG = up.child2;
+
+			up.child1 = iA;
+			up.parent = A.parent;
+			A.parent = iUp;
+
+			if (up.parent != NULL_NODE)
+			{
+				if (nodes[up.parent].child1 == iA)
+					nodes[up.parent].child1 = iUp;
+				else
+					nodes[up.parent].child2 = iUp;
+			}
+			else
+			{
+				root = iUp;
+			}
+
+			// Keep the taller grandchild up top, move the shorter one down under A
+			i32 iKeep = nodes[iF].height > nodes[iG].height ? iF : iG;
+			i32 iMove = iKeep == iF ? iG : iF;
+
+			up.child2 = iKeep;
+			if (upIsChild2)
+				A.child2 = iMove;
+			else
+				A.child1 = iMove;
+			nodes[iMove].parent = iA;
+
+			A.aabb = AABB::merge(nodes[iOther].aabb, nodes[iMove].aabb);
+			up.aabb = AABB::merge(A.aabb, nodes[iKeep].aabb);
+
+			A.height = 1 + std::max(nodes[iOther].height, nodes[iMove].height);
+			up.height = 1 + std::max(A.height, nodes[iKeep].height);
+
+			return iUp;
+		};
+
+		if (heightDiff > 1)
+			return rotate(iC, iB, true);
+		if (heightDiff < -1)
+			return rotate(iB, iC, false);
+
+		return iA;
+	}
+
+	void DynamicTree::setProxyAABB(i32 proxy, const AABB& aabb)
+	{
+		KU_CORE_ASSERT(nodes[proxy].isLeaf(), "Set the box of a dynamic tree node that isn't a proxy.");
+
+		glm::vec3 r(margin);
+		nodes[proxy].aabb = AABB(aabb.min - r, aabb.max + r);
+	}
+
+	void DynamicTree::refit()
+	{
+		if (root != NULL_NODE)
+			refitNode(root);
+	}
+
+	void DynamicTree::refitNode(i32 index)
+	{
+		if (nodes[index].isLeaf())
+			return;
+
+		i32 child1 = nodes[index].child1;
+		i32 child2 = nodes[index].child2;
+		refitNode(child1);
+		refitNode(child2);
+
+		nodes[index].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+	}
+
+	void DynamicTree::rebuild()
+	{
+		KU_PROFILE_FUNCTION();
+
+		if (root == NULL_NODE)
+			return;
+
+		// Keep the leaves, so proxies stay valid, and throw away everything above them
+		std::vector<i32> leaves;
+		leaves.reserve(proxyCount);
+		for (i32 i = 0; i < (i32)nodes.size(); i++)
+		{
+			if (nodes[i].height < 0)
+				continue;
+
+			if (nodes[i].isLeaf())
+			{
+				nodes[i].parent = NULL_NODE;
+				leaves.push_back(i);
+			}
+			else
+			{
+				freeNode(i);
+			}
+		}
+
+		root = buildNode(leaves.data(), leaves.size());
+		nodes[root].parent = NULL_NODE;
+	}
+
+	i32 DynamicTree::buildNode(i32* leaves, u32 count)
+	{
+		if (count == 1)
+			return leaves[0];
+
+		// Split along the longest axis of the leaves' centres
+		AABB centres(nodes[leaves[0]].aabb.getCentre(), nodes[leaves[0]].aabb.getCentre());
+		for (u32 i = 1; i < count; i++)
+		{
+			glm::vec3 centre = nodes[leaves[i]].aabb.getCentre();
+			centres = AABB::merge(centres, AABB(centre, centre));
+		}
+
+		glm::vec3 extent = centres.max - centres.min;
+		u32 axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+		auto centreOf = [this, axis](i32 leaf) { return nodes[leaf].aabb.getCentre()[axis]; };
+
+		u32 split = 0;
+		if (extent[axis] > 0.0f)
+		{
+			auto binOf = [&](i32 leaf)
+			{
+				return std::min((u32)((centreOf(leaf) - centres.min[axis]) / extent[axis] * REBUILD_BINS), REBUILD_BINS - 1);
+			};
+
+			AABB binBoxes[REBUILD_BINS];
+			u32 binCounts[REBUILD_BINS] = {};
+			for (u32 i = 0; i < count; i++)
+			{
+				u32 bin = binOf(leaves[i]);
+				binBoxes[bin] = binCounts[bin]++ == 0 ? nodes[leaves[i]].aabb : AABB::merge(binBoxes[bin], nodes[leaves[i]].aabb);
+			}
+
+			// Surface area heuristic: the cheapest split has the least area weighted by the number of leaves on each side
+			float rightAreas[REBUILD_BINS];
+			AABB right;
+			u32 rightCount = 0;
+			for (u32 i = REBUILD_BINS - 1; i > 0; i--)
+			{
+				if (binCounts[i])
+					right = rightCount == 0 ? binBoxes[i] : AABB::merge(right, binBoxes[i]);
+				rightCount += binCounts[i];
+				rightAreas[i] = rightCount ? right.getSurfaceArea() * rightCount : 0.0f;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			u32 bestBin = REBUILD_BINS / 2;
+			AABB left;
+			u32 leftCount = 0;
+			for (u32 i = 1; i < REBUILD_BINS; i++)
+			{
+				if (binCounts[i - 1])
+					left = leftCount == 0 ? binBoxes[i - 1] : AABB::merge(left, binBoxes[i - 1]);
+				leftCount += binCounts[i - 1];
+
+				if (leftCount == 0 || leftCount == count)
+					continue;
+
+				float cost = left.getSurfaceArea() * leftCount + rightAreas[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBin = i;
+				}
+			}
+
+			split = (u32)(std::partition(leaves, leaves + count, [&](i32 leaf) { return binOf(leaf) < bestBin; }) - leaves);
+		}
+
+		// Lopsided splits make deep trees, so fall back to the median
+		u32 minSide = std::max(count / 8, 1u);
+		if (split < minSide || split > count - minSide)
+		{
+			split = count / 2;
+			std::nth_element(leaves, leaves + split, leaves + count, [&](i32 a, i32 b) { return centreOf(a) < centreOf(b); });
+		}
+
+		i32 node = allocateNode();
+		i32 child1 = buildNode(leaves, split);
+		i32 child2 = buildNode(leaves + split, count - split);
+
+		nodes[node].child1 = child1;
+		nodes[node].child2 = child2;
+		nodes[node].aabb = AABB::merge(nodes[child1].aabb, nodes[child2].aabb);
+		nodes[node].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+		nodes[child1].parent = node;
+		nodes[child2].parent = node;
+
+		return node;
+	}
+
+	float DynamicTree::getAreaRatio() const
+	{
+		if (root == NULL_NODE || nodes[root].isLeaf())
+			return 0.0f;
+
+		float total = 0.0f;
+		for (const Node& node : nodes)
+		{
+			if (node.height > 0)
+				total += node.aabb.getSurfaceArea();
+		}
+
+		return total / std::max(nodes[root].aabb.getSurfaceArea(), 1e-6f);
+	}
+}
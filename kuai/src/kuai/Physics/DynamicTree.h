@@ -0,0 +1,198 @@
+#pragma once
+
+#include "AABB.h"
+#include "Ray.h"
+
+// @cond
+namespace kuai {
+	/**
+	* Bounding volume hierarchy over objects that move. Each object (a proxy) is stored in a leaf with a fattened box,
+	* so small movements don't touch the tree; moving out of it reinserts the leaf. Rotations keep the tree balanced.
+	*/
+	class DynamicTree
+	{
+	public:
+		static const i32 NULL_NODE = -1;
+
+		/**
+		* Add an object, returning its proxy. userData is handed back by queries.
+		*/
+		i32 createProxy(const AABB& aabb, u32 userData);
+		void destroyProxy(i32 proxy);
+
+		/**
+		* Update a proxy's bounds; the fat box is stretched along displacement to predict where it's heading.
+		* Returns true if the proxy had to be reinserted.
+		*/
+		bool moveProxy(i32 proxy, const AABB& aabb, const glm::vec3& displacement);
+
+		const AABB& getFatAABB(i32 proxy) const { return nodes[proxy].aabb; }
+		u32 getUserData(i32 proxy) const { return nodes[proxy].userData; }
+
+		/**
+		* Call fn(userData) for every proxy whose fat box overlaps aabb. Returning false from fn stops the query.
+		* Safe to call from several threads at once while the tree isn't being modified, as are the other queries.
+		*/
+		template<typename Fn>
+		void query(const AABB& aabb, Fn&& fn) const
+		{
+			traverse([&aabb](const AABB& box) { return box.overlaps(aabb); }, fn);
+		}
+
+		/**
+		* Call fn(userData) for every proxy whose fat box passes test(box). Subtrees whose box fails are skipped,
+		* so the test must pass any box that contains a box it passes (true of frustum, sphere and box overlap tests).
+		*/
+		template<typename Test, typename Fn>
+		void traverse(Test&& test, Fn&& fn) const
+		{
+			i32 stack[MAX_STACK];
+			i32 count = 0;
+			if (root != NULL_NODE)
+				stack[count++] = root;
+
+			while (count > 0)
+			{
+				const Node& node = nodes[stack[--count]];
+				if (!test(node.aabb))
+					continue;
+
+				if (node.isLeaf())
+				{
+					if (!fn(node.userData))
+						return;
+				}
+				else
+				{
+					KU_CORE_ASSERT(count + 2 <= MAX_STACK, "Dynamic tree is too deep to query.");
+					stack[count++] = node.child1;
+					stack[count++] = node.child2;
+				}
+			}
+		}
+
+		/**
+		* Call fn(userData, maxDist) for every proxy whose fat box the ray passes through within maxDist, nearer boxes first where cheap.
+		* fn returns the distance to clip the ray to: a hit's distance to only look for closer hits, maxDist to carry on, or zero to stop.
+		*/
+		template<typename Fn>
+		void rayCast(const Ray& ray, float maxDist, Fn&& fn) const
+		{
+			glm::vec3 invDir = 1.0f / ray.dir;
+
+			i32 stack[MAX_STACK];
+			i32 count = 0;
+			float dist;
+			if (root != NULL_NODE && intersectRayAABB(ray.origin, invDir, nodes[root].aabb, maxDist, dist))
+				stack[count++] = root;
+
+			while (count > 0)
+			{
+				const Node& node = nodes[stack[--count]];
+
+				// maxDist may have shrunk since this was pushed
+				if (!intersectRayAABB(ray.origin, invDir, node.aabb, maxDist, dist))
+					continue;
+
+				if (node.isLeaf())
+				{
+					float clip = fn(node.userData, maxDist);
+					if (clip <= 0.0f)
+						return;
+					maxDist = std::min(maxDist, clip);
+					continue;
+				}
+
+				float dist1, dist2;
+				bool hit1 = intersectRayAABB(ray.origin, invDir, nodes[node.child1].aabb, maxDist, dist1);
+				bool hit2 = intersectRayAABB(ray.origin, invDir, nodes[node.child2].aabb, maxDist, dist2);
+
+				KU_CORE_ASSERT(count + 2 <= MAX_STACK, "Dynamic tree is too deep to query.");
+
+				// Push the nearer child last so it's visited first and clips the ray for the other
+				if (hit1 && hit2)
+				{
+					stack[count++] = dist1 < dist2 ? node.child2 : node.child1;
+					stack[count++] = dist1 < dist2 ? node.child1 : node.child2;
+				}
+				else if (hit1)
+				{
+					stack[count++] = node.child1;
+				}
+				else if (hit2)
+				{
+					stack[count++] = node.child2;
+				}
+			}
+		}
+
+		/**
+		* Set a proxy's box (grown by the margin) without restructuring the tree. Call refit() once after a batch of these.
+		*/
+		void setProxyAABB(i32 proxy, const AABB& aabb);
+
+		/**
+		* Recompute every internal box from the leaves, keeping the tree's shape. Cheaper than reinserting
+		* when most proxies moved a little, but the tree gets worse as they drift from where they were inserted.
+		*/
+		void refit();
+
+		/**
+		* Rebuild the whole tree top down from its leaves, splitting by the surface area heuristic.
+		*/
+		void rebuild();
+
+		/**
+		* Total surface area of the internal nodes relative to the root's. Lower means cheaper queries; a rising ratio after refits means it's time to rebuild.
+		*/
+		float getAreaRatio() const;
+
+		/**
+		* How much leaf boxes are grown by on every side.
+		*/
+		void setMargin(float margin) { this->margin = margin; }
+
+		u32 getProxyCount() const { return proxyCount; }
+		i32 getHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+	private:
+		struct Node
+		{
+			AABB aabb;
+			u32 userData = 0;
+
+			i32 parent = NULL_NODE; // Next free node while on the free list
+			i32 child1 = NULL_NODE;
+			i32 child2 = NULL_NODE;
+
+			i32 height = 0; // Leaves are 0, free nodes -1
+
+			bool isLeaf() const { return child1 == NULL_NODE; }
+		};
+
+		static const i32 MAX_STACK = 256;
+
+		i32 allocateNode();
+		void freeNode(i32 node);
+
+		void insertLeaf(i32 leaf);
+		void removeLeaf(i32 leaf);
+
+		/**
+		* Rotate the subtree at a so neither child is more than one level taller than the other. Returns the new subtree root.
+		*/
+		i32 balance(i32 a);
+
+		void refitNode(i32 node);
+		i32 buildNode(i32* leaves, u32 count);
+
+	private:
+		std::vector<Node> nodes;
+		i32 root = NULL_NODE;
+		i32 freeList = NULL_NODE;
+		u32 proxyCount = 0;
+
+		float margin = 0.1f;
+	};
+}
+// @endcond
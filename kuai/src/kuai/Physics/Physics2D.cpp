@@ -0,0 +1,309 @@
+#include "kpch.h"
+#include "Physics2D.h"
+
+#include "kuai/Components/Entity.h"
+#include "kuai/Components/EntityComponentSystem.h"
+#include "kuai/Core/JobSystem.h"
+
+#include <atomic>
+#include <thread>
+
+namespace kuai {
+	// Box2D hands out a handful of tasks per stage of a step; anything beyond this many in flight runs inline
+	static const u32 MAX_TASKS = 128;
+
+	struct PhysicsTask
+	{
+		JobCounter counter{ 0 };
+	};
+
+	static PhysicsTask tasks[MAX_TASKS];
+	static std::atomic<u32> taskCount{ 0 };
+
+	// Box2D gives each worker its own scratch space, indexed by the worker index passed to its tasks. Jobs can run on threads
+	// the job system doesn't number (a render thread helping out while it waits), so slots are claimed per job rather than per thread.
+	static std::atomic<u64> workerSlots{ 0 };
+	static u32 workerCount = 0;
+
+	static u32 claimWorkerSlot()
+	{
+		while (true)
+		{
+			u64 slots = workerSlots.load();
+			for (u32 i = 0; i < workerCount; i++)
+			{
+				if (!(slots & (1ull << i)) && workerSlots.compare_exchange_weak(slots, slots | (1ull << i)))
+					return i;
+			}
+			std::this_thread::yield();
+		}
+	}
+
+	static void releaseWorkerSlot(u32 slot)
+	{
+		workerSlots.fetch_and(~(1ull << slot));
+	}
+
+	static b2Vec2 toB2(const glm::vec2& v) { return { v.x, v.y }; }
+	static glm::vec2 toGlm(const b2Vec2& v) { return { v.x, v.y }; }
+
+	Physics2DSystem::~Physics2DSystem()
+	{
+		if (worldCreated)
+			b2DestroyWorld(worldId);
+	}
+
+	void Physics2DSystem::init()
+	{
+		workerCount = std::min(JobSystem::getThreadCount() + 1, 64u); // Plus one for a thread outside the job system
+
+		b2WorldDef worldDef = b2DefaultWorldDef();
+		worldDef.gravity = toB2(gravity);
+		worldDef.workerCount = workerCount;
+		worldDef.enqueueTask = &Physics2DSystem::enqueueTask;
+		worldDef.finishTask = &Physics2DSystem::finishTask;
+		worldDef.userTaskContext = this;
+
+		worldId = b2CreateWorld(&worldDef);
+		worldCreated = true;
+	}
+
+	void Physics2DSystem::setGravity(const glm::vec2& gravity)
+	{
+		this->gravity = gravity;
+		b2World_SetGravity(worldId, toB2(gravity));
+	}
+
+	void Physics2DSystem::insertEntity(EntityID id)
+	{
+		System::insertEntity(id);
+
+		// Components are often added one at a time, so the body is made on the next step once they're all there
+		pendingBodies.push_back(id);
+	}
+
+	void Physics2DSystem::removeEntity(EntityID id)
+	{
+		auto it = bodies.find(id);
+		if (it != bodies.end())
+		{
+			b2DestroyBody(it->second.bodyId);
+			bodies.erase(it);
+		}
+		pendingBodies.erase(std::remove(pendingBodies.begin(), pendingBodies.end(), id), pendingBodies.end());
+
+		System::removeEntity(id);
+	}
+
+	void Physics2DSystem::step(float dt)
+	{
+		KU_PROFILE_FUNCTION();
+
+		for (EntityID id : pendingBodies)
+		{
+			createBody(id);
+		}
+		pendingBodies.clear();
+
+		for (auto& pair : bodies)
+		{
+			syncBody(pair.first, pair.second);
+		}
+
+		taskCount = 0;
+		b2World_Step(worldId, dt, subSteps);
+
+		// Only bodies that moved are reported, so sleeping and static bodies cost nothing here
+		b2BodyEvents events = b2World_GetBodyEvents(worldId);
+		for (i32 i = 0; i < events.moveCount; i++)
+		{
+			const b2BodyMoveEvent& event = events.moveEvents[i];
+			EntityID id = (EntityID)(uintptr_t)event.userData;
+
+			auto it = bodies.find(id);
+			if (it == bodies.end())
+				continue;
+
+			Body& body = it->second;
+			body.pos = toGlm(event.transform.p);
+			body.angle = b2Rot_GetAngle(event.transform.q);
+			body.velocity = toGlm(b2Body_GetLinearVelocity(body.bodyId));
+
+			Transform& transform = ECS->getComponent<Transform>(id);
+			glm::vec3 pos = transform.getPos();
+			glm::vec3 rot = transform.getRot();
+			transform.setPos(body.pos.x, body.pos.y, pos.z);
+			transform.setRot(rot.x, rot.y, glm::degrees(body.angle));
+
+			if (body.dynamic)
+			{
+				Rigidbody2D& rb = ECS->getComponent<Rigidbody2D>(id);
+				rb.velocity = glm::vec3(body.velocity, rb.velocity.z);
+			}
+		}
+	}
+
+	void Physics2DSystem::createBody(EntityID id)
+	{
+		if (bodies.find(id) != bodies.end())
+			return;
+
+		Transform& transform = ECS->getComponent<Transform>(id);
+
+		Body body;
+		body.dynamic = ECS->hasComponent<Rigidbody2D>(id);
+		body.pos = glm::vec2(transform.getPos());
+		body.angle = glm::radians(transform.getRot().z);
+
+		b2BodyDef bodyDef = b2DefaultBodyDef();
+		bodyDef.type = body.dynamic ? b2_dynamicBody : b2_staticBody;
+		bodyDef.position = toB2(body.pos);
+		bodyDef.rotation = b2MakeRot(body.angle);
+		bodyDef.userData = (void*)(uintptr_t)id;
+
+		if (body.dynamic)
+		{
+			Rigidbody2D& rb = ECS->getComponent<Rigidbody2D>(id);
+			body.velocity = glm::vec2(rb.velocity);
+			body.drag = rb.drag;
+			body.useGravity = rb.useGravity;
+			body.fixedRotation = rb.fixedRotation;
+
+			bodyDef.linearVelocity = toB2(body.velocity);
+			bodyDef.linearDamping = rb.drag;
+			bodyDef.gravityScale = rb.useGravity ? 1.0f : 0.0f;
+			bodyDef.fixedRotation = rb.fixedRotation;
+		}
+
+		body.bodyId = b2CreateBody(worldId, &bodyDef);
+		bodies[id] = body;
+	}
+
+	void Physics2DSystem::syncBody(EntityID id, Body& body)
+	{
+		// A rigidbody added to or removed from a static collider changes the body's type
+		bool dynamic = ECS->hasComponent<Rigidbody2D>(id);
+		if (dynamic != body.dynamic)
+		{
+			body.dynamic = dynamic;
+			b2Body_SetType(body.bodyId, dynamic ? b2_dynamicBody : b2_staticBody);
+		}
+
+		// Teleports through the transform
+		Transform& transform = ECS->getComponent<Transform>(id);
+		glm::vec2 pos = glm::vec2(transform.getPos());
+		float angle = glm::radians(transform.getRot().z);
+		if (pos != body.pos || std::abs(angle - body.angle) > 1e-5f)
+		{
+			body.pos = pos;
+			body.angle = angle;
+			b2Body_SetTransform(body.bodyId, toB2(pos), b2MakeRot(angle));
+			b2Body_SetAwake(body.bodyId, true);
+		}
+
+		if (body.dynamic)
+		{
+			Rigidbody2D& rb = ECS->getComponent<Rigidbody2D>(id);
+			glm::vec2 velocity = glm::vec2(rb.velocity);
+			if (velocity != body.velocity)
+			{
+				body.velocity = velocity;
+				b2Body_SetLinearVelocity(body.bodyId, toB2(velocity));
+			}
+
+			if (rb.drag != body.drag || rb.useGravity != body.useGravity || rb.fixedRotation != body.fixedRotation)
+			{
+				body.drag = rb.drag;
+				body.useGravity = rb.useGravity;
+				body.fixedRotation = rb.fixedRotation;
+
+				b2Body_SetLinearDamping(body.bodyId, rb.drag);
+				b2Body_SetGravityScale(body.bodyId, rb.useGravity ? 1.0f : 0.0f);
+				b2Body_SetFixedRotation(body.bodyId, rb.fixedRotation);
+			}
+		}
+
+		syncShape(id, body);
+	}
+
+	void Physics2DSystem::syncShape(EntityID id, Body& body)
+	{
+		if (!ECS->hasComponent<BoxCollider2D>(id))
+		{
+			if (body.hasShape)
+			{
+				b2DestroyShape(body.shapeId, true);
+				body.hasShape = false;
+			}
+			return;
+		}
+
+		BoxCollider2D& collider = ECS->getComponent<BoxCollider2D>(id);
+		glm::vec2 scale = glm::vec2(ECS->getComponent<Transform>(id).getScale());
+		float mass = body.dynamic ? ECS->getComponent<Rigidbody2D>(id).mass : 0.0f;
+
+		if (body.hasShape && collider.getSize() == body.size && collider.getOffset() == body.offset && scale == body.scale
+			&& collider.getFriction() == body.friction && collider.getRestitution() == body.restitution && mass == body.mass)
+			return;
+
+		if (body.hasShape)
+			b2DestroyShape(body.shapeId, false);
+
+		body.size = collider.getSize();
+		body.offset = collider.getOffset();
+		body.scale = scale;
+		body.friction = collider.getFriction();
+		body.restitution = collider.getRestitution();
+		body.mass = mass;
+
+		// Collider size is the box's half extents before scaling
+		glm::vec2 halfExtents = glm::abs(body.size * scale);
+
+		b2ShapeDef shapeDef = b2DefaultShapeDef();
+		shapeDef.density = mass / std::max(4.0f * halfExtents.x * halfExtents.y, 1e-6f); // Box2D works in density, components in mass
+		shapeDef.material.friction = body.friction;
+		shapeDef.material.restitution = body.restitution;
+
+		b2Polygon box = b2MakeOffsetBox(halfExtents.x, halfExtents.y, toB2(body.offset * scale), b2Rot_identity);
+		body.shapeId = b2CreatePolygonShape(body.bodyId, &shapeDef, &box);
+		body.hasShape = true;
+	}
+
+	void* Physics2DSystem::enqueueTask(b2TaskCallback* task, i32 itemCount, i32 minRange, void* taskContext, void* userContext)
+	{
+		u32 index = taskCount++;
+		if (index >= MAX_TASKS)
+		{
+			// Out of task slots, so run it here; returning nullptr tells Box2D there's nothing to wait on
+			u32 slot = claimWorkerSlot();
+			task(0, itemCount, slot, taskContext);
+			releaseWorkerSlot(slot);
+			return nullptr;
+		}
+
+		PhysicsTask& physicsTask = tasks[index];
+		physicsTask.counter = 0;
+
+		// Split into at most one range per thread, but no smaller than Box2D asks for
+		u32 threads = JobSystem::getThreadCount();
+		i32 rangeSize = std::max(minRange, (itemCount + (i32)threads - 1) / (i32)threads);
+
+		for (i32 start = 0; start < itemCount; start += rangeSize)
+		{
+			i32 end = std::min(start + rangeSize, itemCount);
+			JobSystem::execute(physicsTask.counter, [task, start, end, taskContext]()
+			{
+				u32 slot = claimWorkerSlot();
+				task(start, end, slot, taskContext);
+				releaseWorkerSlot(slot);
+			});
+		}
+
+		return &physicsTask;
+	}
+
+	void Physics2DSystem::finishTask(void* userTask, void* userContext)
+	{
+		JobSystem::wait(static_cast<PhysicsTask*>(userTask)->counter);
+	}
+}
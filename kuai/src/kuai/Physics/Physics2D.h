@@ -1 +1,76 @@
 #pragma once
+
+#include "kuai/Components/System.h"
+
+#include "box2d/box2d.h"
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	/** \class Physics2DSystem
+	*	\brief Simulates entities with Rigidbody2D and BoxCollider2D components in a Box2D world.
+	*
+	*	Entities with a collider but no rigidbody become static bodies. The world is stepped on the app's fixed timestep,
+	*	with the solver's parallel work spread across the job system, and only bodies that moved are written back to their Transform.
+	*/
+	class Physics2DSystem : public System
+	{
+	public:
+		~Physics2DSystem();
+
+		void init() override;
+
+		void update(float dt) override {}
+
+		/**
+		* Push component changes into the world, advance it by dt and write moved bodies back to their transforms.
+		*/
+		void step(float dt);
+
+		void insertEntity(EntityID id) override;
+		void removeEntity(EntityID id) override;
+
+		void setGravity(const glm::vec2& gravity);
+		glm::vec2 getGravity() const { return gravity; }
+
+		/**
+		* Number of solver sub-steps per step; more is stiffer and more expensive. Box2D recommends 4.
+		*/
+		void setSubSteps(u32 count) { subSteps = std::max(count, 1u); }
+
+	private:
+		struct Body
+		{
+			b2BodyId bodyId;
+			b2ShapeId shapeId;
+			bool hasShape = false;
+			bool dynamic = false;
+
+			// What was last sent to or read back from Box2D, to spot changes made through the components
+			glm::vec2 pos = glm::vec2(0.0f);
+			float angle = 0.0f;
+			glm::vec2 velocity = glm::vec2(0.0f);
+			glm::vec2 size = glm::vec2(0.0f), offset = glm::vec2(0.0f), scale = glm::vec2(0.0f);
+			float friction = 0.0f, restitution = 0.0f, mass = 0.0f;
+			float drag = 0.0f;
+			bool useGravity = false, fixedRotation = false;
+		};
+
+		void createBody(EntityID id);
+		void syncBody(EntityID id, Body& body);
+		void syncShape(EntityID id, Body& body);
+
+		static void* enqueueTask(b2TaskCallback* task, i32 itemCount, i32 minRange, void* taskContext, void* userContext);
+		static void finishTask(void* userTask, void* userContext);
+
+	private:
+		b2WorldId worldId;
+		bool worldCreated = false;
+
+		std::unordered_map<EntityID, Body> bodies;
+		std::vector<EntityID> pendingBodies;
+
+		glm::vec2 gravity = glm::vec2(0.0f, -9.81f);
+		u32 subSteps = 4;
+	};
+}
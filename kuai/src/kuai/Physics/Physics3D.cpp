@@ -0,0 +1,781 @@
+#include "kpch.h"
+#include "Physics3D.h"
+
+#include "kuai/Components/Entity.h"
+#include "kuai/Components/EntityComponentSystem.h"
+#include "kuai/Core/JobSystem.h"
+
+namespace kuai {
+	// Fraction of the penetration beyond the slop that is pushed out each step
+	static const float BAUMGARTE = 0.2f;
+	static const float LINEAR_SLOP = 0.005f;
+	// Impacts slower than this don't bounce, so resting bodies settle
+	static const float RESTITUTION_THRESHOLD = 1.0f;
+
+	// An island sleeps once all of its bodies have been slower than this for TIME_TO_SLEEP seconds
+	static const float LINEAR_SLEEP_TOLERANCE = 0.05f;
+	static const float ANGULAR_SLEEP_TOLERANCE = 0.035f;
+	static const float TIME_TO_SLEEP = 0.5f;
+
+	// Contact points within this distance of one from the last step (in body A's frame) inherit its impulses
+	static const float MATCH_DISTANCE = 0.05f;
+
+	// Bodies per job in the broadphase and narrowphase
+	static const u32 PAIR_GROUP_SIZE = 64;
+
+	static glm::mat3 worldInvInertia(const glm::quat& rotation, const glm::vec3& invInertiaLocal)
+	{
+		glm::mat3 rot = glm::mat3_cast(rotation);
+		glm::mat3 local(0.0f);
+		local[0][0] = invInertiaLocal.x;
+		local[1][1] = invInertiaLocal.y;
+		local[2][2] = invInertiaLocal.z;
+		return rot * local * glm::transpose(rot);
+	}
+
+	void Physics3DSystem::insertEntity(EntityID id)
+	{
+		System::insertEntity(id);
+
+		// Components are often added one at a time, so the body is made on the next step once they're all there
+		pendingBodies.push_back(id);
+	}
+
+	void Physics3DSystem::removeEntity(EntityID id)
+	{
+		auto it = bodyIndices.find(id);
+		if (it != bodyIndices.end())
+		{
+			u32 index = it->second;
+			Body& body = bodies[index];
+			if (body.proxy != DynamicTree::NULL_NODE)
+				tree.destroyProxy(body.proxy);
+
+			body = Body();
+			freeBodies.push_back(index);
+			bodyIndices.erase(it);
+
+			// The slot will be reused, so it mustn't inherit this body's contacts
+			for (auto contact = lastContacts.begin(); contact != lastContacts.end();)
+			{
+				if ((u32)(contact->first >> 32) == index || (u32)contact->first == index)
+					contact = lastContacts.erase(contact);
+				else
+					contact++;
+			}
+		}
+		pendingBodies.erase(std::remove(pendingBodies.begin(), pendingBodies.end(), id), pendingBodies.end());
+
+		System::removeEntity(id);
+	}
+
+	bool Physics3DSystem::getVelocities(const EntityID* ids, u32 count, glm::vec3* out)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			if (!ECS->hasComponent<Rigidbody>(ids[i]))
+				return false;
+			out[i] = ECS->getComponent<Rigidbody>(ids[i]).velocity;
+		}
+		return true;
+	}
+
+	bool Physics3DSystem::setVelocities(const EntityID* ids, u32 count, const glm::vec3* values)
+	{
+		for (u32 i = 0; i < count; i++)
+		{
+			if (!ECS->hasComponent<Rigidbody>(ids[i]))
+				return false;
+			ECS->getComponent<Rigidbody>(ids[i]).velocity = values[i];
+		}
+		return true;
+	}
+
+	void Physics3DSystem::step(float dt)
+	{
+		KU_PROFILE_FUNCTION();
+
+		using Clock = std::chrono::steady_clock;
+		auto millisSince = [](Clock::time_point start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); };
+
+		for (EntityID id : pendingBodies)
+		{
+			createBody(id);
+		}
+		pendingBodies.clear();
+
+		for (auto& body : bodies)
+		{
+			if (body.alive)
+				syncBody(body);
+		}
+
+		Clock::time_point start = Clock::now();
+
+		for (auto& body : bodies)
+		{
+			if (!body.alive || !body.awake || body.type != BodyType::DYNAMIC)
+				continue;
+
+			if (body.useGravity)
+				body.velocity += gravity * dt;
+
+			body.velocity *= 1.0f / (1.0f + dt * body.drag);
+			body.angularVelocity *= 1.0f / (1.0f + dt * body.angularDrag);
+
+			body.invInertia = worldInvInertia(body.rot, body.invInertiaLocal);
+		}
+
+		findPairs();
+		stats.broadphase = millisSince(start);
+
+		start = Clock::now();
+		collidePairs();
+		buildIslands();
+		stats.narrowphase = millisSince(start);
+
+		start = Clock::now();
+
+		// Islands share nothing that's written, so they solve in any order on any thread with the same result
+		JobSystem::parallelFor(islands.size(), 4, [this, dt](u32 start, u32 end)
+		{
+			for (u32 i = start; i < end; i++)
+			{
+				solveIsland(islands[i], dt);
+			}
+		});
+
+		for (auto& body : bodies)
+		{
+			if (body.alive && body.awake && body.type == BodyType::KINEMATIC)
+			{
+				body.pos += body.velocity * dt;
+				body.rot = glm::normalize(body.rot + glm::quat(0.0f, body.angularVelocity) * body.rot * (0.5f * dt));
+			}
+		}
+		stats.solve = millisSince(start);
+
+		// Only bodies that were simulated this step can have moved
+		stats.awakeBodies = 0;
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			Body& body = bodies[i];
+			bool simulated = islandIndices[i] != ~0u || (body.awake && body.type == BodyType::KINEMATIC);
+			if (!body.alive || !simulated)
+				continue;
+
+			updateProxy(body, body.velocity * dt);
+			writeBack(body);
+			stats.awakeBodies++;
+		}
+
+		stats.bodies = bodyIndices.size();
+		stats.contacts = contacts.size();
+		stats.islands = islands.size();
+
+		// Keep this step's contacts to warm start the next
+		lastContactList.swap(contacts);
+		lastContacts.clear();
+		for (u32 i = 0; i < lastContactList.size(); i++)
+		{
+			lastContacts[pairKey(lastContactList[i].bodyA, lastContactList[i].bodyB)] = i;
+		}
+	}
+
+	void Physics3DSystem::createBody(EntityID id)
+	{
+		if (bodyIndices.find(id) != bodyIndices.end())
+			return;
+
+		u32 index;
+		if (freeBodies.empty())
+		{
+			index = bodies.size();
+			bodies.emplace_back();
+		}
+		else
+		{
+			// Lowest free slot first, so the layout only depends on the order bodies were added and removed
+			auto lowest = std::min_element(freeBodies.begin(), freeBodies.end());
+			index = *lowest;
+			freeBodies.erase(lowest);
+		}
+
+		Body& body = bodies[index];
+		body.id = id;
+		body.alive = true;
+		bodyIndices[id] = index;
+
+		// Compare unequal to anything, so the first sync reads everything from the components
+		body.lastPos = glm::vec3(std::numeric_limits<float>::quiet_NaN());
+		body.lastMass = std::numeric_limits<float>::quiet_NaN();
+
+		syncBody(body);
+	}
+
+	void Physics3DSystem::syncBody(Body& body)
+	{
+		EntityID id = body.id;
+		Transform& transform = ECS->getComponent<Transform>(id);
+
+		bool hasRigidbody = ECS->hasComponent<Rigidbody>(id);
+		Rigidbody* rb = hasRigidbody ? &ECS->getComponent<Rigidbody>(id) : nullptr;
+
+		BodyType type = !rb ? BodyType::STATIC : rb->isKinematic ? BodyType::KINEMATIC : BodyType::DYNAMIC;
+		bool massChanged = type != body.type || (rb && rb->mass != body.lastMass);
+		body.type = type;
+
+		// Teleports through the transform
+		bool moved = false;
+		glm::vec3 pos = transform.getPos();
+		glm::vec3 rot = transform.getRot();
+		if (pos != body.lastPos || rot != body.lastRot)
+		{
+			body.pos = pos;
+			body.rot = glm::quat(glm::radians(rot));
+			body.lastPos = pos;
+			body.lastRot = rot;
+			moved = true;
+		}
+
+		bool hasCollider = ECS->hasComponent<Collider>(id);
+		glm::vec3 scale = transform.getScale();
+		bool shapeChanged = hasCollider != body.hasShape
+			|| (hasCollider && (ECS->getComponent<Collider>(id).version != body.colliderVersion || scale != body.lastScale));
+
+		if (shapeChanged)
+		{
+			updateShape(body, scale);
+			massChanged = true;
+		}
+
+		if (massChanged)
+			updateMass(body);
+
+		bool velocityChanged = false;
+		if (rb)
+		{
+			if (rb->velocity != body.lastVelocity || rb->angularVelocity != body.lastAngularVelocity)
+			{
+				body.velocity = rb->velocity;
+				body.angularVelocity = rb->angularVelocity;
+				body.lastVelocity = rb->velocity;
+				body.lastAngularVelocity = rb->angularVelocity;
+				velocityChanged = true;
+			}
+
+			body.drag = rb->drag;
+			body.angularDrag = rb->angularDrag;
+			body.useGravity = rb->useGravity;
+		}
+		else
+		{
+			body.velocity = glm::vec3(0.0f);
+			body.angularVelocity = glm::vec3(0.0f);
+		}
+
+		if (moved || shapeChanged)
+			updateProxy(body, glm::vec3(0.0f));
+
+		switch (body.type)
+		{
+			case BodyType::DYNAMIC:
+				if (moved || shapeChanged || massChanged || velocityChanged)
+					wake(body);
+				break;
+			case BodyType::KINEMATIC:
+				// Kinematic bodies only need to look for contacts while moving
+				body.awake = moved || body.velocity != glm::vec3(0.0f) || body.angularVelocity != glm::vec3(0.0f);
+				break;
+			case BodyType::STATIC:
+				body.awake = false;
+				if (moved || shapeChanged)
+					wake(body);
+				break;
+		}
+	}
+
+	void Physics3DSystem::updateShape(Body& body, const glm::vec3& scale)
+	{
+		body.lastScale = scale;
+
+		if (!ECS->hasComponent<Collider>(body.id))
+		{
+			if (body.proxy != DynamicTree::NULL_NODE)
+			{
+				tree.destroyProxy(body.proxy);
+				body.proxy = DynamicTree::NULL_NODE;
+			}
+			body.hasShape = false;
+			return;
+		}
+
+		Collider& collider = ECS->getComponent<Collider>(body.id);
+		glm::vec3 absScale = glm::abs(scale);
+
+		CollisionShape& shape = body.localShape;
+		switch (collider.getShape())
+		{
+			case Collider::Shape::Box:
+				shape.type = ShapeType::BOX;
+				shape.halfExtents = collider.getHalfExtents() * absScale;
+				break;
+			case Collider::Shape::Sphere:
+				shape.type = ShapeType::SPHERE;
+				shape.radius = collider.getRadius() * std::max({ absScale.x, absScale.y, absScale.z });
+				break;
+			case Collider::Shape::Capsule:
+				shape.type = ShapeType::CAPSULE;
+				shape.radius = collider.getRadius() * std::max(absScale.x, absScale.z);
+				shape.halfHeight = collider.getHalfHeight() * absScale.y;
+				break;
+		}
+		shape.centre = collider.getOffset() * scale;
+		shape.axes = glm::mat3(1.0f);
+
+		body.friction = collider.getFriction();
+		body.restitution = collider.getRestitution();
+		body.colliderVersion = collider.version;
+		body.hasShape = true;
+	}
+
+	void Physics3DSystem::updateMass(Body& body)
+	{
+		if (body.type != BodyType::DYNAMIC)
+		{
+			body.invMass = 0.0f;
+			body.invInertiaLocal = glm::vec3(0.0f);
+			body.invInertia = glm::mat3(0.0f);
+			body.lastMass = body.type == BodyType::KINEMATIC ? ECS->getComponent<Rigidbody>(body.id).mass : 0.0f;
+			return;
+		}
+
+		body.lastMass = ECS->getComponent<Rigidbody>(body.id).mass;
+		float mass = std::max(body.lastMass, 1e-4f);
+		body.invMass = 1.0f / mass;
+
+		// Inertia about the collider's centre; offset colliders still spin about the transform's position
+		glm::vec3 inertia;
+		const CollisionShape& shape = body.localShape;
+		if (!body.hasShape || shape.type == ShapeType::SPHERE)
+		{
+			float radius = body.hasShape ? shape.radius : 0.5f;
+			inertia = glm::vec3(0.4f * mass * radius * radius);
+		}
+		else if (shape.type == ShapeType::BOX)
+		{
+			glm::vec3 e2 = shape.halfExtents * shape.halfExtents;
+			inertia = (mass / 3.0f) * glm::vec3(e2.y + e2.z, e2.x + e2.z, e2.x + e2.y);
+		}
+		else
+		{
+			// Close enough to treat a capsule as a cylinder of its full length
+			float r2 = shape.radius * shape.radius;
+			float length = 2.0f * (shape.halfHeight + shape.radius);
+			float side = mass * (3.0f * r2 + length * length) / 12.0f;
+			inertia = glm::vec3(side, 0.5f * mass * r2, side);
+		}
+
+		body.invInertiaLocal = 1.0f / glm::max(inertia, glm::vec3(1e-6f));
+
+		body.invInertia = worldInvInertia(body.rot, body.invInertiaLocal);
+	}
+
+	void Physics3DSystem::updateProxy(Body& body, const glm::vec3& displacement)
+	{
+		if (!body.hasShape)
+			return;
+
+		glm::mat3 rot = glm::mat3_cast(body.rot);
+		body.shape = body.localShape;
+		body.shape.centre = body.pos + rot * body.localShape.centre;
+		body.shape.axes = rot;
+
+		AABB aabb = body.shape.getAABB();
+		if (body.proxy == DynamicTree::NULL_NODE)
+			body.proxy = tree.createProxy(aabb, (u32)(&body - bodies.data()));
+		else
+			tree.moveProxy(body.proxy, aabb, displacement);
+	}
+
+	void Physics3DSystem::wake(Body& body)
+	{
+		if (body.type == BodyType::DYNAMIC)
+		{
+			body.awake = true;
+			body.sleepTime = 0.0f;
+			return;
+		}
+
+		// Moving a static body wakes whatever was resting on it
+		if (!body.hasShape)
+			return;
+
+		tree.query(tree.getFatAABB(body.proxy), [this](u32 index)
+		{
+			Body& other = bodies[index];
+			if (other.type == BodyType::DYNAMIC)
+			{
+				other.awake = true;
+				other.sleepTime = 0.0f;
+			}
+			return true;
+		});
+	}
+
+	void Physics3DSystem::findPairs()
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Only moving bodies look for contacts; sleeping and static bodies wait to be found
+		std::vector<u32> movers;
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			const Body& body = bodies[i];
+			if (body.alive && body.hasShape && body.awake && body.type != BodyType::STATIC)
+				movers.push_back(i);
+		}
+
+		pairBuffers.resize((movers.size() + PAIR_GROUP_SIZE - 1) / PAIR_GROUP_SIZE);
+
+		JobSystem::parallelFor(movers.size(), PAIR_GROUP_SIZE, [this, &movers](u32 start, u32 end)
+		{
+			std::vector<std::pair<u32, u32>>& found = pairBuffers[start / PAIR_GROUP_SIZE];
+			found.clear();
+
+			for (u32 k = start; k < end; k++)
+			{
+				u32 i = movers[k];
+				const Body& a = bodies[i];
+
+				tree.query(a.shape.getAABB(), [this, i, &a, &found](u32 j)
+				{
+					const Body& b = bodies[j];
+					if (j == i || (a.type != BodyType::DYNAMIC && b.type != BodyType::DYNAMIC))
+						return true;
+
+					// Two moving bodies find each other; keep the pair from the lower index
+					if (b.awake && b.type != BodyType::STATIC && j < i)
+						return true;
+
+					found.push_back(i < j ? std::make_pair(i, j) : std::make_pair(j, i));
+					return true;
+				});
+			}
+		});
+
+		// Sorted so everything after this runs in the same order however the work was split
+		pairs.clear();
+		for (auto& found : pairBuffers)
+		{
+			pairs.insert(pairs.end(), found.begin(), found.end());
+		}
+		std::sort(pairs.begin(), pairs.end());
+	}
+
+	void Physics3DSystem::collidePairs()
+	{
+		KU_PROFILE_FUNCTION();
+
+		contacts.resize(pairs.size());
+
+		JobSystem::parallelFor(pairs.size(), PAIR_GROUP_SIZE, [this](u32 start, u32 end)
+		{
+			for (u32 k = start; k < end; k++)
+			{
+				Contact& contact = contacts[k];
+				contact.bodyA = pairs[k].first;
+				contact.bodyB = pairs[k].second;
+				contact.pointCount = 0;
+
+				const Body& a = bodies[contact.bodyA];
+				const Body& b = bodies[contact.bodyB];
+
+				Manifold manifold;
+				if (!collide(a.shape, b.shape, manifold))
+					continue;
+
+				glm::vec3 n = manifold.normal;
+				contact.normal = n;
+				contact.tangents[0] = std::abs(n.x) >= 0.57735f ? glm::normalize(glm::vec3(n.y, -n.x, 0.0f)) : glm::normalize(glm::vec3(0.0f, n.z, -n.y));
+				contact.tangents[1] = glm::cross(n, contact.tangents[0]);
+				contact.friction = std::sqrt(a.friction * b.friction);
+				contact.restitution = std::max(a.restitution, b.restitution);
+
+				auto last = lastContacts.find(pairKey(contact.bodyA, contact.bodyB));
+				const Contact* lastContact = last != lastContacts.end() ? &lastContactList[last->second] : nullptr;
+
+				glm::quat invRotA = glm::conjugate(a.rot);
+				for (u32 i = 0; i < manifold.count; i++)
+				{
+					ContactPointConstraint& point = contact.points[i];
+					point.localA = invRotA * (manifold.points[i].pos - a.pos);
+					point.rA = manifold.points[i].pos - a.pos;
+					point.rB = manifold.points[i].pos - b.pos;
+					point.depth = manifold.points[i].depth;
+					point.normalImpulse = 0.0f;
+					point.tangentImpulse[0] = point.tangentImpulse[1] = 0.0f;
+
+					if (!lastContact)
+						continue;
+
+					for (u32 j = 0; j < lastContact->pointCount; j++)
+					{
+						const ContactPointConstraint& lastPoint = lastContact->points[j];
+						glm::vec3 d = lastPoint.localA - point.localA;
+						if (glm::dot(d, d) < MATCH_DISTANCE * MATCH_DISTANCE)
+						{
+							point.normalImpulse = lastPoint.normalImpulse;
+							point.tangentImpulse[0] = lastPoint.tangentImpulse[0];
+							point.tangentImpulse[1] = lastPoint.tangentImpulse[1];
+							break;
+						}
+					}
+				}
+				contact.pointCount = manifold.count;
+			}
+		});
+
+		contacts.erase(std::remove_if(contacts.begin(), contacts.end(), [](const Contact& contact) { return contact.pointCount == 0; }), contacts.end());
+	}
+
+	void Physics3DSystem::buildIslands()
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Sleeping bodies touched by something awake join in
+		for (const Contact& contact : contacts)
+		{
+			for (u32 index : { contact.bodyA, contact.bodyB })
+			{
+				if (bodies[index].type == BodyType::DYNAMIC && !bodies[index].awake)
+					wake(bodies[index]);
+			}
+		}
+
+		// Union-find over dynamic bodies joined by contacts; static and kinematic bodies don't join islands together
+		islandParents.resize(bodies.size());
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			islandParents[i] = i;
+		}
+
+		auto find = [this](u32 i)
+		{
+			while (islandParents[i] != i)
+			{
+				islandParents[i] = islandParents[islandParents[i]];
+				i = islandParents[i];
+			}
+			return i;
+		};
+
+		for (const Contact& contact : contacts)
+		{
+			if (bodies[contact.bodyA].type != BodyType::DYNAMIC || bodies[contact.bodyB].type != BodyType::DYNAMIC)
+				continue;
+
+			u32 a = find(contact.bodyA);
+			u32 b = find(contact.bodyB);
+			if (a < b)
+				islandParents[b] = a;
+			else if (b < a)
+				islandParents[a] = b;
+		}
+
+		// Number islands in order of their lowest body, then lay out their bodies and contacts contiguously
+		islands.clear();
+		islandIndices.assign(bodies.size(), ~0u);
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			const Body& body = bodies[i];
+			if (!body.alive || !body.awake || body.type != BodyType::DYNAMIC)
+				continue;
+
+			u32 root = find(i);
+			if (islandIndices[root] == ~0u)
+			{
+				islandIndices[root] = islands.size();
+				islands.push_back({ 0, 0, 0, 0 });
+			}
+			islandIndices[i] = islandIndices[root];
+			islands[islandIndices[i]].bodyCount++;
+		}
+
+		auto contactIsland = [this](const Contact& contact)
+		{
+			return islandIndices[bodies[contact.bodyA].type == BodyType::DYNAMIC ? contact.bodyA : contact.bodyB];
+		};
+
+		for (const Contact& contact : contacts)
+		{
+			islands[contactIsland(contact)].contactCount++;
+		}
+
+		u32 bodyOffset = 0, contactOffset = 0;
+		for (auto& island : islands)
+		{
+			island.firstBody = bodyOffset;
+			island.firstContact = contactOffset;
+			bodyOffset += island.bodyCount;
+			contactOffset += island.contactCount;
+			island.bodyCount = 0;
+			island.contactCount = 0;
+		}
+
+		islandBodies.resize(bodyOffset);
+		islandContacts.resize(contactOffset);
+
+		for (u32 i = 0; i < bodies.size(); i++)
+		{
+			if (islandIndices[i] == ~0u)
+				continue;
+
+			Island& island = islands[islandIndices[i]];
+			islandBodies[island.firstBody + island.bodyCount++] = i;
+		}
+
+		for (u32 i = 0; i < contacts.size(); i++)
+		{
+			Island& island = islands[contactIsland(contacts[i])];
+			islandContacts[island.firstContact + island.contactCount++] = i;
+		}
+	}
+
+	void Physics3DSystem::solveIsland(const Island& island, float dt)
+	{
+		auto applyImpulse = [](Body& body, const glm::vec3& r, const glm::vec3& impulse)
+		{
+			// Static and kinematic bodies are shared between islands, so only dynamic ones are written
+			if (body.type != BodyType::DYNAMIC)
+				return;
+
+			body.velocity += impulse * body.invMass;
+			body.angularVelocity += body.invInertia * glm::cross(r, impulse);
+		};
+
+		auto relativeVelocity = [](const Body& a, const Body& b, const ContactPointConstraint& point)
+		{
+			return b.velocity + glm::cross(b.angularVelocity, point.rB) - a.velocity - glm::cross(a.angularVelocity, point.rA);
+		};
+
+		auto effectiveMass = [](const Body& a, const Body& b, const glm::vec3& rA, const glm::vec3& rB, const glm::vec3& dir)
+		{
+			glm::vec3 raXd = glm::cross(rA, dir);
+			glm::vec3 rbXd = glm::cross(rB, dir);
+			float k = a.invMass + b.invMass + glm::dot(raXd, a.invInertia * raXd) + glm::dot(rbXd, b.invInertia * rbXd);
+			return k > 0.0f ? 1.0f / k : 0.0f;
+		};
+
+		// Prepare and warm start with last step's impulses
+		for (u32 c = 0; c < island.contactCount; c++)
+		{
+			Contact& contact = contacts[islandContacts[island.firstContact + c]];
+			Body& a = bodies[contact.bodyA];
+			Body& b = bodies[contact.bodyB];
+
+			for (u32 i = 0; i < contact.pointCount; i++)
+			{
+				ContactPointConstraint& point = contact.points[i];
+				point.normalMass = effectiveMass(a, b, point.rA, point.rB, contact.normal);
+				point.tangentMass[0] = effectiveMass(a, b, point.rA, point.rB, contact.tangents[0]);
+				point.tangentMass[1] = effectiveMass(a, b, point.rA, point.rB, contact.tangents[1]);
+
+				float vn = glm::dot(relativeVelocity(a, b, point), contact.normal);
+				point.velocityBias = vn < -RESTITUTION_THRESHOLD ? -contact.restitution * vn : 0.0f;
+
+				glm::vec3 impulse = contact.normal * point.normalImpulse + contact.tangents[0] * point.tangentImpulse[0] + contact.tangents[1] * point.tangentImpulse[1];
+				applyImpulse(a, point.rA, -impulse);
+				applyImpulse(b, point.rB, impulse);
+			}
+		}
+
+		// Sequential impulses
+		for (u32 iteration = 0; iteration < iterations; iteration++)
+		{
+			for (u32 c = 0; c < island.contactCount; c++)
+			{
+				Contact& contact = contacts[islandContacts[island.firstContact + c]];
+				Body& a = bodies[contact.bodyA];
+				Body& b = bodies[contact.bodyB];
+
+				for (u32 i = 0; i < contact.pointCount; i++)
+				{
+					ContactPointConstraint& point = contact.points[i];
+
+					// Friction, bounded by the normal impulse
+					float maxFriction = contact.friction * point.normalImpulse;
+					for (u32 t = 0; t < 2; t++)
+					{
+						float vt = glm::dot(relativeVelocity(a, b, point), contact.tangents[t]);
+						float impulse = glm::clamp(point.tangentImpulse[t] - point.tangentMass[t] * vt, -maxFriction, maxFriction);
+						float lambda = impulse - point.tangentImpulse[t];
+						point.tangentImpulse[t] = impulse;
+
+						applyImpulse(a, point.rA, -contact.tangents[t] * lambda);
+						applyImpulse(b, point.rB, contact.tangents[t] * lambda);
+					}
+
+					// Non-penetration, pushing apart whatever overlaps beyond the slop
+					float vn = glm::dot(relativeVelocity(a, b, point), contact.normal);
+					float bias = std::max(BAUMGARTE / dt * std::max(point.depth - LINEAR_SLOP, 0.0f), point.velocityBias);
+					float impulse = std::max(point.normalImpulse + point.normalMass * (bias - vn), 0.0f);
+					float lambda = impulse - point.normalImpulse;
+					point.normalImpulse = impulse;
+
+					applyImpulse(a, point.rA, -contact.normal * lambda);
+					applyImpulse(b, point.rB, contact.normal * lambda);
+				}
+			}
+		}
+
+		// Integrate positions and see if the island has come to rest
+		float minSleepTime = std::numeric_limits<float>::max();
+		for (u32 i = 0; i < island.bodyCount; i++)
+		{
+			Body& body = bodies[islandBodies[island.firstBody + i]];
+
+			body.pos += body.velocity * dt;
+			body.rot = glm::normalize(body.rot + glm::quat(0.0f, body.angularVelocity) * body.rot * (0.5f * dt));
+
+			if (glm::dot(body.velocity, body.velocity) > LINEAR_SLEEP_TOLERANCE * LINEAR_SLEEP_TOLERANCE
+				|| glm::dot(body.angularVelocity, body.angularVelocity) > ANGULAR_SLEEP_TOLERANCE * ANGULAR_SLEEP_TOLERANCE)
+				body.sleepTime = 0.0f;
+			else
+				body.sleepTime += dt;
+
+			minSleepTime = std::min(minSleepTime, body.sleepTime);
+		}
+
+		if (minSleepTime >= TIME_TO_SLEEP)
+		{
+			for (u32 i = 0; i < island.bodyCount; i++)
+			{
+				Body& body = bodies[islandBodies[island.firstBody + i]];
+				body.awake = false;
+				body.velocity = glm::vec3(0.0f);
+				body.angularVelocity = glm::vec3(0.0f);
+			}
+		}
+	}
+
+	void Physics3DSystem::writeBack(Body& body)
+	{
+		Transform& transform = ECS->getComponent<Transform>(body.id);
+		transform.setPos(body.pos);
+		transform.setRot(glm::degrees(glm::eulerAngles(body.rot)));
+
+		// Read back rather than kept from above, so the next sync compares like with like
+		body.lastPos = transform.getPos();
+		body.lastRot = transform.getRot();
+
+		if (body.type == BodyType::DYNAMIC)
+		{
+			Rigidbody& rb = ECS->getComponent<Rigidbody>(body.id);
+			rb.velocity = body.velocity;
+			rb.angularVelocity = body.angularVelocity;
+			body.lastVelocity = body.velocity;
+			body.lastAngularVelocity = body.angularVelocity;
+		}
+	}
+}
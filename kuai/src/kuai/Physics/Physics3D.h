@@ -0,0 +1,172 @@
+#pragma once
+
+#include "kuai/Components/System.h"
+
+#include "Collision.h"
+#include "DynamicTree.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+namespace kuai {
+	/** \class Physics3DSystem
+	*	\brief Simulates entities with Rigidbody and Collider components.
+	*
+	*	Bodies are found by a dynamic AABB tree, collided as boxes, spheres and capsules, and grouped into islands of touching
+	*	bodies. Islands are solved in parallel on the job system and put to sleep once every body in them comes to rest.
+	*	Given the same scene and the same build, every step gives the same result regardless of thread count.
+	*/
+	class Physics3DSystem : public System
+	{
+	public:
+		void update(float dt) override {}
+
+		/**
+		* Push component changes into the world, advance it by dt and write moved bodies back to their transforms.
+		*/
+		void step(float dt);
+
+		void insertEntity(EntityID id) override;
+		void removeEntity(EntityID id) override;
+
+		/**
+		* Bulk access to the Rigidbody velocities of count entities, for scripting. Changes are picked up on the next step.
+		* @return False at the first entity without a Rigidbody, having handled the ones before it.
+		*/
+		bool getVelocities(const EntityID* ids, u32 count, glm::vec3* out);
+		bool setVelocities(const EntityID* ids, u32 count, const glm::vec3* values);
+
+		void setGravity(const glm::vec3& gravity) { this->gravity = gravity; }
+		glm::vec3 getGravity() const { return gravity; }
+
+		/**
+		* Number of solver passes over each island per step; more is stiffer and more expensive.
+		*/
+		void setIterations(u32 iterations) { this->iterations = std::max(iterations, 1u); }
+
+		/**
+		* Counts and times (in milliseconds) for the last step.
+		*/
+		struct Stats
+		{
+			u32 bodies = 0;
+			u32 awakeBodies = 0;
+			u32 contacts = 0;
+			u32 islands = 0;
+
+			float broadphase = 0.0f;
+			float narrowphase = 0.0f;
+			float solve = 0.0f;
+		};
+		const Stats& getStats() const { return stats; }
+
+	private:
+		enum class BodyType : u8
+		{
+			STATIC, DYNAMIC, KINEMATIC
+		};
+
+		struct Body
+		{
+			EntityID id = 0;
+			bool alive = false;
+			BodyType type = BodyType::STATIC;
+
+			glm::vec3 pos = glm::vec3(0.0f);
+			glm::quat rot = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			glm::vec3 velocity = glm::vec3(0.0f);
+			glm::vec3 angularVelocity = glm::vec3(0.0f);
+
+			float invMass = 0.0f;
+			glm::vec3 invInertiaLocal = glm::vec3(0.0f); // Diagonal, in the body's frame
+			glm::mat3 invInertia = glm::mat3(0.0f);
+
+			float drag = 0.0f, angularDrag = 0.0f;
+			bool useGravity = false;
+
+			bool hasShape = false;
+			CollisionShape localShape; // Centre and axes relative to the body, sizes scaled
+			CollisionShape shape;
+			float friction = 0.0f, restitution = 0.0f;
+			i32 proxy = DynamicTree::NULL_NODE;
+
+			bool awake = true;
+			float sleepTime = 0.0f;
+
+			// What was last read from or written to the components, to spot edits made through them
+			glm::vec3 lastPos = glm::vec3(0.0f), lastRot = glm::vec3(0.0f), lastScale = glm::vec3(0.0f);
+			glm::vec3 lastVelocity = glm::vec3(0.0f), lastAngularVelocity = glm::vec3(0.0f);
+			float lastMass = 0.0f;
+			u32 colliderVersion = 0;
+		};
+
+		struct ContactPointConstraint
+		{
+			glm::vec3 localA;	// Position on body A, for matching with last step's points
+			glm::vec3 rA, rB;	// From each body's centre to the contact
+			float depth;
+
+			float normalMass, tangentMass[2];
+			float normalImpulse = 0.0f, tangentImpulse[2] = { 0.0f, 0.0f };
+			float velocityBias = 0.0f;
+		};
+
+		struct Contact
+		{
+			u32 bodyA, bodyB;
+
+			glm::vec3 normal;
+			glm::vec3 tangents[2];
+			float friction, restitution;
+
+			ContactPointConstraint points[Manifold::MAX_POINTS];
+			u32 pointCount = 0;
+		};
+
+		struct Island
+		{
+			u32 firstBody, bodyCount;
+			u32 firstContact, contactCount;
+		};
+
+		void createBody(EntityID id);
+		void syncBody(Body& body);
+		void updateShape(Body& body, const glm::vec3& scale);
+		void updateMass(Body& body);
+		void updateProxy(Body& body, const glm::vec3& displacement);
+		void wake(Body& body);
+
+		void findPairs();
+		void collidePairs();
+		void buildIslands();
+		void solveIsland(const Island& island, float dt);
+		void writeBack(Body& body);
+
+		static u64 pairKey(u32 a, u32 b) { return ((u64)a << 32) | b; }
+
+	private:
+		std::vector<Body> bodies;
+		std::vector<u32> freeBodies;
+		std::unordered_map<EntityID, u32> bodyIndices;
+		std::vector<EntityID> pendingBodies;
+
+		DynamicTree tree;
+
+		std::vector<std::pair<u32, u32>> pairs;
+		std::vector<std::vector<std::pair<u32, u32>>> pairBuffers; // One per broadphase job
+		std::vector<Contact> contacts;
+		std::unordered_map<u64, u32> lastContacts; // Pair to index in lastContactList, for warm starting
+		std::vector<Contact> lastContactList;
+
+		std::vector<u32> islandParents;
+		std::vector<u32> islandIndices; // Island of each body, or ~0u if it wasn't simulated
+		std::vector<u32> islandBodies;
+		std::vector<u32> islandContacts;
+		std::vector<Island> islands;
+
+		glm::vec3 gravity = glm::vec3(0.0f, -9.81f, 0.0f);
+		u32 iterations = 8;
+
+		Stats stats;
+	};
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "AABB.h"
+
+namespace kuai {
+	/**
+	* A half line from origin along dir. dir should be normalised so distances along the ray are in world units.
+	*/
+	struct Ray
+	{
+		glm::vec3 origin = glm::vec3(0.0f);
+		glm::vec3 dir = glm::vec3(0.0f, 0.0f, -1.0f);
+
+		Ray() = default;
+		Ray(const glm::vec3& origin, const glm::vec3& dir) : origin(origin), dir(dir) {}
+
+		glm::vec3 at(float dist) const { return origin + dir * dist; }
+	};
+
+	/**
+	* Slab test of a ray against a box, given the reciprocal of the ray's direction. On a hit within maxDist,
+	* dist is where the ray enters the box (zero if it starts inside).
+	*/
+	inline bool intersectRayAABB(const glm::vec3& origin, const glm::vec3& invDir, const AABB& aabb, float maxDist, float& dist)
+	{
+		glm::vec3 t0 = (aabb.min - origin) * invDir;
+		glm::vec3 t1 = (aabb.max - origin) * invDir;
+		glm::vec3 tMin = glm::min(t0, t1);
+		glm::vec3 tMax = glm::max(t0, t1);
+
+		float enter = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+		float exit = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDist));
+
+		dist = enter;
+		return enter <= exit;
+	}
+}
@@ -0,0 +1,281 @@
+#include "kpch.h"
+#include "SpatialIndex.h"
+
+#include "kuai/Components/Entity.h"
+#include "kuai/Components/EntityComponentSystem.h"
+#include "kuai/Core/JobSystem.h"
+
+namespace kuai {
+	// Half size of the box around entities without a mesh, before scaling
+	static const float DEFAULT_EXTENT = 0.5f;
+
+	// When more than this fraction of the proxies move in one update, they're updated in place and the tree refitted
+	// rather than each being reinserted. Refitting is linear in the tree's size but lets its quality drift.
+	static const float REFIT_FRACTION = 0.25f;
+	// Rebuild once refitting has grown the area ratio this far past where the last rebuild left it
+	static const float REBUILD_THRESHOLD = 1.5f;
+
+	// Rays per job in batched raycasts
+	static const u32 RAY_GROUP_SIZE = 64;
+
+	// World space box around a model's meshes (or a point, without one) placed by modelMatrix
+	static AABB boundsAt(const glm::mat4& modelMatrix, Model* model)
+	{
+		float maxScale = std::sqrt(std::max({ glm::dot(modelMatrix[0], modelMatrix[0]), glm::dot(modelMatrix[1], modelMatrix[1]), glm::dot(modelMatrix[2], modelMatrix[2]) }));
+
+		if (!model || model->getMeshes().empty())
+		{
+			glm::vec3 centre = glm::vec3(modelMatrix[3]);
+			glm::vec3 extent = glm::vec3(DEFAULT_EXTENT * maxScale);
+			return AABB(centre - extent, centre + extent);
+		}
+
+		AABB bounds(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()));
+		for (auto& mesh : model->getMeshes())
+		{
+			glm::vec3 centre = glm::vec3(modelMatrix * glm::vec4(mesh->getBoundsCentre(), 1.0f));
+			glm::vec3 extent = glm::vec3(mesh->getBoundsRadius() * maxScale);
+			bounds = AABB::merge(bounds, AABB(centre - extent, centre + extent));
+		}
+		return bounds;
+	}
+
+	void SpatialIndexSystem::insertEntity(EntityID id)
+	{
+		System::insertEntity(id);
+
+		// The proxy is made by the next update, once the entity's components are there to size it
+		if (id >= proxies.size())
+		{
+			proxies.resize(id + 1);
+			visibleStamps.resize(id + 1, 0);
+		}
+	}
+
+	void SpatialIndexSystem::removeEntity(EntityID id)
+	{
+		Proxy& proxy = proxies[id];
+		if (proxy.proxy != DynamicTree::NULL_NODE)
+			tree.destroyProxy(proxy.proxy);
+		proxy = Proxy();
+
+		System::removeEntity(id);
+	}
+
+	void SpatialIndexSystem::update(float dt)
+	{
+		KU_PROFILE_FUNCTION();
+
+		using Clock = std::chrono::steady_clock;
+		auto millisSince = [](Clock::time_point start) { return std::chrono::duration<float, std::milli>(Clock::now() - start).count(); };
+
+		Clock::time_point start = Clock::now();
+		stats = Stats();
+
+		// Find what changed since the last update; transforms count their changes, so unmoved entities cost a compare
+		moved.clear();
+		movedBounds.clear();
+		cameraEntities.clear();
+		for (auto& entity : entities)
+		{
+			EntityID id = entity.getId();
+			Proxy& proxy = proxies[id];
+			Transform& transform = entity.getTransform();
+
+			if (ECS->hasComponent<Cam>(id))
+				cameraEntities.push_back(id);
+
+			Rc<Model> model = ECS->hasComponent<MeshRenderer>(id) ? ECS->getComponent<MeshRenderer>(id).getModel() : nullptr;
+			if (proxy.proxy != DynamicTree::NULL_NODE && proxy.transformVersion == transform.version && proxy.model == model)
+				continue;
+
+			proxy.transformVersion = transform.version;
+			proxy.model = model;
+			proxy.invModelMatrix = glm::inverse(transform.modelMatrix);
+
+			AABB bounds = calcBounds(transform, model.get());
+			if (proxy.proxy == DynamicTree::NULL_NODE)
+			{
+				proxy.bounds = bounds;
+				proxy.proxy = tree.createProxy(bounds, id);
+				continue;
+			}
+
+			moved.push_back(id);
+			movedBounds.push_back(bounds);
+		}
+
+		stats.proxies = tree.getProxyCount();
+		stats.moved = moved.size();
+
+		if (moved.size() > stats.proxies * REFIT_FRACTION)
+		{
+			for (size_t i = 0; i < moved.size(); i++)
+			{
+				Proxy& proxy = proxies[moved[i]];
+				proxy.bounds = movedBounds[i];
+				tree.setProxyAABB(proxy.proxy, proxy.bounds);
+			}
+			tree.refit();
+			stats.refitted = true;
+
+			float areaRatio = tree.getAreaRatio();
+			if (rebuiltAreaRatio == 0.0f || areaRatio > rebuiltAreaRatio * REBUILD_THRESHOLD)
+			{
+				tree.rebuild();
+				areaRatio = tree.getAreaRatio();
+				rebuiltAreaRatio = areaRatio;
+				stats.rebuilt = true;
+			}
+			stats.areaRatio = areaRatio;
+		}
+		else
+		{
+			for (size_t i = 0; i < moved.size(); i++)
+			{
+				Proxy& proxy = proxies[moved[i]];
+				glm::vec3 displacement = movedBounds[i].getCentre() - proxy.bounds.getCentre();
+				proxy.bounds = movedBounds[i];
+				if (tree.moveProxy(proxy.proxy, proxy.bounds, displacement))
+					stats.reinserted++;
+			}
+		}
+
+		stats.height = tree.getHeight();
+		stats.update = millisSince(start);
+
+		start = Clock::now();
+
+		// Entities seen by more than one camera are listed once
+		frame++;
+		visibleEntities.clear();
+		for (EntityID id : cameraEntities)
+		{
+			Cam& cam = ECS->getComponent<Cam>(id);
+			Frustum frustum(cam.getProjectionMatrix() * cam.getViewMatrix());
+
+			tree.traverse([&frustum](const AABB& box) { return frustum.intersectsAABB(box.min, box.max); },
+				[&](u32 entity)
+				{
+					if (visibleStamps[entity] != frame && frustum.intersectsAABB(proxies[entity].bounds.min, proxies[entity].bounds.max))
+					{
+						visibleStamps[entity] = frame;
+						visibleEntities.push_back(entity);
+					}
+					return true;
+				});
+		}
+
+		stats.visible = visibleEntities.size();
+		stats.cull = millisSince(start);
+	}
+
+	AABB SpatialIndexSystem::calcBounds(const Transform& transform, Model* model) const
+	{
+		AABB bounds = boundsAt(transform.modelMatrix, model);
+
+		// Rendering interpolates across the last fixed step, so anything moved in it may be drawn anywhere between its two poses
+		if (transform.movedInStep)
+		{
+			glm::mat4 prevMatrix = glm::translate(glm::mat4(1.0f), transform.prevPos) *
+				glm::toMat4(glm::quat(transform.prevRot)) *
+				glm::scale(glm::mat4(1.0f), transform.prevScale);
+			bounds = AABB::merge(bounds, boundsAt(prevMatrix, model));
+		}
+
+		return bounds;
+	}
+
+	void SpatialIndexSystem::queryAABB(const AABB& aabb, std::vector<EntityID>& out) const
+	{
+		tree.query(aabb, [&](u32 entity)
+		{
+			if (proxies[entity].bounds.overlaps(aabb))
+				out.push_back(entity);
+			return true;
+		});
+	}
+
+	void SpatialIndexSystem::querySphere(const glm::vec3& centre, float radius, std::vector<EntityID>& out) const
+	{
+		float radiusSq = radius * radius;
+		auto overlaps = [&centre, radiusSq](const AABB& box)
+		{
+			glm::vec3 closest = glm::clamp(centre, box.min, box.max);
+			return glm::dot(closest - centre, closest - centre) <= radiusSq;
+		};
+
+		tree.traverse(overlaps, [&](u32 entity)
+		{
+			if (overlaps(proxies[entity].bounds))
+				out.push_back(entity);
+			return true;
+		});
+	}
+
+	void SpatialIndexSystem::queryFrustum(const Frustum& frustum, std::vector<EntityID>& out) const
+	{
+		tree.traverse([&frustum](const AABB& box) { return frustum.intersectsAABB(box.min, box.max); },
+			[&](u32 entity)
+			{
+				if (frustum.intersectsAABB(proxies[entity].bounds.min, proxies[entity].bounds.max))
+					out.push_back(entity);
+				return true;
+			});
+	}
+
+	bool SpatialIndexSystem::raycast(const Ray& ray, float maxDist, RaycastHit& hit) const
+	{
+		glm::vec3 invDir = 1.0f / ray.dir;
+		bool found = false;
+
+		tree.rayCast(ray, maxDist, [&](u32 entity, float maxDist)
+		{
+			const Proxy& proxy = proxies[entity];
+			float dist;
+			if (!proxy.model || !intersectRayAABB(ray.origin, invDir, proxy.bounds, maxDist, dist))
+				return maxDist;
+
+			// Into model space; the direction isn't renormalised, so distances along it stay in world units
+			Ray localRay(glm::vec3(proxy.invModelMatrix * glm::vec4(ray.origin, 1.0f)), glm::vec3(proxy.invModelMatrix * glm::vec4(ray.dir, 0.0f)));
+
+			auto& meshes = proxy.model->getMeshes();
+			for (u32 i = 0; i < meshes.size(); i++)
+			{
+				MeshRayHit meshHit;
+				if (!meshes[i]->raycast(localRay, maxDist, meshHit))
+					continue;
+
+				// Only closer hits matter from here on
+				maxDist = meshHit.distance;
+				hit.entity = entity;
+				hit.distance = meshHit.distance;
+				hit.mesh = i;
+				hit.triangle = meshHit.triangle;
+				hit.barycentrics = meshHit.barycentrics;
+				found = true;
+			}
+			return maxDist;
+		});
+
+		return found;
+	}
+
+	void SpatialIndexSystem::raycast(const std::vector<Ray>& rays, float maxDist, std::vector<std::optional<RaycastHit>>& hits) const
+	{
+		KU_PROFILE_FUNCTION();
+
+		hits.resize(rays.size());
+		JobSystem::parallelFor(rays.size(), RAY_GROUP_SIZE, [&](u32 start, u32 end)
+		{
+			for (u32 i = start; i < end; i++)
+			{
+				RaycastHit hit;
+				if (raycast(rays[i], maxDist, hit))
+					hits[i] = hit;
+				else
+					hits[i].reset();
+			}
+		});
+	}
+}
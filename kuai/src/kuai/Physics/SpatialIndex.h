@@ -0,0 +1,121 @@
+#pragma once
+
+#include "kuai/Components/System.h"
+#include "kuai/Renderer/Frustum.h"
+
+#include "DynamicTree.h"
+#include "Ray.h"
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	// Forward declarations
+	class Model;
+	class Transform;
+
+	/** \class SpatialIndexSystem
+	*	\brief Keeps the bounds of every entity in a dynamic AABB tree for fast scene queries: frustum, ray, sphere and box.
+	*
+	*	Entities with a MeshRenderer are bounded by their meshes, others by a small box around their position.
+	*	The tree is brought up to date once a frame from the transforms that changed; it also works out which entities
+	*	each camera can see, which the render system draws from instead of the whole scene.
+	*	Queries see the scene as of the last update, and may run from several threads at once, but not while update() runs.
+	*/
+	class SpatialIndexSystem : public System
+	{
+	public:
+		void update(float dt) override;
+
+		void insertEntity(EntityID id) override;
+		void removeEntity(EntityID id) override;
+
+		/**
+		* Add every entity whose bounds overlap aabb to out.
+		*/
+		void queryAABB(const AABB& aabb, std::vector<EntityID>& out) const;
+
+		/**
+		* Add every entity whose bounds come within radius of centre to out. Handy for finding the sound sources near a listener.
+		*/
+		void querySphere(const glm::vec3& centre, float radius, std::vector<EntityID>& out) const;
+
+		/**
+		* Add every entity whose bounds are at least partly inside frustum to out.
+		*/
+		void queryFrustum(const Frustum& frustum, std::vector<EntityID>& out) const;
+
+		struct RaycastHit
+		{
+			EntityID entity = 0;
+			float distance = 0.0f;
+			u32 mesh = 0;		// Index of the mesh hit within the entity's model
+			u32 triangle = 0;	// Index of the triangle's first index divided by three, in the mesh's full detail indices
+			glm::vec3 barycentrics = glm::vec3(0.0f); // Weights of the triangle's three vertices at the hit point
+		};
+
+		/**
+		* Find the nearest mesh triangle the ray hits within maxDist; entities without a MeshRenderer are ignored.
+		* Candidates come from the tree, then each mesh's own triangle hierarchy is searched. For picking, pass
+		* Camera::screenPointToRay(Input::getMousePos(), ...); for line of sight, cast towards the target and compare distances.
+		*/
+		bool raycast(const Ray& ray, float maxDist, RaycastHit& hit) const;
+
+		/**
+		* Cast many rays at once, split across the job system. hits[i] is the result of rays[i], empty on a miss.
+		*/
+		void raycast(const std::vector<Ray>& rays, float maxDist, std::vector<std::optional<RaycastHit>>& hits) const;
+
+		/**
+		* Entities inside any camera's frustum as of the last update, each listed once.
+		*/
+		const std::vector<EntityID>& getVisibleEntities() const { return visibleEntities; }
+
+		/**
+		* How the last update kept the tree in shape, for tuning the refit and rebuild thresholds.
+		* Times are in milliseconds.
+		*/
+		struct Stats
+		{
+			u32 proxies = 0;
+			u32 moved = 0;			// Entities whose bounds changed
+			u32 reinserted = 0;		// Proxies that left their fat box and were reinserted (incremental updates only)
+			bool refitted = false;	// Moved proxies were updated in place and the tree refitted, rather than reinserted
+			bool rebuilt = false;
+			u32 height = 0;
+			float areaRatio = 0.0f;	// See DynamicTree::getAreaRatio; only measured when refitting or rebuilding
+			u32 visible = 0;
+
+			float update = 0.0f;
+			float cull = 0.0f;
+		};
+		const Stats& getStats() const { return stats; }
+
+	private:
+		struct Proxy
+		{
+			i32 proxy = DynamicTree::NULL_NODE;
+			u32 transformVersion = 0;
+			Rc<Model> model; // Held so raycasts can't outlive it if the MeshRenderer's model is swapped
+			glm::mat4 invModelMatrix = glm::mat4(1.0f);
+			AABB bounds;
+		};
+
+		AABB calcBounds(const Transform& transform, Model* model) const;
+
+	private:
+		DynamicTree tree;
+		std::vector<Proxy> proxies; // Indexed by entity ID
+
+		std::vector<EntityID> moved;
+		std::vector<AABB> movedBounds;
+
+		float rebuiltAreaRatio = 0.0f; // The tree's area ratio straight after the last rebuild
+
+		std::vector<EntityID> visibleEntities;
+		std::vector<EntityID> cameraEntities;
+		std::vector<u32> visibleStamps; // Frame each entity was last listed as visible, so several cameras don't list it twice
+		u32 frame = 0;
+
+		Stats stats;
+	};
+}
@@ -0,0 +1,181 @@
+#include "kpch.h"
+
+#include "HeadlessWindow.h"
+
+#include "kuai/Events/AppEvent.h"
+
+#include <glad/glad.h>
+#include <EGL/eglext.h>
+
+namespace kuai {
+	HeadlessWindow::HeadlessWindow(const WindowProps& props)
+	{
+		init(props);
+	}
+
+	HeadlessWindow::~HeadlessWindow()
+	{
+		cleanup();
+	}
+
+	void HeadlessWindow::init(const WindowProps& props)
+	{
+		KU_PROFILE_FUNCTION();
+
+		data.width = props.width;
+		data.height = props.height;
+		data.frameCount = props.frameCount;
+		data.frameDumpDir = props.frameDumpDir;
+
+		KU_CORE_INFO("Creating headless window ({0}, {1})", props.width, props.height);
+
+		// Prefer Mesa's surfaceless platform, which needs no display server; llvmpipe then gives a software fallback
+		auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		if (display == EGL_NO_DISPLAY)
+			display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+		EGLint major, minor;
+		EGLBoolean success = eglInitialize(display, &major, &minor);
+		KU_CORE_ASSERT(success, "Failed to initialise EGL");
+		KU_CORE_INFO("EGL {0}.{1} ({2})", major, minor, eglQueryString(display, EGL_VENDOR));
+
+		eglBindAPI(EGL_OPENGL_API);
+
+		const EGLint configAttribs[] = {
+			EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_NONE
+		};
+
+		EGLConfig config;
+		EGLint configCount = 0;
+		eglChooseConfig(display, configAttribs, &config, 1, &configCount);
+		KU_CORE_ASSERT(configCount > 0, "No suitable EGL config");
+
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION, 4,
+			EGL_CONTEXT_MINOR_VERSION, 5,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_NONE
+		};
+
+		context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+		KU_CORE_ASSERT(context != EGL_NO_CONTEXT, "Failed to create EGL context");
+
+		// No surface at all; everything is drawn into the framebuffer below
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+		int status = gladLoadGLLoader((GLADloadproc)eglGetProcAddress); // Initialise Glad
+		KU_CORE_ASSERT(status, "Failed to initialise Glad");
+
+		framebuffer = makeBox<Framebuffer>(data.width, data.height, 1, 1);
+
+		if (!data.frameDumpDir.empty())
+			std::filesystem::create_directories(data.frameDumpDir);
+
+		frameTimes.reserve(data.frameCount);
+	}
+
+	void HeadlessWindow::setSize(uint32_t x, uint32_t y)
+	{
+		data.width = x;
+		data.height = y;
+		framebuffer->resize(x, y);
+
+		if (data.eventCallback)
+		{
+			WindowResizeEvent event(x, y);
+			data.eventCallback(event);
+		}
+	}
+
+	void HeadlessWindow::cleanup()
+	{
+		framebuffer.reset();
+
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+		eglDestroyContext(display, context);
+		eglTerminate(display);
+	}
+
+	void HeadlessWindow::pollEvents()
+	{
+		if (data.frameCount && frame >= data.frameCount && !closed)
+		{
+			closed = true;
+
+			WindowCloseEvent event;
+			data.eventCallback(event);
+		}
+	}
+
+	void HeadlessWindow::swapBuffers()
+	{
+		// Nothing is presented, so wait for the GPU to make frame times comparable with a windowed run
+		glFinish();
+		frameTimes.push_back(frameTimer.getElaspedMillis());
+
+		if (!data.frameDumpDir.empty())
+			dumpFrame();
+
+		if (++frame == data.frameCount)
+			logFrameTimes();
+	}
+
+	void HeadlessWindow::makeContextCurrent(bool current)
+	{
+		eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, current ? context : EGL_NO_CONTEXT);
+	}
+
+	void HeadlessWindow::dumpFrame()
+	{
+		KU_PROFILE_FUNCTION();
+
+		u32 rowSize = data.width * 3;
+		pixels.resize(rowSize * data.height);
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		glGetTextureImage(framebuffer->getColAttachments()[0], 0, GL_RGB, GL_UNSIGNED_BYTE, pixels.size(), pixels.data());
+
+		char name[32];
+		std::snprintf(name, sizeof(name), "frame_%05u.ppm", frame.load());
+		std::filesystem::path path = std::filesystem::path(data.frameDumpDir) / name;
+
+		std::ofstream file(path, std::ios::binary);
+		if (!file)
+		{
+			KU_CORE_ERROR("Failed to write frame to {0}", path.string());
+			return;
+		}
+
+		// GL rows start at the bottom, PPM rows at the top
+		file << "P6\n" << data.width << " " << data.height << "\n255\n";
+		for (u32 y = data.height; y > 0; y--)
+		{
+			file.write((const char*)pixels.data() + (y - 1) * rowSize, rowSize);
+		}
+	}
+
+	void HeadlessWindow::logFrameTimes()
+	{
+		if (frameTimes.empty())
+			return;
+
+		// The first frames include shader compilation and uploads, so leave them out of the averages
+		std::vector<float> times(frameTimes.begin() + std::min<size_t>(frameTimes.size() - 1, 10), frameTimes.end());
+		std::sort(times.begin(), times.end());
+
+		float total = 0.0f;
+		for (float time : times)
+			total += time;
+
+		KU_CORE_INFO("Ran {0} headless frames: mean {1:.3f}ms, median {2:.3f}ms, p99 {3:.3f}ms, max {4:.3f}ms",
+			frameTimes.size(), total / times.size(), times[times.size() / 2], times[(times.size() * 99) / 100], times.back());
+	}
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "kuai/Core/Window.h"
+#include "kuai/Core/Timer.h"
+#include "kuai/Renderer/Framebuffer.h"
+
+#include <EGL/egl.h>
+
+#include <atomic>
+
+// @cond
+namespace kuai {
+	/**
+	* Window with no display. Renders through a surfaceless EGL context into a framebuffer,
+	* which can be dumped to disk each frame for comparison against golden images.
+	*/
+	class HeadlessWindow : public Window
+	{
+	public:
+		HeadlessWindow(const WindowProps& props);
+		virtual ~HeadlessWindow();
+
+		void pollEvents() override;
+		void swapBuffers() override;
+		void makeContextCurrent(bool current) override;
+
+		inline uint32_t getWidth() const override { return data.width; }
+		inline uint32_t getHeight() const override { return data.height; }
+		virtual void setSize(uint32_t, uint32_t) override;
+
+		inline uint32_t getXPos() const override { return 0; }
+		inline uint32_t getYPos() const override { return 0; }
+		virtual void setPos(uint32_t, uint32_t) override {}
+
+		inline void setEventCallback(const EventCallbackFn& callback) override
+		{
+			data.eventCallback = callback;
+		}
+		virtual void setVSync(bool enabled) override {}
+		virtual bool isVSync() const override { return false; }
+
+		virtual void* getNativeWindow() const { return nullptr; }
+		virtual bool isActive() const override { return true; }
+
+		virtual Framebuffer* getFramebuffer() const override { return framebuffer.get(); }
+
+	private:
+		virtual void init(const WindowProps& props);
+		virtual void cleanup();
+
+		void dumpFrame();
+		void logFrameTimes();
+
+		EGLDisplay display = EGL_NO_DISPLAY;
+		EGLContext context = EGL_NO_CONTEXT;
+
+		Box<Framebuffer> framebuffer;
+
+		struct WindowData
+		{
+			uint32_t width, height;
+			uint32_t frameCount;
+			std::string frameDumpDir;
+
+			EventCallbackFn eventCallback;
+		};
+
+		WindowData data;
+
+		std::atomic<u32> frame = 0; // Counted by whichever thread presents, checked on the main thread
+		bool closed = false;
+		Timer frameTimer;
+		std::vector<float> frameTimes;
+		std::vector<u8> pixels;
+	};
+}
+// @endcond
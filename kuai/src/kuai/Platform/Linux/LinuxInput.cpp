@@ -0,0 +1,24 @@
+#include "kpch.h"
+#include "kuai/Core/Input.h"
+
+#include "kuai/Core/App.h"
+#include <GLFW/glfw3.h>
+
+namespace kuai {
+
+	glm::vec2 Input::getWindowOrigin()
+	{
+		auto window = static_cast<GLFWwindow*>(App::get().getActiveWindow()->getNativeWindow());
+		if (!window) // Headless
+			return glm::vec2(0.0f);
+
+		// Wayland keeps global positions from clients, so the position is relative to the window there
+		int windx = 0, windy = 0;
+#ifdef GLFW_PLATFORM_WAYLAND
+		if (glfwGetPlatform() != GLFW_PLATFORM_WAYLAND)
+#endif
+			glfwGetWindowPos(window, &windx, &windy);
+
+		return glm::vec2((float)windx, (float)windy);
+	}
+}
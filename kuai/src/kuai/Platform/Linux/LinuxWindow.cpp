@@ -0,0 +1,246 @@
+#include "kpch.h"
+
+#include "LinuxWindow.h"
+
+#include "kuai/Events/AppEvent.h"
+#include "kuai/Events/MouseEvent.h"
+#include "kuai/Events/KeyEvent.h"
+
+#include "kuai/Core/Input.h"
+
+namespace kuai {
+	static bool glfwInitialised = false;
+
+	static void GLFWErrorCallback(int error, const char* description)
+	{
+		KU_CORE_ERROR("GLFW Error ({0}): {1}", error, description);
+	}
+
+	LinuxWindow::LinuxWindow(const WindowProps& props)
+	{
+		init(props);
+	}
+
+	LinuxWindow::~LinuxWindow()
+	{
+		cleanup();
+	}
+
+	void LinuxWindow::init(const WindowProps& props)
+	{
+		KU_PROFILE_FUNCTION();
+
+		data.title = props.title;
+		data.width = props.width;
+		data.height = props.height;
+		data.screenX = props.screenX;
+		data.screenY = props.screenY;
+
+		KU_CORE_INFO("Creating window {0} ({1}, {2})", props.title, props.width, props.height);
+
+		if (!glfwInitialised)
+		{
+			glfwSetErrorCallback(GLFWErrorCallback);
+
+#ifdef GLFW_PLATFORM
+			// GLFW picks Wayland or X11 from the session; KU_GLFW_PLATFORM=x11 forces XWayland, which profilers and capture tools handle better
+			if (const char* platform = std::getenv("KU_GLFW_PLATFORM"))
+			{
+				std::string name = platform;
+				if (name == "x11")
+					glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
+				else if (name == "wayland")
+					glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_WAYLAND);
+			}
+#endif
+
+			int success = glfwInit();
+
+			KU_CORE_ASSERT(success, "Failed to initialise GLFW");
+			
+			glfwInitialised = true;
+		}
+
+#ifdef GLFW_PLATFORM_WAYLAND
+		wayland = glfwGetPlatform() == GLFW_PLATFORM_WAYLAND;
+#endif
+
+		// Mesa only exposes GL 4.5 through a core profile context, unlike the Windows drivers
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+		window = glfwCreateWindow((int)props.width, (int)props.height, props.title.c_str(), nullptr, nullptr);
+		KU_CORE_ASSERT(window, "Failed to create window");
+		glfwMakeContextCurrent(window);
+
+		if (!wayland)
+			glfwSetWindowPos(window, (int)props.screenX, (int)props.screenY);
+
+		// The framebuffer can be larger than the window on scaled displays, and the renderer works in pixels
+		int fbWidth, fbHeight;
+		glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
+		data.width = fbWidth;
+		data.height = fbHeight;
+
+		int status = gladLoadGLLoader((GLADloadproc)glfwGetProcAddress); // Initialise Glad
+		KU_CORE_ASSERT(status, "Failed to initialise Glad");
+
+		glfwSetWindowUserPointer(window, &data); // We can store anything in this user pointer, set it to reference of WindowData struct
+		setVSync(true);
+
+		// ************************************************************
+		// Set GLFW callbacks		
+		// ************************************************************
+
+		glfwSetFramebufferSizeCallback(window, [](GLFWwindow* window, int width, int height)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			data.width = width;
+			data.height = height;
+
+			WindowResizeEvent event(width, height); 
+			data.eventCallback(event); // Dispatch event
+		});
+
+		glfwSetWindowPosCallback(window, [](GLFWwindow* window, int xPos, int yPos)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			data.screenX = xPos;
+			data.screenY = yPos;
+
+			// WindowResizeEvent event(xPos, yPos); TODO: create a window moved event
+			// data.eventCallback(event); // Dispatch event
+		});
+
+		glfwSetWindowCloseCallback(window, [](GLFWwindow* window)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			WindowCloseEvent event;
+			data.eventCallback(event);
+		});
+
+		glfwSetKeyCallback(window, [](GLFWwindow* window, int key, int scancode, int action, int mods)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+
+			switch (action)
+			{
+				case GLFW_PRESS:
+				{
+					Input::push({ InputEvent::Type::KeyPress, (u16)key });
+					KeyPressEvent event(key, 0);
+					data.eventCallback(event);
+					break;
+				}
+				case GLFW_RELEASE:
+				{
+					Input::push({ InputEvent::Type::KeyRelease, (u16)key });
+					KeyReleaseEvent event(key);
+					data.eventCallback(event);
+					break;
+				}
+				case GLFW_REPEAT:
+				{
+					KeyPressEvent event(key, 1);
+					data.eventCallback(event);
+					break;
+				}
+			}
+		});
+
+		glfwSetMouseButtonCallback(window, [](GLFWwindow* window, int button, int action, int mods)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			
+			switch (action)
+			{
+				case GLFW_PRESS:
+				{
+					Input::push({ InputEvent::Type::MouseBtnPress, (u16)button });
+					MouseBtnPressEvent event(button);
+					data.eventCallback(event);
+					break;
+				}
+				case GLFW_RELEASE:
+				{
+					Input::push({ InputEvent::Type::MouseBtnRelease, (u16)button });
+					MouseBtnReleaseEvent event(button);
+					data.eventCallback(event);
+					break;
+				}
+			}
+		});
+
+		glfwSetScrollCallback(window, [](GLFWwindow* window, double xoff, double yoff)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			Input::push({ InputEvent::Type::MouseScroll, 0, glm::vec2((float)xoff, (float)yoff) });
+			MouseScrollEvent event((float)xoff, (float)yoff);
+			data.eventCallback(event);
+		});
+
+		glfwSetCursorPosCallback(window, [](GLFWwindow* window, double xpos, double ypos)
+		{
+			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			Input::push({ InputEvent::Type::MouseMove, 0, glm::vec2((float)xpos, (float)ypos) });
+			MouseMoveEvent event((float)xpos, (float)ypos);
+			data.eventCallback(event);
+		});
+
+		glfwSetWindowFocusCallback(window, [](GLFWwindow* window, int focus)
+		{
+			(*(WindowData*)glfwGetWindowUserPointer(window)).isActive = focus != 0;
+		});
+
+		//glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	}
+
+	void LinuxWindow::setSize(uint32_t x, uint32_t y) {
+		glfwSetWindowSize(window, x, y);
+	}
+
+	void LinuxWindow::setPos(uint32_t x, uint32_t y) {
+		if (wayland) // The compositor decides where windows go
+			return;
+
+		glfwSetWindowPos(window, x, y);
+	}
+
+	void LinuxWindow::cleanup()
+	{
+		glfwDestroyWindow(window);
+	}
+
+	void LinuxWindow::pollEvents()
+	{
+		glfwPollEvents();
+	}
+
+	void LinuxWindow::swapBuffers()
+	{
+		glfwSwapBuffers(window);
+	}
+
+	void LinuxWindow::makeContextCurrent(bool current)
+	{
+		glfwMakeContextCurrent(current ? window : nullptr);
+	}
+
+	void LinuxWindow::setVSync(bool enabled)
+	{
+		glfwSwapInterval(enabled);
+		data.vSync = enabled;
+	}
+
+	bool LinuxWindow::isVSync() const
+	{
+		return data.vSync;
+	}
+
+	bool LinuxWindow::isActive() const
+	{
+		return data.isActive;
+	}
+
+}
\ No newline at end of file
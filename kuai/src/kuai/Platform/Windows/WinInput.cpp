@@ -6,42 +6,15 @@
 
 namespace kuai {
 
-	bool Input::isKeyPressed(KeyCode keycode)
+	glm::vec2 Input::getWindowOrigin()
 	{
 		auto window = static_cast<GLFWwindow*>(App::get().getActiveWindow()->getNativeWindow());
-		auto state = glfwGetKey(window, keycode);
+		if (!window) // Headless
+			return glm::vec2(0.0f);
 
-		return state == GLFW_PRESS || state == GLFW_REPEAT;
-	}
-
-	bool Input::isMouseBtnPressed(MouseBtnCode keycode)
-	{
-		auto window = static_cast<GLFWwindow*>(App::get().getActiveWindow()->getNativeWindow());
-		auto state = glfwGetMouseButton(window, keycode);
-
-		return state == GLFW_PRESS;
-	}
-
-	glm::vec2 Input::getMousePos()
-	{
-		auto window = static_cast<GLFWwindow*>(App::get().getActiveWindow()->getNativeWindow());
-		double xpos, ypos;
 		int windx, windy;
-		glfwGetCursorPos(window, &xpos, &ypos);
 		glfwGetWindowPos(window, &windx, &windy);
 
-		return glm::vec2((float)(xpos + windx), (float)(ypos + windy));
-	}
-
-	float Input::getMouseX()
-	{
-		return Input::getMousePos().x;
-	}
-
-	float Input::getMouseY()
-	{
-		return Input::getMousePos().y;
+		return glm::vec2((float)windx, (float)windy);
 	}
 }
-
-
@@ -6,6 +6,8 @@
 #include "kuai/Events/MouseEvent.h"
 #include "kuai/Events/KeyEvent.h"
 
+#include "kuai/Core/Input.h"
+
 namespace kuai {
 	static bool glfwInitialised = false;
 
@@ -14,11 +16,6 @@ namespace kuai {
 		KU_CORE_ERROR("GLFW Error ({0}): {1}", error, description);
 	}
 
-	Box<Window> Window::create(const WindowProps& props)
-	{
-		return makeBox<WinWindow>(props);
-	}
-
 	WinWindow::WinWindow(const WindowProps& props)
 	{
 		init(props);
@@ -98,12 +95,14 @@ namespace kuai {
 			{
 				case GLFW_PRESS:
 				{
+					Input::push({ InputEvent::Type::KeyPress, (u16)key });
 					KeyPressEvent event(key, 0);
 					data.eventCallback(event);
 					break;
 				}
 				case GLFW_RELEASE:
 				{
+					Input::push({ InputEvent::Type::KeyRelease, (u16)key });
 					KeyReleaseEvent event(key);
 					data.eventCallback(event);
 					break;
@@ -125,12 +124,14 @@ namespace kuai {
 			{
 				case GLFW_PRESS:
 				{
+					Input::push({ InputEvent::Type::MouseBtnPress, (u16)button });
 					MouseBtnPressEvent event(button);
 					data.eventCallback(event);
 					break;
 				}
 				case GLFW_RELEASE:
 				{
+					Input::push({ InputEvent::Type::MouseBtnRelease, (u16)button });
 					MouseBtnReleaseEvent event(button);
 					data.eventCallback(event);
 					break;
@@ -141,6 +142,7 @@ namespace kuai {
 		glfwSetScrollCallback(window, [](GLFWwindow* window, double xoff, double yoff)
 		{
 			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			Input::push({ InputEvent::Type::MouseScroll, 0, glm::vec2((float)xoff, (float)yoff) });
 			MouseScrollEvent event((float)xoff, (float)yoff);
 			data.eventCallback(event);
 		});
@@ -148,6 +150,7 @@ namespace kuai {
 		glfwSetCursorPosCallback(window, [](GLFWwindow* window, double xpos, double ypos)
 		{
 			WindowData& data = *(WindowData*)glfwGetWindowUserPointer(window);
+			Input::push({ InputEvent::Type::MouseMove, 0, glm::vec2((float)xpos, (float)ypos) });
 			MouseMoveEvent event((float)xpos, (float)ypos);
 			data.eventCallback(event);
 		});
@@ -173,12 +176,21 @@ namespace kuai {
 		glfwDestroyWindow(window);
 	}
 
-	void WinWindow::update()
+	void WinWindow::pollEvents()
 	{
 		glfwPollEvents();
+	}
+
+	void WinWindow::swapBuffers()
+	{
 		glfwSwapBuffers(window);
 	}
 
+	void WinWindow::makeContextCurrent(bool current)
+	{
+		glfwMakeContextCurrent(current ? window : nullptr);
+	}
+
 	void WinWindow::setVSync(bool enabled)
 	{
 		glfwSwapInterval(enabled);
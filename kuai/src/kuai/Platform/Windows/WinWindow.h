@@ -13,7 +13,9 @@ namespace kuai {
 		WinWindow(const WindowProps& props);
 		virtual ~WinWindow();
 
-		void update() override;
+		void pollEvents() override;
+		void swapBuffers() override;
+		void makeContextCurrent(bool current) override;
 
 		inline uint32_t getWidth() const override { return data.width; }
 		inline uint32_t getHeight() const override { return data.height; }
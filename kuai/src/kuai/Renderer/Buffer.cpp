@@ -2,6 +2,8 @@
 
 #include "Buffer.h"
 
+#include "RenderState.h"
+
 #include "glad/glad.h"
 
 namespace kuai {
@@ -19,6 +21,14 @@ namespace kuai {
 			case ShaderDataType::MAT3:
 			case ShaderDataType::MAT4:
 				return GL_FLOAT;
+			case ShaderDataType::HALF2:
+			case ShaderDataType::HALF4:
+				return GL_HALF_FLOAT;
+			case ShaderDataType::SNORM16_2:
+			case ShaderDataType::SNORM16_4:
+				return GL_SHORT;
+			case ShaderDataType::UINT16_4:
+				return GL_UNSIGNED_SHORT;
 		}
 
 		KU_CORE_ASSERT(false, "Unknown shader data type.");
@@ -30,42 +40,40 @@ namespace kuai {
 	VertexBuffer::VertexBuffer(u32 size)
 	{
 		glCreateBuffers(1, &bufId);
-		glBindBuffer(GL_ARRAY_BUFFER, bufId);
-		glBufferData(bufId, size, nullptr, GL_DYNAMIC_DRAW);
+		glNamedBufferData(bufId, size, nullptr, GL_DYNAMIC_DRAW);
 	}
 
 	VertexBuffer::VertexBuffer(const float* vertices, u32 size, DrawHint drawHint)
 	{
 		glCreateBuffers(1, &bufId);
-		glBindBuffer(GL_ARRAY_BUFFER, bufId);
-		glBufferData(GL_ARRAY_BUFFER, size, vertices, drawHint == DrawHint::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+		glNamedBufferData(bufId, size, vertices, drawHint == DrawHint::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
 	}
 
 	VertexBuffer::~VertexBuffer()
 	{
+		RenderState::onDeleteBuffer(bufId);
 		glDeleteBuffers(1, &bufId);
 	}
 
 	void VertexBuffer::bind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, bufId);
+		RenderState::bindBuffer(GL_ARRAY_BUFFER, bufId);
 	}
 
 	void VertexBuffer::unbind() const
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		RenderState::bindBuffer(GL_ARRAY_BUFFER, 0);
 	}
 
+	// Uploads go through the buffer's name (DSA), so they don't need to disturb any bindings
 	void VertexBuffer::setData(const void* data, u32 size)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, bufId);
-		glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+		glNamedBufferSubData(bufId, 0, size, data);
 	}
 
 	void VertexBuffer::reset(const void* data, u32 size, DrawHint drawHint)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, bufId);
-		glBufferData(GL_ARRAY_BUFFER, size, data, drawHint == DrawHint::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+		glNamedBufferData(bufId, size, data, drawHint == DrawHint::STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
 	}
 
 	// Index Buffer ***********************************************************
@@ -73,23 +81,23 @@ namespace kuai {
 	IndexBuffer::IndexBuffer(const u32* indices, u32 count) : count(count)
 	{
 		glCreateBuffers(1, &bufId);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufId);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(u32) * count, indices, GL_STATIC_DRAW);
+		glNamedBufferData(bufId, sizeof(u32) * count, indices, GL_STATIC_DRAW); // Binding here would attach it to whichever vertex array is bound
 	}
 
 	IndexBuffer::~IndexBuffer()
 	{
+		RenderState::onDeleteBuffer(bufId);
 		glDeleteBuffers(1, &bufId);
 	}
 
 	void IndexBuffer::bind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufId);
+		RenderState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, bufId);
 	}
 
 	void IndexBuffer::unbind() const
 	{
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+		RenderState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 	// Indirect Buffer ********************************************************
@@ -98,23 +106,73 @@ namespace kuai {
 	{
 		glCreateBuffers(1, &bufId);
 		count = commands.size();
-		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bufId);
-		glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(IndirectCommand) * count, commands.data(), GL_STATIC_DRAW);
+		capacity = count;
+		glNamedBufferData(bufId, sizeof(IndirectCommand) * count, commands.data(), GL_STATIC_DRAW);
 	}
 
 	IndirectBuffer::~IndirectBuffer()
 	{
+		RenderState::onDeleteBuffer(bufId);
 		glDeleteBuffers(1, &bufId);
 	}
 
 	void IndirectBuffer::bind() const
 	{
-		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, bufId);
+		RenderState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, bufId);
 	}
 
 	void IndirectBuffer::unbind() const
 	{
-		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		RenderState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
+
+	void IndirectBuffer::setData(const std::vector<IndirectCommand>& commands)
+	{
+		setData(commands.data(), commands.size());
+	}
+
+	void IndirectBuffer::setData(const IndirectCommand* commands, u32 count)
+	{
+		this->count = count;
+		if (count > capacity)
+		{
+			capacity = std::max(count, capacity * 2);
+			glNamedBufferData(bufId, sizeof(IndirectCommand) * capacity, nullptr, GL_DYNAMIC_DRAW);
+		}
+		glNamedBufferSubData(bufId, 0, sizeof(IndirectCommand) * count, commands);
+	}
+
+	// Storage Buffer *********************************************************
+
+	StorageBuffer::StorageBuffer(u32 binding, u32 size) : binding(binding), capacity(std::max(size, 16u))
+	{
+		glCreateBuffers(1, &bufId);
+		glNamedBufferData(bufId, capacity, nullptr, GL_DYNAMIC_DRAW);
+		bind();
+	}
+
+	StorageBuffer::~StorageBuffer()
+	{
+		RenderState::onDeleteBuffer(bufId);
+		glDeleteBuffers(1, &bufId);
+	}
+
+	void StorageBuffer::bind() const
+	{
+		RenderState::bindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, bufId);
+	}
+
+	void StorageBuffer::setData(const void* data, u32 size)
+	{
+		if (size > capacity)
+		{
+			// Grow geometrically so buffers that grow every frame are not reallocated every frame
+			capacity = std::max(size, capacity * 2);
+			glNamedBufferData(bufId, capacity, nullptr, GL_DYNAMIC_DRAW);
+		}
+
+		if (size)
+			glNamedBufferSubData(bufId, 0, size, data);
 	}
 
 	// Vertex Array ***********************************************************
@@ -126,17 +184,18 @@ namespace kuai {
 
 	VertexArray::~VertexArray()
 	{
+		RenderState::onDeleteVertexArray(vaoId);
 		glDeleteVertexArrays(1, &vaoId);
 	}
 
 	void VertexArray::bind() const
 	{
-		glBindVertexArray(vaoId);
+		RenderState::bindVertexArray(vaoId);
 	}
 
 	void VertexArray::unbind() const
 	{
-		glBindVertexArray(0);
+		RenderState::bindVertexArray(0);
 	}
 
 	const std::vector<Rc<VertexBuffer>>& VertexArray::getVertexBuffers() const
@@ -148,7 +207,7 @@ namespace kuai {
 	{
 		KU_CORE_ASSERT(buf->getLayout().getElements().size(), "Vertex buffer has no layout.");
 
-		glBindVertexArray(vaoId);
+		RenderState::bindVertexArray(vaoId);
 		buf->bind();
 
 		auto& layout = buf->getLayout();
@@ -187,6 +246,37 @@ namespace kuai {
 					index++;
 					break;
 				}
+				case ShaderDataType::HALF2:
+				case ShaderDataType::HALF4:
+				case ShaderDataType::SNORM16_2:
+				case ShaderDataType::SNORM16_4:
+				{
+					// Shader sees these as floats; snorm values are normalised to [-1, 1]
+					glEnableVertexAttribArray(index);
+					glVertexAttribPointer(
+						index,
+						element.getComponentCount(),
+						getOpenGLType(element.type),
+						element.isNormalized() ? GL_TRUE : GL_FALSE,
+						layout.getStride(),
+						(const void*)element.offset
+					);
+					index++;
+					break;
+				}
+				case ShaderDataType::UINT16_4:
+				{
+					// Integers the shader reads as they are, advancing per vertex
+					glEnableVertexAttribArray(index);
+					glVertexAttribIPointer(
+						index,
+						element.getComponentCount(),
+						getOpenGLType(element.type),
+						layout.getStride(),
+						(const void*)element.offset);
+					index++;
+					break;
+				}
 				case ShaderDataType::MAT3:
 				case ShaderDataType::MAT4:
 				{
@@ -220,7 +310,7 @@ namespace kuai {
 
 	void VertexArray::setIndexBuffer(Rc<IndexBuffer> buf)
 	{
-		glBindVertexArray(vaoId);
+		RenderState::bindVertexArray(vaoId);
 		buf->bind();
 
 		indexBuf = buf;
@@ -4,7 +4,9 @@ namespace kuai {
 
     enum class ShaderDataType 
     {
-        NONE = 0, INT, FLOAT, VEC2, VEC3, VEC4, MAT3, MAT4
+        NONE = 0, INT, FLOAT, VEC2, VEC3, VEC4, MAT3, MAT4,
+        HALF2, HALF4, SNORM16_2, SNORM16_4, // Compact formats, converted to floats when fetched
+        UINT16_4 // Per vertex unsigned integers, such as joint indices
     };
 
     enum class DrawHint
@@ -23,6 +25,11 @@ namespace kuai {
             case ShaderDataType::VEC4:  return 16;
             case ShaderDataType::MAT3:  return 36;
             case ShaderDataType::MAT4:  return 64;
+            case ShaderDataType::HALF2:     return 4;
+            case ShaderDataType::HALF4:     return 8;
+            case ShaderDataType::SNORM16_2: return 4;
+            case ShaderDataType::SNORM16_4: return 8;
+            case ShaderDataType::UINT16_4:  return 8;
         }
 
         KU_CORE_ASSERT(false, "Unknown shader data type.");
@@ -52,10 +59,20 @@ namespace kuai {
                 case ShaderDataType::VEC4:  return 4;
                 case ShaderDataType::MAT3:  return 3; // (3 * Vec3)
                 case ShaderDataType::MAT4:  return 4; // (4 * Vec4)
+                case ShaderDataType::HALF2:     return 2;
+                case ShaderDataType::HALF4:     return 4;
+                case ShaderDataType::SNORM16_2: return 2;
+                case ShaderDataType::SNORM16_4: return 4;
+                case ShaderDataType::UINT16_4:  return 4;
             }
 
             return 0;
         }
+
+        bool isNormalized() const
+        {
+            return type == ShaderDataType::SNORM16_2 || type == ShaderDataType::SNORM16_4;
+        }
     };
 
     class BufferLayout
@@ -150,11 +167,39 @@ namespace kuai {
         void bind() const;
         void unbind() const;
 
+        /**
+        * Replace the commands, reusing the existing storage when they fit.
+        */
+        void setData(const std::vector<IndirectCommand>& commands);
+        void setData(const IndirectCommand* commands, u32 count);
+
         u32 getCount() const { return count; }
 
     private:
         u32 bufId;
         u32 count;
+        u32 capacity;
+    };
+
+    /**
+    * Shader storage buffer (SSBO) bound to a fixed binding point. Grows to fit whatever data is written to it.
+    */
+    class StorageBuffer
+    {
+    public:
+        StorageBuffer(u32 binding, u32 size = 16);
+        ~StorageBuffer();
+
+        void bind() const;
+
+        void setData(const void* data, u32 size);
+
+        u32 getCapacity() const { return capacity; }
+
+    private:
+        u32 bufId;
+        u32 binding;
+        u32 capacity;
     };
 
     class VertexArray
@@ -4,6 +4,8 @@
 
 #include "Framebuffer.h"
 
+#include "kuai/Physics/Ray.h"
+
 #include "glm/glm.hpp"
 #include "glm/gtx/quaternion.hpp"
 
@@ -32,6 +34,9 @@ namespace kuai {
 		inline glm::mat4& getViewMatrix()  { return viewMatrix; }
 		inline glm::mat4& getProjectionMatrix() { return projMatrix; }
 
+		float getNear() const { return projectionType == ProjectionType::Perspective ? zNear : orthoNear; }
+		float getFar() const { return projectionType == ProjectionType::Perspective ? zFar : orthoFar; }
+
 		void setPerspective(float fov, float aspect, float zNear, float zFar)
 		{
 			projectionType = ProjectionType::Perspective;
@@ -58,7 +63,23 @@ namespace kuai {
 		    viewMatrix = glm::inverse(viewMatrix); // Calculate inverse to get correct operation, aka (TR)^-1 = R^-1T^-1
         }
 
-		void setTarget(Framebuffer& target) { this->target = makeBox<Framebuffer>(target); }
+		/**
+		* Ray from the camera through a point on a screen of the given size, in pixels from the top left.
+		* Pass Input::getMousePos() and the window size to pick what's under the cursor.
+		*/
+		Ray screenPointToRay(const glm::vec2& screenPos, float screenWidth, float screenHeight) const
+		{
+			glm::vec2 ndc(2.0f * screenPos.x / screenWidth - 1.0f, 1.0f - 2.0f * screenPos.y / screenHeight);
+			glm::mat4 invViewProj = glm::inverse(projMatrix * viewMatrix);
+
+			glm::vec4 nearPoint = invViewProj * glm::vec4(ndc, -1.0f, 1.0f);
+			glm::vec4 farPoint = invViewProj * glm::vec4(ndc, 1.0f, 1.0f);
+			glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+
+			return Ray(origin, glm::normalize(glm::vec3(farPoint) / farPoint.w - origin));
+		}
+
+		void setTarget(Framebuffer& target) { this->target = makeRc<Framebuffer>(target); }
 		Framebuffer* getTarget() { return target.get(); }
 
 	private:
@@ -94,7 +115,7 @@ namespace kuai {
 		glm::mat4 projMatrix;
 		glm::mat4 viewProjMatrix;
 
-		// Framebuffer this camera will render to; none is default framebuffer
-		Box<Framebuffer> target = nullptr;
+		// Framebuffer this camera will render to; none is default framebuffer. Shared so copies of the camera can be handed to the render thread.
+		Rc<Framebuffer> target = nullptr;
     };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "kpch.h"
 #include "Cubemap.h"
+#include "RenderState.h"
 
 #include "stb_image.h"
 #include "glad/glad.h"
@@ -10,7 +11,7 @@ namespace kuai {
 	Cubemap::Cubemap(const std::vector<std::string>& faces)
 	{
 		glGenTextures(1, &textureId);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+		RenderState::bindTexture(0, GL_TEXTURE_CUBE_MAP, textureId);
 
 		// Load file using stbi library
 		int width, height, colourChannels;
@@ -56,6 +57,7 @@ namespace kuai {
 
 	Cubemap::~Cubemap()
 	{
+		RenderState::onDeleteTexture(textureId);
 		glDeleteTextures(1, &textureId);
 	}
 
@@ -66,7 +68,6 @@ namespace kuai {
 	
 	void Cubemap::bind(u32 activeTex)
 	{
-		glActiveTexture(GL_TEXTURE0 + activeTex);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, textureId);
+		RenderState::bindTexture(activeTex, GL_TEXTURE_CUBE_MAP, textureId);
 	}
 }
\ No newline at end of file
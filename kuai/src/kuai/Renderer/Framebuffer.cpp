@@ -1,6 +1,8 @@
 #include "kpch.h"
 #include "Framebuffer.h"
 
+#include "RenderState.h"
+
 #include "glad/glad.h"
 
 namespace kuai {
@@ -16,9 +18,7 @@ namespace kuai {
 
 	Framebuffer::~Framebuffer()
 	{
-		glDeleteFramebuffers(1, &frameBufId);
-		glDeleteTextures(colAttachments.size(), colAttachments.data());
-		glDeleteTextures(1, &depthAttachment);
+		release();
 	}
 
 	const uint32_t Framebuffer::getDepthAttachment()
@@ -33,14 +33,14 @@ namespace kuai {
 
 	void Framebuffer::bind()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, frameBufId);
-		glBindTexture(getTextureTarget(props.samples > 1), depthAttachment);
-		glViewport(0, 0, props.width, props.height);
+		RenderState::bindFramebuffer(frameBufId);
+		RenderState::bindTexture(0, getTextureTarget(props.samples > 1), depthAttachment);
+		RenderState::setViewport(0, 0, props.width, props.height);
 	}
 
 	void Framebuffer::unbind()
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		RenderState::bindFramebuffer(0);
 	}
 
 	void Framebuffer::resize(uint32_t width, uint32_t height)
@@ -61,9 +61,7 @@ namespace kuai {
 	{
 		if (frameBufId)
 		{
-			glDeleteFramebuffers(1, &frameBufId);
-			glDeleteTextures(colAttachments.size(), colAttachments.data());
-			glDeleteTextures(1, &depthAttachment);
+			release();
 
 			colAttachments.clear();
 			depthAttachment = 0;
@@ -71,7 +69,7 @@ namespace kuai {
 
 		// Create framebuffer
 		glGenFramebuffers(1, &frameBufId);
-		glBindFramebuffer(GL_FRAMEBUFFER, frameBufId);
+		RenderState::bindFramebuffer(frameBufId);
 
 		bool multisampling = props.samples > 1;
 
@@ -83,7 +81,7 @@ namespace kuai {
 
 			for (size_t i = 0; i < colAttachments.size(); i++)
 			{
-				glBindTexture(getTextureTarget(multisampling), colAttachments[i]);
+				RenderState::bindTexture(0, getTextureTarget(multisampling), colAttachments[i]);
 
 				attachColTexture(i);
 			}
@@ -97,12 +95,25 @@ namespace kuai {
 
 		// Add depth attachment
 		glGenTextures(1, &depthAttachment);
-		glBindTexture(getTextureTarget(multisampling), depthAttachment);
+		RenderState::bindTexture(0, getTextureTarget(multisampling), depthAttachment);
 		attachDepthTexture();
 
 		KU_CORE_ASSERT(glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE, "Framebuffer is incomplete");
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		RenderState::bindFramebuffer(0);
+	}
+
+	void Framebuffer::release()
+	{
+		RenderState::onDeleteFramebuffer(frameBufId);
+		glDeleteFramebuffers(1, &frameBufId);
+
+		for (u32 texture : colAttachments)
+			RenderState::onDeleteTexture(texture);
+		glDeleteTextures(colAttachments.size(), colAttachments.data());
+
+		RenderState::onDeleteTexture(depthAttachment);
+		glDeleteTextures(1, &depthAttachment);
 	}
 
 	void Framebuffer::attachColTexture(uint32_t index)
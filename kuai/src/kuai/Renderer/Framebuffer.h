@@ -27,8 +27,12 @@ namespace kuai {
 
         void resize(uint32_t width, uint32_t height);
 
+        uint32_t getWidth() const { return props.width; }
+        uint32_t getHeight() const { return props.height; }
+
     private:
         void reset();
+        void release();
 
         void attachColTexture(uint32_t index);
         void attachDepthTexture();
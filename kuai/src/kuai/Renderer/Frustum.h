@@ -0,0 +1,57 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	/**
+	* The six planes bounding a camera's view volume, extracted from a view-projection matrix.
+	*/
+	struct Frustum
+	{
+		glm::vec4 planes[6]; // xyz = inward facing normal, w = distance
+
+		Frustum(const glm::mat4& viewProjMatrix)
+		{
+			// glm matrices are column major, so rows are read across the columns
+			glm::vec4 rows[4];
+			for (int i = 0; i < 4; i++)
+			{
+				rows[i] = glm::vec4(viewProjMatrix[0][i], viewProjMatrix[1][i], viewProjMatrix[2][i], viewProjMatrix[3][i]);
+			}
+
+			planes[0] = rows[3] + rows[0]; // Left
+			planes[1] = rows[3] - rows[0]; // Right
+			planes[2] = rows[3] + rows[1]; // Bottom
+			planes[3] = rows[3] - rows[1]; // Top
+			planes[4] = rows[3] + rows[2]; // Near
+			planes[5] = rows[3] - rows[2]; // Far
+
+			for (auto& plane : planes)
+			{
+				plane /= glm::length(glm::vec3(plane));
+			}
+		}
+
+		bool intersectsSphere(const glm::vec3& centre, float radius) const
+		{
+			for (auto& plane : planes)
+			{
+				if (glm::dot(glm::vec3(plane), centre) + plane.w < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		bool intersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+		{
+			for (auto& plane : planes)
+			{
+				// The corner furthest along the plane's normal is the last to leave it
+				glm::vec3 corner(plane.x > 0.0f ? max.x : min.x, plane.y > 0.0f ? max.y : min.y, plane.z > 0.0f ? max.z : min.z);
+				if (glm::dot(glm::vec3(plane), corner) + plane.w < 0.0f)
+					return false;
+			}
+			return true;
+		}
+	};
+}
@@ -0,0 +1,248 @@
+#include "kpch.h"
+#include "LightClusters.h"
+
+#include "Camera.h"
+#include "Shader.h"
+
+#include "kuai/Core/JobSystem.h"
+
+#ifdef KU_SIMD_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace kuai {
+	LightClusters::LightClusters()
+	{
+		slices.resize(CLUSTER_Z);
+		grid.resize(CLUSTER_COUNT, { 0, 0 });
+
+		// Binding points must match the storage blocks declared in the base shader
+		lightBuf = makeBox<StorageBuffer>(1);
+		gridBuf = makeBox<StorageBuffer>(2, CLUSTER_COUNT * sizeof(ClusterRange));
+		indexBuf = makeBox<StorageBuffer>(3);
+
+		gridBuf->setData(grid.data(), CLUSTER_COUNT * sizeof(ClusterRange));
+	}
+
+	void LightClusters::setLights(const std::vector<GpuLight>& lights, u32 dirLightCount)
+	{
+		KU_PROFILE_FUNCTION();
+
+		this->lights = lights;
+		this->dirLightCount = dirLightCount;
+		lightsChanged = true;
+	}
+
+	void LightClusters::build(Camera& camera, u32 width, u32 height)
+	{
+		KU_PROFILE_FUNCTION();
+
+		float zNear = std::max(camera.getNear(), 0.01f);
+		float zFar = std::max(camera.getFar(), zNear + 0.01f);
+
+		// Lights are uploaded here rather than in setLights, so setLights can be called from any thread
+		if (lightsChanged)
+		{
+			lightBuf->setData(lights.data(), lights.size() * sizeof(GpuLight));
+			lightsChanged = false;
+		}
+
+		if (camera.getProjectionMatrix() != boundsProjMatrix)
+		{
+			calcClusterBounds(camera.getProjectionMatrix(), zNear, zFar);
+		}
+
+		// Transform light bounding spheres into view space
+		const glm::mat4& viewMatrix = camera.getViewMatrix();
+		viewLights.clear();
+		for (size_t i = dirLightCount; i < lights.size(); i++)
+		{
+			glm::vec4 pos = viewMatrix * glm::vec4(glm::vec3(lights[i].posRange), 1.0f);
+			viewLights.push_back(glm::vec4(glm::vec3(pos), lights[i].posRange.w));
+		}
+
+		// Each depth slice is independent, so cull them in parallel
+		JobSystem::parallelFor(CLUSTER_Z, 1, [this](u32 start, u32 end)
+		{
+			for (u32 z = start; z < end; z++)
+				cullSlice(z);
+		});
+
+		// Stitch the per-slice index lists together into one list
+		lightIndices.clear();
+		for (u32 z = 0; z < CLUSTER_Z; z++)
+		{
+			u32 base = lightIndices.size();
+			for (u32 i = z * CLUSTER_X * CLUSTER_Y; i < (z + 1) * CLUSTER_X * CLUSTER_Y; i++)
+			{
+				grid[i].offset += base;
+			}
+			lightIndices.insert(lightIndices.end(), slices[z].indices.begin(), slices[z].indices.end());
+		}
+
+		gridBuf->setData(grid.data(), CLUSTER_COUNT * sizeof(ClusterRange));
+		indexBuf->setData(lightIndices.data(), lightIndices.size() * sizeof(u32));
+
+		// Depth slices are exponential: slice = log(depth) * scale + bias
+		float logRatio = std::log(zFar / zNear);
+		u32 dims[4] = { CLUSTER_X, CLUSTER_Y, CLUSTER_Z, dirLightCount };
+		float depth[4] = { CLUSTER_Z / logRatio, -(float)CLUSTER_Z * std::log(zNear) / logRatio, zNear, zFar };
+		float scale[2] = { (float)CLUSTER_X / std::max(width, 1u), (float)CLUSTER_Y / std::max(height, 1u) };
+
+		Shader::base->setUniform("ClusterData", "clusterDims", dims, sizeof(dims));
+		Shader::base->setUniform("ClusterData", "clusterDepth", depth, sizeof(depth));
+		Shader::base->setUniform("ClusterData", "clusterScale", scale, sizeof(scale));
+	}
+
+	void LightClusters::calcClusterBounds(const glm::mat4& projMatrix, float zNear, float zFar)
+	{
+		boundsProjMatrix = projMatrix;
+		glm::mat4 invProj = glm::inverse(projMatrix);
+
+		sliceDepths.resize(CLUSTER_Z + 1);
+		for (u32 z = 0; z <= CLUSTER_Z; z++)
+		{
+			sliceDepths[z] = zNear * std::pow(zFar / zNear, (float)z / CLUSTER_Z);
+		}
+
+		auto unproject = [&invProj](float x, float y, float z)
+		{
+			glm::vec4 p = invProj * glm::vec4(x, y, z, 1.0f);
+			return glm::vec3(p) / p.w;
+		};
+
+		bounds.resize(CLUSTER_COUNT);
+		for (u32 y = 0; y < CLUSTER_Y; y++)
+		{
+			for (u32 x = 0; x < CLUSTER_X; x++)
+			{
+				// Rays through the four corners of this tile, from the near plane to the far plane
+				float ndcX[2] = { -1.0f + 2.0f * x / CLUSTER_X, -1.0f + 2.0f * (x + 1) / CLUSTER_X };
+				float ndcY[2] = { -1.0f + 2.0f * y / CLUSTER_Y, -1.0f + 2.0f * (y + 1) / CLUSTER_Y };
+
+				glm::vec3 nearPts[4], farPts[4];
+				for (u32 i = 0; i < 4; i++)
+				{
+					nearPts[i] = unproject(ndcX[i & 1], ndcY[i >> 1], -1.0f);
+					farPts[i] = unproject(ndcX[i & 1], ndcY[i >> 1], 1.0f);
+				}
+
+				for (u32 z = 0; z < CLUSTER_Z; z++)
+				{
+					ClusterBounds& b = bounds[x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y];
+					b.min = glm::vec3(std::numeric_limits<float>::max());
+					b.max = glm::vec3(std::numeric_limits<float>::lowest());
+
+					// Intersect each corner ray with the slice's near and far depth planes (view space looks down -z)
+					for (u32 i = 0; i < 4; i++)
+					{
+						for (u32 d = 0; d < 2; d++)
+						{
+							float depth = -sliceDepths[z + d];
+							float t = (depth - nearPts[i].z) / (farPts[i].z - nearPts[i].z);
+							glm::vec3 p = nearPts[i] + (farPts[i] - nearPts[i]) * t;
+
+							b.min = glm::min(b.min, p);
+							b.max = glm::max(b.max, p);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	void LightClusters::cullSlice(u32 z)
+	{
+		Slice& slice = slices[z];
+		slice.x.clear();
+		slice.y.clear();
+		slice.z.clear();
+		slice.radiusSq.clear();
+		slice.lightIds.clear();
+		slice.indices.clear();
+
+		// Only lights that overlap this slice's depth range are candidates
+		float sliceNear = sliceDepths[z];
+		float sliceFar = sliceDepths[z + 1];
+		for (u32 i = 0; i < viewLights.size(); i++)
+		{
+			const glm::vec4& l = viewLights[i];
+			if (-l.z + l.w > sliceNear && -l.z - l.w < sliceFar)
+			{
+				slice.x.push_back(l.x);
+				slice.y.push_back(l.y);
+				slice.z.push_back(l.z);
+				slice.radiusSq.push_back(l.w * l.w);
+				slice.lightIds.push_back(dirLightCount + i);
+			}
+		}
+
+		// Pad to a multiple of four with spheres that can never intersect anything
+		while (slice.x.size() % 4)
+		{
+			slice.x.push_back(0.0f);
+			slice.y.push_back(0.0f);
+			slice.z.push_back(0.0f);
+			slice.radiusSq.push_back(-1.0f);
+			slice.lightIds.push_back(0);
+		}
+
+		u32 candidates = slice.x.size();
+
+		for (u32 y = 0; y < CLUSTER_Y; y++)
+		{
+			for (u32 x = 0; x < CLUSTER_X; x++)
+			{
+				u32 clusterIndex = x + y * CLUSTER_X + z * CLUSTER_X * CLUSTER_Y;
+				const ClusterBounds& b = bounds[clusterIndex];
+
+				u32 offset = slice.indices.size();
+				u32 count = 0;
+
+#ifdef KU_SIMD_SSE
+				const __m128 zero = _mm_setzero_ps();
+				const __m128 minX = _mm_set1_ps(b.min.x), minY = _mm_set1_ps(b.min.y), minZ = _mm_set1_ps(b.min.z);
+				const __m128 maxX = _mm_set1_ps(b.max.x), maxY = _mm_set1_ps(b.max.y), maxZ = _mm_set1_ps(b.max.z);
+
+				for (u32 i = 0; i < candidates && count < MAX_LIGHTS_PER_CLUSTER; i += 4)
+				{
+					// Distance from sphere centre to box along each axis (zero when inside the box's extent)
+					__m128 px = _mm_loadu_ps(&slice.x[i]);
+					__m128 py = _mm_loadu_ps(&slice.y[i]);
+					__m128 pz = _mm_loadu_ps(&slice.z[i]);
+
+					__m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, px), _mm_sub_ps(px, maxX)), zero);
+					__m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, py), _mm_sub_ps(py, maxY)), zero);
+					__m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, pz), _mm_sub_ps(pz, maxZ)), zero);
+
+					__m128 distSq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+					int mask = _mm_movemask_ps(_mm_cmple_ps(distSq, _mm_loadu_ps(&slice.radiusSq[i])));
+
+					for (u32 j = 0; j < 4 && mask; j++)
+					{
+						if ((mask & BIT(j)) && count < MAX_LIGHTS_PER_CLUSTER)
+						{
+							slice.indices.push_back(slice.lightIds[i + j]);
+							count++;
+						}
+					}
+				}
+#else
+				for (u32 i = 0; i < candidates && count < MAX_LIGHTS_PER_CLUSTER; i++)
+				{
+					float dx = std::max(std::max(b.min.x - slice.x[i], slice.x[i] - b.max.x), 0.0f);
+					float dy = std::max(std::max(b.min.y - slice.y[i], slice.y[i] - b.max.y), 0.0f);
+					float dz = std::max(std::max(b.min.z - slice.z[i], slice.z[i] - b.max.z), 0.0f);
+
+					if (dx * dx + dy * dy + dz * dz <= slice.radiusSq[i])
+					{
+						slice.indices.push_back(slice.lightIds[i]);
+						count++;
+					}
+				}
+#endif
+				grid[clusterIndex] = { offset, count }; // Offset is relative to this slice until stitched
+			}
+		}
+	}
+}
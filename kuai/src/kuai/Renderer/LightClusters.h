@@ -0,0 +1,97 @@
+#pragma once
+
+#include "Buffer.h"
+
+#include "glm/glm.hpp"
+
+// @cond
+namespace kuai {
+	// Forward declaration
+	class Camera;
+
+	// Number of clusters the view frustum is split into along each axis
+	const u32 CLUSTER_X = 16;
+	const u32 CLUSTER_Y = 9;
+	const u32 CLUSTER_Z = 24;
+	const u32 CLUSTER_COUNT = CLUSTER_X * CLUSTER_Y * CLUSTER_Z;
+
+	const u32 MAX_LIGHTS_PER_CLUSTER = 256;
+
+	/**
+	* Light as laid out in the shader storage buffer (std430).
+	*/
+	struct GpuLight
+	{
+		glm::vec4 posRange;		// xyz = world position, w = range of influence
+		glm::vec4 dirCutoff;	// xyz = direction, w = cosine of spotlight cutoff angle
+		glm::vec4 colIntensity;	// rgb = colour, a = intensity
+		glm::vec4 params;		// x = linear attenuation, y = quadratic attenuation, z = light type
+	};
+
+	/**
+	* Clustered forward light culling. The view frustum is split into a 3D grid of clusters (exponential depth slices),
+	* and each cluster is given the list of lights whose range overlaps it. The fragment shader then only loops over
+	* the lights in its own cluster. Binning runs on the CPU, one job per depth slice, testing four lights at a time.
+	*/
+	class LightClusters
+	{
+	public:
+		LightClusters();
+
+		/**
+		* Set lights for this frame. Directional lights must come first as they affect every cluster.
+		* Doesn't touch GL; the lights are uploaded by the next build.
+		*/
+		void setLights(const std::vector<GpuLight>& lights, u32 dirLightCount);
+
+		/**
+		* Bin lights into clusters for a camera viewing a target of the given size.
+		*/
+		void build(Camera& camera, u32 width, u32 height);
+
+	private:
+		struct ClusterBounds
+		{
+			glm::vec3 min;
+			glm::vec3 max;
+		};
+
+		struct ClusterRange
+		{
+			u32 offset;
+			u32 count;
+		};
+
+		// Per slice scratch space, so slices can be culled in parallel without sharing memory
+		struct Slice
+		{
+			std::vector<float> x, y, z, radiusSq;	// Candidate light spheres in view space (SoA)
+			std::vector<u32> lightIds;				// Light index of each candidate
+			std::vector<u32> indices;				// Output light indices for the clusters of this slice
+		};
+
+		void calcClusterBounds(const glm::mat4& projMatrix, float zNear, float zFar);
+		void cullSlice(u32 z);
+
+	private:
+		std::vector<GpuLight> lights;
+		u32 dirLightCount = 0;
+		bool lightsChanged = false;
+
+		// View space bounding spheres of the non-directional lights
+		std::vector<glm::vec4> viewLights;
+
+		std::vector<ClusterBounds> bounds;
+		std::vector<float> sliceDepths;
+		glm::mat4 boundsProjMatrix = glm::mat4(0.0f);
+
+		std::vector<Slice> slices;
+		std::vector<ClusterRange> grid;
+		std::vector<u32> lightIndices;
+
+		Box<StorageBuffer> lightBuf;
+		Box<StorageBuffer> gridBuf;
+		Box<StorageBuffer> indexBuf;
+	};
+}
+// @endcond
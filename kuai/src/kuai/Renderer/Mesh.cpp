@@ -1,5 +1,7 @@
 #include "kpch.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
 
 #include "glad/glad.h"
 
@@ -10,6 +12,10 @@ namespace kuai {
 		vertexData(vertexData), indices(indices)
 	{
 		meshId = meshCounter++;
+
+		lods.push_back({ 0, (u32)this->indices.size(), 0.0f });
+		calcBounds();
+		bvh.build(this->vertexData, this->indices.data(), this->indices.size());
 	}
 
 	Mesh::Mesh(const std::vector<float>& positions, const std::vector<float>& normals, const std::vector<float>& texCoords, const std::vector<u32>& indices)
@@ -42,9 +48,88 @@ namespace kuai {
 		}
 
 		meshId = meshCounter++;
+
+		lods.push_back({ 0, (u32)this->indices.size(), 0.0f });
+		calcBounds();
+		bvh.build(this->vertexData, this->indices.data(), this->indices.size());
 	}
 
 	Mesh::~Mesh()
 	{
 	}
+
+	void Mesh::setSkinWeights(const std::vector<SkinWeights>& skinWeights)
+	{
+		KU_CORE_ASSERT(skinWeights.empty() || skinWeights.size() == vertexData.size(), "Mesh needs skin weights for every vertex.");
+		this->skinWeights = skinWeights;
+	}
+
+	void Mesh::generateLods(u32 lodCount, float reduction)
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Throw away any previously generated levels
+		indices.resize(lods[0].indexCount);
+		lods.resize(1);
+
+		std::vector<u32> source = indices;
+		float screenSize = 0.25f;
+		lods[0].minScreenSize = screenSize;
+
+		// Each level is simplified from the one before it, which is much cheaper than starting from full detail every time
+		for (u32 i = 1; i < std::min(lodCount, MAX_LODS); i++)
+		{
+			u32 target = (u32)(lods.back().indexCount * reduction) / 3 * 3;
+			if (target < 3)
+				break;
+
+			std::vector<u32> simplified = MeshSimplifier::simplify(vertexData, source, target, 0.05f);
+			if (simplified.size() > lods.back().indexCount * 0.9f)
+				break; // Can't remove enough without visibly changing the shape
+
+			MeshOptimizer::optimizeVertexCache(simplified, vertexData.size());
+
+			screenSize *= 0.4f;
+			lods.push_back({ (u32)indices.size(), (u32)simplified.size(), screenSize });
+			indices.insert(indices.end(), simplified.begin(), simplified.end());
+
+			source = std::move(simplified);
+		}
+
+		lods.back().minScreenSize = 0.0f;
+	}
+
+	u32 selectLod(const std::vector<MeshLod>& lods, float screenSize)
+	{
+		for (u32 i = 0; i < lods.size(); i++)
+		{
+			if (screenSize >= lods[i].minScreenSize)
+				return i;
+		}
+		return (u32)lods.size() - 1;
+	}
+
+	u32 Mesh::selectLod(float screenSize) const
+	{
+		return kuai::selectLod(lods, screenSize);
+	}
+
+	void Mesh::calcBounds()
+	{
+		glm::vec3 min(std::numeric_limits<float>::max());
+		glm::vec3 max(std::numeric_limits<float>::lowest());
+		for (auto& vertex : vertexData)
+		{
+			glm::vec3 pos(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+			min = glm::min(min, pos);
+			max = glm::max(max, pos);
+		}
+
+		boundsCentre = vertexData.empty() ? glm::vec3(0.0f) : (min + max) * 0.5f;
+		boundsRadius = 0.0f;
+		for (auto& vertex : vertexData)
+		{
+			boundsRadius = std::max(boundsRadius, glm::length(glm::vec3(vertex.pos[0], vertex.pos[1], vertex.pos[2]) - boundsCentre));
+		}
+	}
 }
\ No newline at end of file
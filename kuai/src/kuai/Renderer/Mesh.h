@@ -2,6 +2,7 @@
 
 #include "Material.h"
 #include "Buffer.h"
+#include "MeshBVH.h"
 
 namespace kuai {
 	struct Vertex
@@ -11,6 +12,42 @@ namespace kuai {
 		float texCoords[2];
 	};
 
+	/**
+	* Quantised vertex at half the size of Vertex, read by shaders using VertexFormat::COMPACT.
+	*/
+	struct CompactVertex
+	{
+		u16 pos[4];			// Half floats, w is padding
+		i16 normal[2];		// Octahedral encoded, snorm16
+		u16 texCoords[2];	// Half floats
+	};
+
+	/**
+	* The joints moving a vertex of a skinned mesh and how much each one does; unused slots have zero weight.
+	*/
+	struct SkinWeights
+	{
+		u16 joints[4];
+		float weights[4];
+	};
+
+	const u32 MAX_LODS = 4;
+
+	/**
+	* A range of a mesh's index list that draws it at one level of detail.
+	*/
+	struct MeshLod
+	{
+		u32 firstIndex;
+		u32 indexCount;
+		float minScreenSize; // Smallest projected radius (as a fraction of half the screen height) this level is used at
+	};
+
+	/**
+	* Returns the first of lods (most detailed first) to draw at a given projected radius (as a fraction of half the screen height).
+	*/
+	u32 selectLod(const std::vector<MeshLod>& lods, float screenSize);
+
 	/** \class Mesh
 	*	\brief A collection of vertices, normals and texture coordinates that define a polyhedral object. Each mesh has a Material.
 	*/
@@ -34,7 +71,42 @@ namespace kuai {
 
 		virtual ~Mesh();
 
+		/**
+		* Generate lower levels of detail by simplifying the mesh, each with roughly reduction times the triangles of the last.
+		* Must be called before the mesh is used by a renderer.
+		* @param lodCount Total number of levels including the original, at most MAX_LODS.
+		*/
+		void generateLods(u32 lodCount = MAX_LODS, float reduction = 0.5f);
+
+		/**
+		* Returns the level of detail to draw for a given projected radius (as a fraction of half the screen height).
+		*/
+		u32 selectLod(float screenSize) const;
+
+		const std::vector<MeshLod>& getLods() const { return lods; }
+
+		/**
+		* Returns the centre of the mesh's bounding sphere in model space.
+		*/
+		const glm::vec3& getBoundsCentre() const { return boundsCentre; }
+		float getBoundsRadius() const { return boundsRadius; }
+
+		/**
+		* Joint influences for each vertex, or empty if the mesh isn't skinned. Skinned meshes are drawn with Shader::skinned.
+		*/
+		const std::vector<SkinWeights>& getSkinWeights() const { return skinWeights; }
+		void setSkinWeights(const std::vector<SkinWeights>& skinWeights);
+		bool isSkinned() const { return !skinWeights.empty(); }
+
+		/**
+		* Find the nearest triangle of the full detail mesh hit by a ray in model space, within maxDist.
+		* Uses a triangle hierarchy built when the mesh was created.
+		*/
+		bool raycast(const Ray& ray, float maxDist, MeshRayHit& hit) const { return bvh.raycast(ray, maxDist, hit); }
+
 	private:
+		void calcBounds();
+
 		u32 getId() const { return meshId; }
 
 		friend class RenderSystem;
@@ -43,7 +115,15 @@ namespace kuai {
 		u32 meshId;
 
 		std::vector<Vertex> vertexData;
-		std::vector<u32> indices;
+		std::vector<u32> indices;	// Every level of detail, one after another
+		std::vector<SkinWeights> skinWeights;
+
+		std::vector<MeshLod> lods;
+
+		glm::vec3 boundsCentre;
+		float boundsRadius;
+
+		MeshBVH bvh; // Over the full detail triangles, which generating levels of detail leaves alone
 
 	private:
 		static u32 meshCounter;
@@ -0,0 +1,320 @@
+#include "kpch.h"
+#include "MeshBVH.h"
+
+#include "Mesh.h"
+
+#ifdef KU_SIMD_SSE
+	#include <xmmintrin.h>
+#endif
+
+namespace kuai {
+	static const u32 BUILD_BINS = 12;
+	// Rays nearly parallel to a triangle's plane miss it, which also rejects degenerate triangles and unused packet lanes
+	static const float DET_EPSILON = 1e-12f;
+
+	static glm::vec3 posOf(const Vertex& vertex)
+	{
+		return glm::vec3(vertex.pos[0], vertex.pos[1], vertex.pos[2]);
+	}
+
+	void MeshBVH::build(const std::vector<Vertex>& vertexData, const u32* indices, u32 indexCount)
+	{
+		KU_PROFILE_FUNCTION();
+
+		nodes.clear();
+		packets.clear();
+
+		u32 triangleCount = indexCount / 3;
+		if (triangleCount == 0)
+			return;
+
+		std::vector<BuildTriangle> triangles(triangleCount);
+		for (u32 i = 0; i < triangleCount; i++)
+		{
+			glm::vec3 p0 = posOf(vertexData[indices[i * 3]]);
+			glm::vec3 p1 = posOf(vertexData[indices[i * 3 + 1]]);
+			glm::vec3 p2 = posOf(vertexData[indices[i * 3 + 2]]);
+
+			triangles[i].aabb = AABB(glm::min(glm::min(p0, p1), p2), glm::max(glm::max(p0, p1), p2));
+			triangles[i].centre = triangles[i].aabb.getCentre();
+			triangles[i].triangle = i;
+		}
+
+		nodes.reserve(triangleCount / PACKET_SIZE * 2 + 1);
+		packets.reserve(triangleCount / PACKET_SIZE + 1);
+
+		nodes.emplace_back();
+		buildNode(0, triangles.data(), triangleCount, vertexData, indices);
+	}
+
+	void MeshBVH::buildNode(u32 node, BuildTriangle* triangles, u32 count, const std::vector<Vertex>& vertexData, const u32* indices)
+	{
+		AABB aabb = triangles[0].aabb;
+		AABB centres(triangles[0].centre, triangles[0].centre);
+		for (u32 i = 1; i < count; i++)
+		{
+			aabb = AABB::merge(aabb, triangles[i].aabb);
+			centres = AABB::merge(centres, AABB(triangles[i].centre, triangles[i].centre));
+		}
+		nodes[node].aabb = aabb;
+
+		if (count <= PACKET_SIZE)
+		{
+			nodes[node].index = packets.size();
+			nodes[node].count = count;
+
+			TrianglePacket packet = {};
+			for (u32 lane = 0; lane < count; lane++)
+			{
+				u32 triangle = triangles[lane].triangle;
+				glm::vec3 p0 = posOf(vertexData[indices[triangle * 3]]);
+				glm::vec3 edge1 = posOf(vertexData[indices[triangle * 3 + 1]]) - p0;
+				glm::vec3 edge2 = posOf(vertexData[indices[triangle * 3 + 2]]) - p0;
+
+				for (u32 axis = 0; axis < 3; axis++)
+				{
+					packet.v0[axis][lane] = p0[axis];
+					packet.edge1[axis][lane] = edge1[axis];
+					packet.edge2[axis][lane] = edge2[axis];
+				}
+				packet.triangles[lane] = triangle;
+			}
+			packets.push_back(packet);
+			return;
+		}
+
+		// Binned surface area heuristic along the longest axis of the triangles' centres, as in DynamicTree::rebuild
+		glm::vec3 extent = centres.max - centres.min;
+		u32 axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+		u32 split = 0;
+		if (extent[axis] > 0.0f)
+		{
+			auto binOf = [&](const BuildTriangle& triangle)
+			{
+				return std::min((u32)((triangle.centre[axis] - centres.min[axis]) / extent[axis] * BUILD_BINS), BUILD_BINS - 1);
+			};
+
+			AABB binBoxes[BUILD_BINS];
+			u32 binCounts[BUILD_BINS] = {};
+			for (u32 i = 0; i < count; i++)
+			{
+				u32 bin = binOf(triangles[i]);
+				binBoxes[bin] = binCounts[bin]++ == 0 ? triangles[i].aabb : AABB::merge(binBoxes[bin], triangles[i].aabb);
+			}
+
+			float rightAreas[BUILD_BINS];
+			AABB right;
+			u32 rightCount = 0;
+			for (u32 i = BUILD_BINS - 1; i > 0; i--)
+			{
+				if (binCounts[i])
+					right = rightCount == 0 ? binBoxes[i] : AABB::merge(right, binBoxes[i]);
+				rightCount += binCounts[i];
+				rightAreas[i] = rightCount ? right.getSurfaceArea() * rightCount : 0.0f;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			u32 bestBin = BUILD_BINS / 2;
+			AABB left;
+			u32 leftCount = 0;
+			for (u32 i = 1; i < BUILD_BINS; i++)
+			{
+				if (binCounts[i - 1])
+					left = leftCount == 0 ? binBoxes[i - 1] : AABB::merge(left, binBoxes[i - 1]);
+				leftCount += binCounts[i - 1];
+
+				if (leftCount == 0 || leftCount == count)
+					continue;
+
+				float cost = left.getSurfaceArea() * leftCount + rightAreas[i];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBin = i;
+				}
+			}
+
+			split = (u32)(std::partition(triangles, triangles + count, [&](const BuildTriangle& triangle) { return binOf(triangle) < bestBin; }) - triangles);
+		}
+
+		// Lopsided splits make deep trees, so fall back to the median
+		u32 minSide = std::max(count / 8, 1u);
+		if (split < minSide || split > count - minSide)
+		{
+			split = count / 2;
+			std::nth_element(triangles, triangles + split, triangles + count,
+				[axis](const BuildTriangle& a, const BuildTriangle& b) { return a.centre[axis] < b.centre[axis]; });
+		}
+
+		// Children are laid out depth first: the first straight after this node, the second after the first's subtree
+		nodes[node].count = 0;
+		nodes.emplace_back();
+		buildNode(node + 1, triangles, split, vertexData, indices);
+
+		u32 child2 = nodes.size();
+		nodes[node].index = child2;
+		nodes.emplace_back();
+		buildNode(child2, triangles + split, count - split, vertexData, indices);
+	}
+
+	bool MeshBVH::raycast(const Ray& ray, float maxDist, MeshRayHit& hit) const
+	{
+		if (nodes.empty())
+			return false;
+
+		glm::vec3 invDir = 1.0f / ray.dir;
+		bool found = false;
+
+		u32 stack[MAX_STACK];
+		u32 count = 0;
+		stack[count++] = 0;
+
+		while (count > 0)
+		{
+			u32 index = stack[--count];
+			const Node& node = nodes[index];
+
+			float dist;
+			if (!intersectRayAABB(ray.origin, invDir, node.aabb, maxDist, dist))
+				continue;
+
+			if (node.count > 0)
+			{
+				found |= intersectPacket(packets[node.index], node.count, ray, maxDist, hit);
+				continue;
+			}
+
+			u32 child1 = index + 1;
+			u32 child2 = node.index;
+			float dist1, dist2;
+			bool hit1 = intersectRayAABB(ray.origin, invDir, nodes[child1].aabb, maxDist, dist1);
+			bool hit2 = intersectRayAABB(ray.origin, invDir, nodes[child2].aabb, maxDist, dist2);
+
+			KU_CORE_ASSERT(count + 2 <= MAX_STACK, "Mesh BVH is too deep to raycast.");
+
+			// Push the nearer child last so it's visited first and clips the ray for the other
+			if (hit1 && hit2)
+			{
+				stack[count++] = dist1 < dist2 ? child2 : child1;
+				stack[count++] = dist1 < dist2 ? child1 : child2;
+			}
+			else if (hit1)
+			{
+				stack[count++] = child1;
+			}
+			else if (hit2)
+			{
+				stack[count++] = child2;
+			}
+		}
+
+		return found;
+	}
+
+	bool MeshBVH::intersectPacket(const TrianglePacket& packet, u32 count, const Ray& ray, float& maxDist, MeshRayHit& hit) const
+	{
+		// Moller-Trumbore, for every lane at once
+		u32 bestLane = PACKET_SIZE;
+		float bestT = maxDist, bestU = 0.0f, bestV = 0.0f;
+
+#ifdef KU_SIMD_SSE
+		const __m128 dx = _mm_set1_ps(ray.dir.x), dy = _mm_set1_ps(ray.dir.y), dz = _mm_set1_ps(ray.dir.z);
+
+		const __m128 e1x = _mm_load_ps(packet.edge1[0]), e1y = _mm_load_ps(packet.edge1[1]), e1z = _mm_load_ps(packet.edge1[2]);
+		const __m128 e2x = _mm_load_ps(packet.edge2[0]), e2y = _mm_load_ps(packet.edge2[1]), e2z = _mm_load_ps(packet.edge2[2]);
+
+		// p = dir x edge2
+		__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+		__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+		__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+		__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+		__m128 invDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+		// s = origin - v0
+		__m128 sx = _mm_sub_ps(_mm_set1_ps(ray.origin.x), _mm_load_ps(packet.v0[0]));
+		__m128 sy = _mm_sub_ps(_mm_set1_ps(ray.origin.y), _mm_load_ps(packet.v0[1]));
+		__m128 sz = _mm_sub_ps(_mm_set1_ps(ray.origin.z), _mm_load_ps(packet.v0[2]));
+
+		__m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+
+		// q = s x edge1
+		__m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+		__m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+		__m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+
+		__m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+		__m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+		const __m128 zero = _mm_setzero_ps();
+		__m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det);
+		__m128 mask = _mm_cmpgt_ps(absDet, _mm_set1_ps(DET_EPSILON));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+		mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+		mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+		mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(maxDist)));
+
+		int hits = _mm_movemask_ps(mask) & (BIT(count) - 1);
+		if (!hits)
+			return false;
+
+		alignas(16) float ts[PACKET_SIZE], us[PACKET_SIZE], vs[PACKET_SIZE];
+		_mm_store_ps(ts, t);
+		_mm_store_ps(us, u);
+		_mm_store_ps(vs, v);
+
+		for (u32 lane = 0; lane < count; lane++)
+		{
+			if ((hits & BIT(lane)) && ts[lane] < bestT)
+			{
+				bestLane = lane;
+				bestT = ts[lane];
+				bestU = us[lane];
+				bestV = vs[lane];
+			}
+		}
+#else
+		for (u32 lane = 0; lane < count; lane++)
+		{
+			glm::vec3 edge1(packet.edge1[0][lane], packet.edge1[1][lane], packet.edge1[2][lane]);
+			glm::vec3 edge2(packet.edge2[0][lane], packet.edge2[1][lane], packet.edge2[2][lane]);
+
+			glm::vec3 p = glm::cross(ray.dir, edge2);
+			float det = glm::dot(edge1, p);
+			if (std::abs(det) <= DET_EPSILON)
+				continue;
+			float invDet = 1.0f / det;
+
+			glm::vec3 s = ray.origin - glm::vec3(packet.v0[0][lane], packet.v0[1][lane], packet.v0[2][lane]);
+			float u = glm::dot(s, p) * invDet;
+			if (u < 0.0f || u > 1.0f)
+				continue;
+
+			glm::vec3 q = glm::cross(s, edge1);
+			float v = glm::dot(ray.dir, q) * invDet;
+			if (v < 0.0f || u + v > 1.0f)
+				continue;
+
+			float t = glm::dot(edge2, q) * invDet;
+			if (t >= 0.0f && t < bestT)
+			{
+				bestLane = lane;
+				bestT = t;
+				bestU = u;
+				bestV = v;
+			}
+		}
+#endif
+
+		if (bestLane == PACKET_SIZE)
+			return false;
+
+		maxDist = bestT;
+		hit.distance = bestT;
+		hit.triangle = packet.triangles[bestLane];
+		hit.barycentrics = glm::vec3(1.0f - bestU - bestV, bestU, bestV);
+		return true;
+	}
+}
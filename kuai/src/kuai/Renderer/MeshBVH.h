@@ -0,0 +1,79 @@
+#pragma once
+
+#include "kuai/Physics/AABB.h"
+#include "kuai/Physics/Ray.h"
+
+// @cond
+namespace kuai {
+	// Forward declaration
+	struct Vertex;
+
+	/**
+	* Where a ray hit a mesh. The hit point is barycentrics.x * v0 + barycentrics.y * v1 + barycentrics.z * v2
+	* of the triangle's vertices, in index order.
+	*/
+	struct MeshRayHit
+	{
+		float distance = 0.0f;
+		u32 triangle = 0; // Index of the triangle's first index divided by three
+		glm::vec3 barycentrics = glm::vec3(0.0f);
+	};
+
+	/**
+	* Static bounding volume hierarchy over a mesh's triangles, built once when the mesh is loaded.
+	* Leaves hold up to four triangles laid out side by side, so a ray is tested against all of them at once with SSE.
+	*/
+	class MeshBVH
+	{
+	public:
+		void build(const std::vector<Vertex>& vertexData, const u32* indices, u32 indexCount);
+
+		/**
+		* Find the nearest triangle the ray hits within maxDist, in the mesh's space. Both sides of triangles are hit.
+		* dir needn't be normalised; distances are measured in multiples of it, so a ray transformed into the mesh's space keeps world distances.
+		*/
+		bool raycast(const Ray& ray, float maxDist, MeshRayHit& hit) const;
+
+		bool empty() const { return nodes.empty(); }
+		const AABB& getBounds() const { return nodes[0].aabb; }
+
+	private:
+		static const u32 PACKET_SIZE = 4;
+		static const u32 MAX_STACK = 128;
+
+		struct Node
+		{
+			AABB aabb;
+			u32 index;	// Leaves: their packet. Internal nodes: the second child; the first follows the node.
+			u32 count;	// Triangles in a leaf, zero for internal nodes
+		};
+
+		// Four triangles as their first vertex and two edges from it, one lane each. Unused lanes are degenerate and never hit.
+		struct alignas(16) TrianglePacket
+		{
+			float v0[3][PACKET_SIZE];
+			float edge1[3][PACKET_SIZE];
+			float edge2[3][PACKET_SIZE];
+			u32 triangles[PACKET_SIZE];
+		};
+
+		struct BuildTriangle
+		{
+			AABB aabb;
+			glm::vec3 centre;
+			u32 triangle;
+		};
+
+		void buildNode(u32 node, BuildTriangle* triangles, u32 count, const std::vector<Vertex>& vertexData, const u32* indices);
+
+		/**
+		* Test a ray against a packet, shrinking maxDist and filling hit if any triangle is nearer.
+		*/
+		bool intersectPacket(const TrianglePacket& packet, u32 count, const Ray& ray, float& maxDist, MeshRayHit& hit) const;
+
+	private:
+		std::vector<Node> nodes;
+		std::vector<TrianglePacket> packets;
+	};
+}
+// @endcond
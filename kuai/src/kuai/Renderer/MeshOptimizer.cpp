@@ -0,0 +1,243 @@
+#include "kpch.h"
+#include "MeshOptimizer.h"
+
+#include "glm/glm.hpp"
+
+#include <cstring>
+
+namespace kuai {
+	// Simulated post-transform cache, a little larger than most hardware so the ordering degrades gracefully
+	static const u32 CACHE_SIZE = 32;
+
+	static float cacheScore(i32 cachePos)
+	{
+		if (cachePos < 0)
+			return 0.0f;
+
+		// The triangle just drawn used the first three entries; reusing them straight away is deliberately discouraged
+		if (cachePos < 3)
+			return 0.75f;
+
+		return std::pow(1.0f - (float)(cachePos - 3) / (CACHE_SIZE - 3), 1.5f);
+	}
+
+	static float vertexScore(i32 cachePos, u32 remainingTris)
+	{
+		if (remainingTris == 0)
+			return -1.0f;
+
+		// Favour vertices with few triangles left so they can be finished and leave the cache
+		return cacheScore(cachePos) + 2.0f / std::sqrt((float)remainingTris);
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::vector<u32>& indices, u32 vertexCount)
+	{
+		KU_PROFILE_FUNCTION();
+
+		u32 triCount = indices.size() / 3;
+		if (triCount == 0)
+			return;
+
+		// Triangles adjacent to each vertex, stored contiguously
+		std::vector<u32> remaining(vertexCount, 0);
+		for (u32 index : indices)
+			remaining[index]++;
+
+		std::vector<u32> adjacencyOffsets(vertexCount + 1, 0);
+		for (u32 v = 0; v < vertexCount; v++)
+			adjacencyOffsets[v + 1] = adjacencyOffsets[v] + remaining[v];
+
+		std::vector<u32> adjacency(indices.size());
+		std::vector<u32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+		for (u32 t = 0; t < triCount; t++)
+		{
+			for (u32 k = 0; k < 3; k++)
+				adjacency[fill[indices[t * 3 + k]]++] = t;
+		}
+
+		std::vector<i32> cachePos(vertexCount, -1);
+		std::vector<float> scores(vertexCount);
+		for (u32 v = 0; v < vertexCount; v++)
+			scores[v] = vertexScore(-1, remaining[v]);
+
+		std::vector<float> triScores(triCount);
+		std::vector<bool> emitted(triCount, false);
+		for (u32 t = 0; t < triCount; t++)
+			triScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+
+		std::vector<u32> result;
+		result.reserve(indices.size());
+
+		u32 cache[CACHE_SIZE + 3];
+		u32 cacheCount = 0;
+		u32 nextCandidate = 0;
+
+		i64 bestTri = 0;
+		for (u32 t = 1; t < triCount; t++)
+		{
+			if (triScores[t] > triScores[bestTri])
+				bestTri = t;
+		}
+
+		while (bestTri >= 0)
+		{
+			emitted[bestTri] = true;
+
+			u32 newCache[CACHE_SIZE + 3];
+			u32 newCount = 0;
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 v = indices[bestTri * 3 + k];
+				result.push_back(v);
+				newCache[newCount++] = v;
+
+				// Remove the triangle from this vertex's adjacency list
+				u32* begin = &adjacency[adjacencyOffsets[v]];
+				u32* end = begin + remaining[v];
+				*std::find(begin, end, (u32)bestTri) = *(end - 1);
+				remaining[v]--;
+			}
+
+			// Push the triangle's vertices to the front of the cache, keeping the rest in order
+			for (u32 i = 0; i < cacheCount; i++)
+			{
+				u32 v = cache[i];
+				if (v != newCache[0] && v != newCache[1] && v != newCache[2])
+					newCache[newCount++] = v;
+			}
+
+			for (u32 i = 0; i < newCount; i++)
+			{
+				u32 v = newCache[i];
+				cachePos[v] = i < CACHE_SIZE ? (i32)i : -1; // Entries pushed past the end have been evicted
+				scores[v] = vertexScore(cachePos[v], remaining[v]);
+			}
+
+			// Only triangles touching the cache changed score, so the next best is almost always among them
+			bestTri = -1;
+			float bestScore = -1.0f;
+			for (u32 i = 0; i < newCount; i++)
+			{
+				u32 v = newCache[i];
+				for (u32 j = adjacencyOffsets[v]; j < adjacencyOffsets[v] + remaining[v]; j++)
+				{
+					u32 t = adjacency[j];
+					triScores[t] = scores[indices[t * 3]] + scores[indices[t * 3 + 1]] + scores[indices[t * 3 + 2]];
+					if (triScores[t] > bestScore)
+					{
+						bestScore = triScores[t];
+						bestTri = t;
+					}
+				}
+			}
+
+			cacheCount = std::min(newCount, CACHE_SIZE);
+			std::memcpy(cache, newCache, cacheCount * sizeof(u32));
+
+			// Nothing in the cache has triangles left, so carry on from the next unemitted triangle
+			if (bestTri < 0)
+			{
+				while (nextCandidate < triCount && emitted[nextCandidate])
+					nextCandidate++;
+
+				if (nextCandidate < triCount)
+					bestTri = nextCandidate;
+			}
+		}
+
+		indices = std::move(result);
+	}
+
+	void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<u32>& indices, std::vector<SkinWeights>* skinWeights)
+	{
+		KU_PROFILE_FUNCTION();
+
+		std::vector<u32> remap(vertices.size(), std::numeric_limits<u32>::max());
+		std::vector<Vertex> reordered;
+		reordered.reserve(vertices.size());
+
+		std::vector<SkinWeights> reorderedWeights;
+		if (skinWeights)
+			reorderedWeights.reserve(skinWeights->size());
+
+		for (u32& index : indices)
+		{
+			if (remap[index] == std::numeric_limits<u32>::max())
+			{
+				remap[index] = reordered.size();
+				reordered.push_back(vertices[index]);
+				if (skinWeights)
+					reorderedWeights.push_back((*skinWeights)[index]);
+			}
+			index = remap[index];
+		}
+
+		vertices = std::move(reordered);
+		if (skinWeights)
+			*skinWeights = std::move(reorderedWeights);
+	}
+
+	static u16 floatToHalf(float value)
+	{
+		u32 bits;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		u32 sign = (bits >> 16) & 0x8000;
+		i32 exponent = (i32)((bits >> 23) & 0xFF) - 127 + 15;
+		u32 mantissa = bits & 0x7FFFFF;
+
+		if (exponent >= 31) // Too large (or inf/nan), clamp to infinity
+			return sign | 0x7C00;
+
+		if (exponent <= 0) // Too small for a normal half
+		{
+			if (exponent < -10)
+				return sign;
+
+			mantissa |= 0x800000;
+			return sign | (u16)((mantissa >> (14 - exponent)) + ((mantissa >> (13 - exponent)) & 1));
+		}
+
+		// Round to nearest; a carry out of the mantissa correctly bumps the exponent
+		return sign | (u16)(((exponent << 10) | (mantissa >> 13)) + ((mantissa >> 12) & 1));
+	}
+
+	static i16 floatToSnorm16(float value)
+	{
+		return (i16)std::round(std::clamp(value, -1.0f, 1.0f) * 32767.0f);
+	}
+
+	void MeshOptimizer::packVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& packed)
+	{
+		KU_PROFILE_FUNCTION();
+
+		packed.resize(vertices.size());
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			const Vertex& v = vertices[i];
+			CompactVertex& c = packed[i];
+
+			c.pos[0] = floatToHalf(v.pos[0]);
+			c.pos[1] = floatToHalf(v.pos[1]);
+			c.pos[2] = floatToHalf(v.pos[2]);
+			c.pos[3] = floatToHalf(1.0f);
+
+			// Octahedral encoding: project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the upper
+			glm::vec3 n(v.normal[0], v.normal[1], v.normal[2]);
+			float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+			glm::vec2 e = l1 > 0.0f ? glm::vec2(n.x / l1, n.y / l1) : glm::vec2(0.0f);
+			if (l1 > 0.0f && n.z < 0.0f)
+			{
+				e = glm::vec2(
+					(1.0f - std::abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+					(1.0f - std::abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+			}
+			c.normal[0] = floatToSnorm16(e.x);
+			c.normal[1] = floatToSnorm16(e.y);
+
+			c.texCoords[0] = floatToHalf(v.texCoords[0]);
+			c.texCoords[1] = floatToHalf(v.texCoords[1]);
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Mesh.h"
+
+// @cond
+namespace kuai {
+	/**
+	* Import time optimisations that reorder mesh data for the GPU, plus packing into the compact vertex format.
+	*/
+	class MeshOptimizer
+	{
+	public:
+		/**
+		* Reorder triangles so recently transformed vertices are reused from the post-transform cache (Forsyth's algorithm).
+		*/
+		static void optimizeVertexCache(std::vector<u32>& indices, u32 vertexCount);
+
+		/**
+		* Reorder vertices into the order they are first referenced so vertex fetches walk memory linearly.
+		* Unreferenced vertices are dropped. Indices, and skin weights if given, are remapped to match.
+		*/
+		static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<u32>& indices, std::vector<SkinWeights>* skinWeights = nullptr);
+
+		/**
+		* Quantise vertices into the compact format: half float positions and uvs, octahedral snorm16 normals.
+		*/
+		static void packVertices(const std::vector<Vertex>& vertices, std::vector<CompactVertex>& packed);
+	};
+}
+// @endcond
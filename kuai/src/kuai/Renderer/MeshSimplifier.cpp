@@ -0,0 +1,293 @@
+#include "kpch.h"
+#include "MeshSimplifier.h"
+
+#include "glm/glm.hpp"
+
+#include <queue>
+
+namespace kuai {
+	/**
+	* Symmetric 4x4 matrix storing the sum of squared distances to a set of planes.
+	*/
+	struct Quadric
+	{
+		double a2 = 0, ab = 0, ac = 0, ad = 0;
+		double b2 = 0, bc = 0, bd = 0;
+		double c2 = 0, cd = 0;
+		double d2 = 0;
+
+		void addPlane(double a, double b, double c, double d, double weight)
+		{
+			a2 += weight * a * a; ab += weight * a * b; ac += weight * a * c; ad += weight * a * d;
+			b2 += weight * b * b; bc += weight * b * c; bd += weight * b * d;
+			c2 += weight * c * c; cd += weight * c * d;
+			d2 += weight * d * d;
+		}
+
+		Quadric& operator+=(const Quadric& q)
+		{
+			a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+			b2 += q.b2; bc += q.bc; bd += q.bd;
+			c2 += q.c2; cd += q.cd;
+			d2 += q.d2;
+			return *this;
+		}
+
+		double error(const glm::vec3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+			return x * x * a2 + 2 * x * y * ab + 2 * x * z * ac + 2 * x * ad
+				+ y * y * b2 + 2 * y * z * bc + 2 * y * bd
+				+ z * z * c2 + 2 * z * cd
+				+ d2;
+		}
+	};
+
+	struct Collapse
+	{
+		float cost;
+		u32 from, to;
+		u32 fromStamp, toStamp; // Stamps of both vertices when queued, so stale entries can be skipped
+
+		bool operator>(const Collapse& other) const { return cost > other.cost; }
+	};
+
+	struct PositionHash
+	{
+		size_t operator()(const glm::vec3& p) const
+		{
+			std::hash<float> hasher;
+			return hasher(p.x) ^ (hasher(p.y) * 73856093) ^ (hasher(p.z) * 19349663);
+		}
+	};
+
+	std::vector<u32> MeshSimplifier::simplify(const std::vector<Vertex>& vertices, const std::vector<u32>& indices, u32 targetIndexCount, float maxError)
+	{
+		KU_PROFILE_FUNCTION();
+
+		if (indices.size() <= targetIndexCount || indices.size() < 3)
+			return indices;
+
+		// Weld vertices that share a position (split by normals or uv seams) so collapses see one connected surface.
+		// Each position is represented by the index of the first vertex found there.
+		std::vector<u32> remap(vertices.size());
+		std::vector<glm::vec3> positions(vertices.size());
+		std::unordered_map<glm::vec3, u32, PositionHash> positionToVertex;
+
+		glm::vec3 boundsMin(std::numeric_limits<float>::max());
+		glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+		for (u32 i = 0; i < vertices.size(); i++)
+		{
+			positions[i] = glm::vec3(vertices[i].pos[0], vertices[i].pos[1], vertices[i].pos[2]);
+			remap[i] = positionToVertex.emplace(positions[i], i).first->second;
+
+			boundsMin = glm::min(boundsMin, positions[i]);
+			boundsMax = glm::max(boundsMax, positions[i]);
+		}
+
+		// Error is measured in squared distance, relative to the size of the mesh
+		float extent = glm::length(boundsMax - boundsMin) * 0.5f;
+		double errorLimit = (double)(maxError * extent) * (maxError * extent);
+
+		u32 triCount = indices.size() / 3;
+		std::vector<u32> tris(triCount * 3);
+		std::vector<bool> triAlive(triCount, true);
+		std::vector<std::vector<u32>> vertexTris(vertices.size());
+		std::vector<Quadric> quadrics(vertices.size());
+
+		u32 liveTris = 0;
+		for (u32 t = 0; t < triCount; t++)
+		{
+			u32 v0 = remap[indices[t * 3]], v1 = remap[indices[t * 3 + 1]], v2 = remap[indices[t * 3 + 2]];
+			tris[t * 3] = v0;
+			tris[t * 3 + 1] = v1;
+			tris[t * 3 + 2] = v2;
+
+			if (v0 == v1 || v1 == v2 || v0 == v2)
+			{
+				triAlive[t] = false;
+				continue;
+			}
+
+			glm::vec3 normal = glm::cross(positions[v1] - positions[v0], positions[v2] - positions[v0]);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+			{
+				normal /= length;
+				double d = -glm::dot(normal, positions[v0]);
+				for (u32 k = 0; k < 3; k++)
+				{
+					quadrics[tris[t * 3 + k]].addPlane(normal.x, normal.y, normal.z, d, 1.0);
+				}
+			}
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				vertexTris[tris[t * 3 + k]].push_back(t);
+			}
+			liveTris++;
+		}
+
+		// Count how many triangles use each edge; edges used once are on the border of the mesh
+		auto edgeKey = [](u32 a, u32 b) { return a < b ? ((u64)a << 32) | b : ((u64)b << 32) | a; };
+		std::unordered_map<u64, u32> edgeUses;
+		for (u32 t = 0; t < triCount; t++)
+		{
+			if (!triAlive[t])
+				continue;
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				edgeUses[edgeKey(tris[t * 3 + k], tris[t * 3 + (k + 1) % 3])]++;
+			}
+		}
+
+		// Pin borders in place with a heavily weighted plane through the edge, perpendicular to its triangle
+		for (u32 t = 0; t < triCount; t++)
+		{
+			if (!triAlive[t])
+				continue;
+
+			glm::vec3 faceNormal = glm::cross(positions[tris[t * 3 + 1]] - positions[tris[t * 3]], positions[tris[t * 3 + 2]] - positions[tris[t * 3]]);
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 a = tris[t * 3 + k], b = tris[t * 3 + (k + 1) % 3];
+				if (edgeUses[edgeKey(a, b)] != 1)
+					continue;
+
+				glm::vec3 normal = glm::cross(positions[b] - positions[a], faceNormal);
+				float length = glm::length(normal);
+				if (length > 0.0f)
+				{
+					normal /= length;
+					double d = -glm::dot(normal, positions[a]);
+					quadrics[a].addPlane(normal.x, normal.y, normal.z, d, 10.0);
+					quadrics[b].addPlane(normal.x, normal.y, normal.z, d, 10.0);
+				}
+			}
+		}
+
+		std::vector<u32> stamps(vertices.size(), 0);
+		std::vector<bool> collapsed(vertices.size(), false);
+		std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+		// Queue the cheaper direction of collapsing an edge
+		auto pushEdge = [&](u32 a, u32 b)
+		{
+			Quadric q = quadrics[a];
+			q += quadrics[b];
+			double toB = q.error(positions[b]);
+			double toA = q.error(positions[a]);
+
+			if (toB <= toA)
+				queue.push({ (float)toB, a, b, stamps[a], stamps[b] });
+			else
+				queue.push({ (float)toA, b, a, stamps[b], stamps[a] });
+		};
+
+		for (auto& pair : edgeUses)
+		{
+			pushEdge((u32)(pair.first >> 32), (u32)(pair.first & 0xFFFFFFFF));
+		}
+
+		// Moving a vertex must not flip (or nearly flip) any triangle that stays alive
+		auto flipsTriangles = [&](u32 from, u32 to)
+		{
+			for (u32 t : vertexTris[from])
+			{
+				if (!triAlive[t])
+					continue;
+
+				u32* tri = &tris[t * 3];
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+					continue; // Will be removed by the collapse
+
+				glm::vec3 p[3], moved[3];
+				for (u32 k = 0; k < 3; k++)
+				{
+					p[k] = positions[tri[k]];
+					moved[k] = tri[k] == from ? positions[to] : p[k];
+				}
+
+				glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+				glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+				if (glm::dot(before, after) <= 0.2f * glm::length(before) * glm::length(after))
+					return true;
+			}
+			return false;
+		};
+
+		while (liveTris * 3 > targetIndexCount && !queue.empty())
+		{
+			Collapse c = queue.top();
+			queue.pop();
+
+			if (collapsed[c.from] || collapsed[c.to] || c.fromStamp != stamps[c.from] || c.toStamp != stamps[c.to])
+				continue;
+
+			if (c.cost > errorLimit)
+				break;
+
+			if (flipsTriangles(c.from, c.to))
+				continue;
+
+			// Move every triangle from the collapsed vertex onto its target, removing the ones that degenerate
+			for (u32 t : vertexTris[c.from])
+			{
+				if (!triAlive[t])
+					continue;
+
+				u32* tri = &tris[t * 3];
+				if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+				{
+					triAlive[t] = false;
+					liveTris--;
+					continue;
+				}
+
+				for (u32 k = 0; k < 3; k++)
+				{
+					if (tri[k] == c.from)
+						tri[k] = c.to;
+				}
+				vertexTris[c.to].push_back(t);
+			}
+
+			quadrics[c.to] += quadrics[c.from];
+			collapsed[c.from] = true;
+			vertexTris[c.from].clear();
+			stamps[c.to]++;
+
+			// Costs of every edge around the target vertex have changed
+			std::vector<u32>& adjacent = vertexTris[c.to];
+			adjacent.erase(std::remove_if(adjacent.begin(), adjacent.end(), [&triAlive](u32 t) { return !triAlive[t]; }), adjacent.end());
+			for (u32 t : adjacent)
+			{
+				for (u32 k = 0; k < 3; k++)
+				{
+					u32 v = tris[t * 3 + k];
+					if (v != c.to)
+						pushEdge(c.to, v);
+				}
+			}
+		}
+
+		// Keep each corner's original vertex (and so its normal and uv) when its position survived,
+		// otherwise use the vertex it was collapsed onto
+		std::vector<u32> result;
+		result.reserve(liveTris * 3);
+		for (u32 t = 0; t < triCount; t++)
+		{
+			if (!triAlive[t])
+				continue;
+
+			for (u32 k = 0; k < 3; k++)
+			{
+				u32 original = indices[t * 3 + k];
+				result.push_back(remap[original] == tris[t * 3 + k] ? original : tris[t * 3 + k]);
+			}
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Mesh.h"
+
+// @cond
+namespace kuai {
+	/**
+	* Reduces the triangle count of a mesh using quadric error metric edge collapses (Garland & Heckbert).
+	* Only the index list is rewritten; simplified meshes reference the original vertices, so every level
+	* of detail can share one vertex buffer.
+	*/
+	class MeshSimplifier
+	{
+	public:
+		/**
+		* Collapse edges until at most targetIndexCount indices remain, or the next collapse would move the
+		* surface by more than maxError (relative to the mesh's bounding radius).
+		* @return The simplified index list.
+		*/
+		static std::vector<u32> simplify(const std::vector<Vertex>& vertices, const std::vector<u32>& indices, u32 targetIndexCount, float maxError);
+	};
+}
+// @endcond
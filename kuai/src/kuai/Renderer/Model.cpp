@@ -1,13 +1,58 @@
 #include "kpch.h"
 #include "Model.h"
+#include "MeshOptimizer.h"
+#include "Shader.h"
+
+#include "kuai/Core/JobSystem.h"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include "glm/gtc/type_ptr.hpp"
+
 namespace kuai {
+	// Animations are resampled to keys at a fixed rate so playing them never searches for keys
+	static const float ANIMATION_SAMPLE_RATE = 30.0f;
+	// Assimp leaves ticks per second at 0 when the file doesn't say
+	static const double DEFAULT_TICKS_PER_SECOND = 25.0;
+
+	// Assimp matrices are row major, glm's are column major
+	static glm::mat4 toGlm(const aiMatrix4x4& m)
+	{
+		return glm::transpose(glm::make_mat4(&m.a1));
+	}
+
+	// Interpolate a channel's keys at time, in ticks. Times only increase between calls, so cursor walks forwards through the keys.
+	static glm::vec3 sampleKeys(const aiVectorKey* keys, u32 count, double time, u32& cursor)
+	{
+		while (cursor + 1 < count && keys[cursor + 1].mTime <= time)
+			cursor++;
+
+		const aiVector3D& a = keys[cursor].mValue;
+		if (cursor + 1 >= count || time <= keys[cursor].mTime)
+			return glm::vec3(a.x, a.y, a.z);
+
+		const aiVector3D& b = keys[cursor + 1].mValue;
+		float t = (float)((time - keys[cursor].mTime) / (keys[cursor + 1].mTime - keys[cursor].mTime));
+		return glm::mix(glm::vec3(a.x, a.y, a.z), glm::vec3(b.x, b.y, b.z), t);
+	}
 
-	Model::Model(const std::string& filename)
+	static glm::quat sampleKeys(const aiQuatKey* keys, u32 count, double time, u32& cursor)
+	{
+		while (cursor + 1 < count && keys[cursor + 1].mTime <= time)
+			cursor++;
+
+		const aiQuaternion& a = keys[cursor].mValue;
+		if (cursor + 1 >= count || time <= keys[cursor].mTime)
+			return glm::quat(a.w, a.x, a.y, a.z);
+
+		const aiQuaternion& b = keys[cursor + 1].mValue;
+		float t = (float)((time - keys[cursor].mTime) / (keys[cursor + 1].mTime - keys[cursor].mTime));
+		return glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), t);
+	}
+
+	Model::Model(const std::string& filename, u32 lodCount)
 	{
 		Assimp::Importer importer;
 		const aiScene* scene = importer.ReadFile(filename, aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals);
@@ -19,7 +64,35 @@ namespace kuai {
 		}
 		directory = filename.substr(0, filename.find_last_of('/'));
 
+		bool skinned = false;
+		for (u32 i = 0; i < scene->mNumMeshes && !skinned; i++)
+			skinned = scene->mMeshes[i]->HasBones();
+
+		// Every node becomes a joint, so bones and the nodes between them animate alike
+		if (skinned)
+		{
+			skeleton = makeRc<Skeleton>();
+			processSkeleton(scene->mRootNode, -1);
+			skeleton->setGlobalInverse(glm::inverse(toGlm(scene->mRootNode->mTransformation)));
+		}
+
 		processNode(scene->mRootNode, scene);
+
+		if (skeleton)
+		{
+			for (u32 i = 0; i < scene->mNumAnimations; i++)
+				animations.push_back(processAnimation(scene->mAnimations[i]));
+		}
+
+		if (lodCount > 1)
+		{
+			// Meshes simplify independently, so spread them across the job system
+			JobSystem::parallelFor(meshes.size(), 1, [this, lodCount](u32 start, u32 end)
+			{
+				for (u32 i = start; i < end; i++)
+					meshes[i]->generateLods(lodCount);
+			});
+		}
 	}
 
 	Model::Model(Rc<Mesh> mesh, Rc<Material> material)
@@ -36,6 +109,17 @@ namespace kuai {
 		}
 	}
 
+	Rc<AnimationClip> Model::getAnimation(const std::string& name) const
+	{
+		for (auto& animation : animations)
+		{
+			if (animation->getName() == name)
+				return animation;
+		}
+
+		return nullptr;
+	}
+
 	void Model::processNode(aiNode* node, const aiScene* scene)
 	{
 		for (size_t i = 0; i < node->mNumMeshes; i++)
@@ -83,7 +167,65 @@ namespace kuai {
 			}
 		}
 
+		// Joint influences, keeping the four strongest on each vertex
+		std::vector<SkinWeights> skinWeights;
+		if (skeleton && mesh->HasBones())
+		{
+			skinWeights.resize(mesh->mNumVertices, { { 0, 0, 0, 0 }, { 0.0f, 0.0f, 0.0f, 0.0f } });
+
+			for (u32 i = 0; i < mesh->mNumBones; i++)
+			{
+				aiBone* bone = mesh->mBones[i];
+				i32 joint = skeleton->findJoint(bone->mName.C_Str());
+				if (joint < 0)
+					continue;
+
+				skeleton->setInverseBind(joint, toGlm(bone->mOffsetMatrix));
+
+				for (u32 j = 0; j < bone->mNumWeights; j++)
+				{
+					SkinWeights& vertex = skinWeights[bone->mWeights[j].mVertexId];
+
+					u32 weakest = 0;
+					for (u32 k = 1; k < 4; k++)
+					{
+						if (vertex.weights[k] < vertex.weights[weakest])
+							weakest = k;
+					}
+
+					if (bone->mWeights[j].mWeight > vertex.weights[weakest])
+					{
+						vertex.joints[weakest] = (u16)joint;
+						vertex.weights[weakest] = bone->mWeights[j].mWeight;
+					}
+				}
+			}
+
+			// Dropped influences would otherwise pull vertices towards the origin
+			for (SkinWeights& vertex : skinWeights)
+			{
+				float total = vertex.weights[0] + vertex.weights[1] + vertex.weights[2] + vertex.weights[3];
+				if (total > 0.0f)
+				{
+					for (u32 k = 0; k < 4; k++)
+						vertex.weights[k] /= total;
+				}
+				else
+				{
+					vertex.weights[0] = 1.0f;
+				}
+			}
+		}
+
+		// Assimp keeps the file's ordering, which is rarely friendly to the GPU's vertex caches
+		MeshOptimizer::optimizeVertexCache(indices, vertexData.size());
+		MeshOptimizer::optimizeVertexFetch(vertexData, indices, skinWeights.empty() ? nullptr : &skinWeights);
+
+		Rc<Mesh> result = makeRc<Mesh>(vertexData, indices);
+		result->setSkinWeights(skinWeights);
+
 		// Material
+		Rc<Material> meshMaterial = nullptr;
 		if (mesh->mMaterialIndex)
 		{
 			aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
@@ -97,13 +239,87 @@ namespace kuai {
 			// TODO: normal maps and height maps
 			if (textures.size() >= 1)
 			{
-				materials.push_back(makeRc<DefaultMaterial>(makeRc<Texture>(textures[0])));
-				return makeRc<Mesh>(vertexData, indices);
+				meshMaterial = makeRc<DefaultMaterial>(makeRc<Texture>(textures[0]));
+			}
+		}
+
+		if (!meshMaterial)
+			meshMaterial = makeRc<DefaultMaterial>();
+
+		if (result->isSkinned())
+			meshMaterial->setShader(Shader::skinned);
+
+		materials.push_back(meshMaterial);
+		return result;
+	}
+
+	void Model::processSkeleton(aiNode* node, i32 parent)
+	{
+		aiVector3D scale;
+		aiQuaternion rotation;
+		aiVector3D translation;
+		node->mTransformation.Decompose(scale, rotation, translation);
+
+		i32 joint = skeleton->addJoint(node->mName.C_Str(), parent,
+			glm::vec3(translation.x, translation.y, translation.z),
+			glm::quat(rotation.w, rotation.x, rotation.y, rotation.z),
+			glm::vec3(scale.x, scale.y, scale.z));
+
+		for (size_t i = 0; i < node->mNumChildren; i++)
+		{
+			processSkeleton(node->mChildren[i], joint);
+		}
+	}
+
+	Rc<AnimationClip> Model::processAnimation(aiAnimation* animation)
+	{
+		double ticksPerSecond = animation->mTicksPerSecond > 0.0 ? animation->mTicksPerSecond : DEFAULT_TICKS_PER_SECOND;
+		float duration = (float)(animation->mDuration / ticksPerSecond);
+		u32 jointCount = skeleton->getJointCount();
+
+		Rc<AnimationClip> clip = makeRc<AnimationClip>(animation->mName.C_Str(), duration, ANIMATION_SAMPLE_RATE, jointCount);
+
+		std::vector<aiNodeAnim*> channels(jointCount, nullptr);
+		for (u32 i = 0; i < animation->mNumChannels; i++)
+		{
+			i32 joint = skeleton->findJoint(animation->mChannels[i]->mNodeName.C_Str());
+			if (joint >= 0)
+				channels[joint] = animation->mChannels[i];
+		}
+
+		// Joints, or parts of them, without keys hold their bind pose
+		const Pose& bindPose = skeleton->getBindPose();
+		for (u32 joint = 0; joint < jointCount; joint++)
+		{
+			aiNodeAnim* channel = channels[joint];
+			u32 positionCursor = 0, rotationCursor = 0, scaleCursor = 0;
+
+			for (u32 frame = 0; frame < clip->getFrameCount(); frame++)
+			{
+				glm::vec3 translation = glm::vec3(bindPose.translations[joint]);
+				glm::vec4 rotation = bindPose.rotations[joint];
+				glm::vec3 scale = glm::vec3(bindPose.scales[joint]);
+
+				if (channel)
+				{
+					double time = std::min(frame / ANIMATION_SAMPLE_RATE, duration) * ticksPerSecond;
+
+					if (channel->mNumPositionKeys)
+						translation = sampleKeys(channel->mPositionKeys, channel->mNumPositionKeys, time, positionCursor);
+					if (channel->mNumRotationKeys)
+					{
+						glm::quat q = sampleKeys(channel->mRotationKeys, channel->mNumRotationKeys, time, rotationCursor);
+						rotation = glm::vec4(q.x, q.y, q.z, q.w);
+					}
+					if (channel->mNumScalingKeys)
+						scale = sampleKeys(channel->mScalingKeys, channel->mNumScalingKeys, time, scaleCursor);
+				}
+
+				clip->setKey(frame, joint, translation, rotation, scale);
 			}
 		}
 
-		materials.push_back(makeRc<DefaultMaterial>());
-		return makeRc<Mesh>(vertexData, indices);
+		return clip;
 	}
 
 	std::vector<Texture> Model::loadMaterialTextures(aiMaterial* mat, uint64_t type)
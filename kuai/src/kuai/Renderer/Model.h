@@ -3,6 +3,9 @@
 #include "Mesh.h"
 #include "Texture.h"
 
+#include "kuai/Animation/AnimationClip.h"
+#include "kuai/Animation/Skeleton.h"
+
 #define OPENDDL_STATIC_LIBARY
 
 // Forward Declarations
@@ -10,6 +13,7 @@ struct aiNode;
 struct aiScene;
 struct aiMesh;
 struct aiMaterial;
+struct aiAnimation;
 
 namespace kuai {
 	/** \class Model
@@ -20,8 +24,9 @@ namespace kuai {
 	public:
 		/**
 		* Load model from a 3D object file.
+		* @param lodCount Number of levels of detail to generate for each mesh (1 keeps only the original).
 		*/
-		Model(const std::string& filename);
+		Model(const std::string& filename, u32 lodCount = 1);
 		/**
 		* Create model by specifying a singlular mesh and (optional) material.
 		*/
@@ -39,15 +44,35 @@ namespace kuai {
 
 		void setMaterial(Rc<Material> material, u32 index) { materials[index] = material; }
 
+		/**
+		* The skeleton the model's skinned meshes are animated by, or null if none are.
+		*/
+		Rc<Skeleton> getSkeleton() const { return skeleton; }
+
+		/**
+		* Animations loaded with the model, made for its skeleton. Play them with an Animator.
+		*/
+		std::vector<Rc<AnimationClip>>& getAnimations() { return animations; }
+
+		/**
+		* The animation with the given name, or null if there isn't one.
+		*/
+		Rc<AnimationClip> getAnimation(const std::string& name) const;
+
 	private:
 		void processNode(aiNode* node, const aiScene* scene);
 		Rc<Mesh> processMesh(aiMesh* mesh, const aiScene* scene);
+		void processSkeleton(aiNode* node, i32 parent);
+		Rc<AnimationClip> processAnimation(aiAnimation* animation);
 		std::vector<Texture> loadMaterialTextures(aiMaterial* mat, uint64_t type);
 
 	private:
 		std::vector<Rc<Mesh>> meshes;
 		std::vector<Rc<Material>> materials;
 
+		Rc<Skeleton> skeleton;
+		std::vector<Rc<AnimationClip>> animations;
+
 		std::string directory;
 		std::unordered_map<std::string, Texture> loadedTexMap;
 	};
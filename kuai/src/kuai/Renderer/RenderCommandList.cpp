@@ -0,0 +1,143 @@
+#include "kpch.h"
+#include "RenderCommandList.h"
+
+#include "Renderer.h"
+#include "Material.h"
+
+#include <cstring>
+
+namespace kuai {
+	// Payloads are aligned so they can be read back in place as the types they were recorded as
+	static const u32 PAYLOAD_ALIGNMENT = 16;
+
+	void RenderCommandList::record(CommandType type, void* target, const void* payload, u32 size, u32 arg)
+	{
+		Command command;
+		command.type = type;
+		command.target = target;
+		command.dataOffset = (u32)((data.size() + PAYLOAD_ALIGNMENT - 1) & ~(size_t)(PAYLOAD_ALIGNMENT - 1));
+		command.dataSize = size;
+		command.arg = arg;
+
+		if (size)
+		{
+			data.resize(command.dataOffset + size);
+			std::memcpy(data.data() + command.dataOffset, payload, size);
+		}
+
+		commands.push_back(command);
+	}
+
+	void RenderCommandList::setVertexData(VertexBuffer* buffer, const void* data, u32 size)
+	{
+		record(CommandType::SET_VERTEX_DATA, buffer, data, size);
+	}
+
+	void RenderCommandList::resetVertexData(VertexBuffer* buffer, const void* data, u32 size)
+	{
+		record(CommandType::RESET_VERTEX_DATA, buffer, data, size);
+	}
+
+	void RenderCommandList::setIndexData(VertexArray* vertexArray, const u32* indices, u32 count)
+	{
+		record(CommandType::SET_INDEX_DATA, vertexArray, indices, count * sizeof(u32));
+	}
+
+	void RenderCommandList::setStorageData(StorageBuffer* buffer, const void* data, u32 size)
+	{
+		record(CommandType::SET_STORAGE_DATA, buffer, data, size);
+	}
+
+	void RenderCommandList::setIndirectCommands(Shader* shader, const IndirectCommand* commands, u32 count)
+	{
+		record(CommandType::SET_INDIRECT_COMMANDS, shader, commands, count * sizeof(IndirectCommand));
+	}
+
+	void RenderCommandList::setUniform(Shader* shader, const std::string& block, const std::string& member, const void* data, u32 size)
+	{
+		strings.push_back(block);
+		strings.push_back(member);
+		record(CommandType::SET_UNIFORM, shader, data, size, strings.size() - 2);
+	}
+
+	void RenderCommandList::bindShader(Shader* shader)
+	{
+		record(CommandType::BIND_SHADER, shader);
+	}
+
+	void RenderCommandList::bindMaterial(Material* material, u32 unit)
+	{
+		record(CommandType::BIND_MATERIAL, material, nullptr, 0, unit);
+	}
+
+	void RenderCommandList::draw(Shader* shader)
+	{
+		record(CommandType::DRAW, shader);
+	}
+
+	void RenderCommandList::clear()
+	{
+		record(CommandType::CLEAR, nullptr);
+	}
+
+	void RenderCommandList::callback(const std::function<void()>& fn)
+	{
+		callbacks.push_back(fn);
+		record(CommandType::CALL_FUNCTION, nullptr, nullptr, 0, callbacks.size() - 1);
+	}
+
+	void RenderCommandList::execute() const
+	{
+		KU_PROFILE_FUNCTION();
+
+		for (const Command& command : commands)
+		{
+			const u8* payload = data.data() + command.dataOffset;
+
+			switch (command.type)
+			{
+				case CommandType::SET_VERTEX_DATA:
+					static_cast<VertexBuffer*>(command.target)->setData(payload, command.dataSize);
+					break;
+				case CommandType::RESET_VERTEX_DATA:
+					static_cast<VertexBuffer*>(command.target)->reset(payload, command.dataSize, DrawHint::DYNAMIC);
+					break;
+				case CommandType::SET_INDEX_DATA:
+					static_cast<VertexArray*>(command.target)->setIndexBuffer(makeRc<IndexBuffer>((const u32*)payload, command.dataSize / sizeof(u32)));
+					break;
+				case CommandType::SET_STORAGE_DATA:
+					static_cast<StorageBuffer*>(command.target)->setData(payload, command.dataSize);
+					break;
+				case CommandType::SET_INDIRECT_COMMANDS:
+					static_cast<Shader*>(command.target)->setIndirectBufData((const IndirectCommand*)payload, command.dataSize / sizeof(IndirectCommand));
+					break;
+				case CommandType::SET_UNIFORM:
+					static_cast<Shader*>(command.target)->setUniform(strings[command.arg], strings[command.arg + 1], payload, command.dataSize);
+					break;
+				case CommandType::BIND_SHADER:
+					static_cast<Shader*>(command.target)->bind();
+					break;
+				case CommandType::BIND_MATERIAL:
+					static_cast<Material*>(command.target)->bind(command.arg);
+					break;
+				case CommandType::DRAW:
+					Renderer::render(*static_cast<Shader*>(command.target));
+					break;
+				case CommandType::CLEAR:
+					Renderer::clear();
+					break;
+				case CommandType::CALL_FUNCTION:
+					callbacks[command.arg]();
+					break;
+			}
+		}
+	}
+
+	void RenderCommandList::reset()
+	{
+		commands.clear();
+		data.clear();
+		strings.clear();
+		callbacks.clear();
+	}
+}
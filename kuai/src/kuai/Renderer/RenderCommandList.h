@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Buffer.h"
+
+namespace kuai {
+	// Forward declarations
+	class Shader;
+	class Material;
+
+	/** \class RenderCommandList
+	*	\brief A recording of rendering work that can be built on any thread and replayed later on the thread owning the GL context.
+	*
+	*	Commands act on engine objects rather than GL names, and any data they carry is copied into the list,
+	*	so recording never touches GL. Objects referenced by a list must outlive its replay.
+	*/
+	class RenderCommandList
+	{
+	public:
+		/**
+		* Overwrite the start of a vertex buffer; the data must fit its current size.
+		*/
+		void setVertexData(VertexBuffer* buffer, const void* data, u32 size);
+		/**
+		* Reallocate a vertex buffer to exactly fit the data.
+		*/
+		void resetVertexData(VertexBuffer* buffer, const void* data, u32 size);
+		/**
+		* Replace a vertex array's index buffer.
+		*/
+		void setIndexData(VertexArray* vertexArray, const u32* indices, u32 count);
+		void setStorageData(StorageBuffer* buffer, const void* data, u32 size);
+
+		void setIndirectCommands(Shader* shader, const IndirectCommand* commands, u32 count);
+		void setUniform(Shader* shader, const std::string& block, const std::string& member, const void* data, u32 size);
+
+		void bindShader(Shader* shader);
+		void bindMaterial(Material* material, u32 unit);
+
+		/**
+		* Draw all of a shader's indirect commands with the current camera.
+		*/
+		void draw(Shader* shader);
+		void clear();
+
+		/**
+		* Escape hatch for work that has no command of its own; runs on the replaying thread.
+		*/
+		void callback(const std::function<void()>& fn);
+
+		/**
+		* Replay every command in the order recorded. Must be called on the thread owning the GL context.
+		*/
+		void execute() const;
+		/**
+		* Remove all commands, keeping allocated memory for the next recording.
+		*/
+		void reset();
+
+		bool empty() const { return commands.empty(); }
+
+	private:
+		enum class CommandType : u8
+		{
+			SET_VERTEX_DATA, RESET_VERTEX_DATA, SET_INDEX_DATA, SET_STORAGE_DATA,
+			SET_INDIRECT_COMMANDS, SET_UNIFORM,
+			BIND_SHADER, BIND_MATERIAL,
+			DRAW, CLEAR, CALL_FUNCTION
+		};
+
+		struct Command
+		{
+			CommandType type;
+			void* target;		// Object the command acts on
+			u32 dataOffset;		// Copied payload, in data
+			u32 dataSize;
+			u32 arg;			// Texture unit, string index or callback index
+		};
+
+		void record(CommandType type, void* target, const void* payload = nullptr, u32 size = 0, u32 arg = 0);
+
+	private:
+		std::vector<Command> commands;
+		std::vector<u8> data;
+		std::vector<std::string> strings;
+		std::vector<std::function<void()>> callbacks;
+	};
+}
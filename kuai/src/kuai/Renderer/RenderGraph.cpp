@@ -0,0 +1,363 @@
+#include "kpch.h"
+#include "RenderGraph.h"
+
+#include "Renderer.h"
+#include "RenderState.h"
+
+#include "glad/glad.h"
+
+namespace kuai {
+	// Pooled framebuffers left unused for this many frames are freed
+	static const u32 MAX_UNUSED_FRAMES = 60;
+
+	static bool operator==(const FramebufferProps& a, const FramebufferProps& b)
+	{
+		return a.width == b.width && a.height == b.height && a.samples == b.samples && a.attachments == b.attachments;
+	}
+
+	// Builder ****************************************************************
+
+	RenderResource RenderGraph::Builder::create(const std::string& name, const FramebufferProps& props)
+	{
+		ResourceNode resource;
+		resource.name = name;
+		resource.props = props;
+		graph.resources.push_back(resource);
+
+		return graph.resources.size() - 1;
+	}
+
+	RenderResource RenderGraph::Builder::read(RenderResource resource)
+	{
+		KU_CORE_ASSERT(resource < graph.resources.size(), "Pass read an invalid render resource.");
+
+		graph.passes[pass].reads.push_back(resource);
+		graph.resources[resource].readerCount++;
+		return resource;
+	}
+
+	RenderResource RenderGraph::Builder::write(RenderResource resource, Access access)
+	{
+		KU_CORE_ASSERT(resource < graph.resources.size(), "Pass wrote to an invalid render resource.");
+
+		graph.passes[pass].writes.push_back(resource);
+		graph.passes[pass].writeAccess.push_back(access);
+		graph.resources[resource].writers.push_back(pass);
+		return resource;
+	}
+
+	// Context ****************************************************************
+
+	Framebuffer* RenderGraph::Context::getFramebuffer(RenderResource resource) const
+	{
+		return graph.resources[resource].framebuffer;
+	}
+
+	const FramebufferProps& RenderGraph::Context::getProps(RenderResource resource) const
+	{
+		return graph.resources[resource].props;
+	}
+
+	// Render Graph ***********************************************************
+
+	void RenderGraph::reset()
+	{
+		resources.clear();
+		passes.clear();
+		order.clear();
+	}
+
+	RenderResource RenderGraph::importBackbuffer(const std::string& name, u32 width, u32 height)
+	{
+		ResourceNode resource;
+		resource.name = name;
+		resource.props.width = width;
+		resource.props.height = height;
+		resource.imported = true;
+		resources.push_back(resource);
+
+		return resources.size() - 1;
+	}
+
+	RenderResource RenderGraph::importFramebuffer(const std::string& name, Framebuffer* framebuffer)
+	{
+		ResourceNode resource;
+		resource.name = name;
+		resource.props.width = framebuffer->getWidth();
+		resource.props.height = framebuffer->getHeight();
+		resource.imported = true;
+		resource.framebuffer = framebuffer;
+		resources.push_back(resource);
+
+		return resources.size() - 1;
+	}
+
+	void RenderGraph::addPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute)
+	{
+		PassNode pass;
+		pass.name = name;
+		pass.execute = execute;
+		passes.push_back(pass);
+
+		Builder builder(*this, passes.size() - 1);
+		setup(builder);
+	}
+
+	RenderResource RenderGraph::getResource(const std::string& name) const
+	{
+		for (size_t i = resources.size(); i > 0; i--)
+		{
+			if (resources[i - 1].name == name)
+				return i - 1;
+		}
+		return INVALID_RENDER_RESOURCE;
+	}
+
+	void RenderGraph::compile()
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Cull: a pass is needed while something reads one of its outputs. Imported resources are read outside the graph.
+		std::vector<RenderResource> unread;
+		for (size_t i = 0; i < resources.size(); i++)
+		{
+			if (resources[i].imported)
+				resources[i].readerCount++;
+
+			if (resources[i].readerCount == 0)
+				unread.push_back(i);
+		}
+
+		auto cullPass = [this, &unread](PassNode& pass)
+		{
+			pass.culled = true;
+			for (RenderResource r : pass.reads)
+			{
+				if (--resources[r].readerCount == 0)
+					unread.push_back(r);
+			}
+		};
+
+		for (auto& pass : passes)
+		{
+			pass.refCount = pass.writes.size();
+			if (pass.refCount == 0 && !pass.sideEffect)
+				cullPass(pass);
+		}
+
+		while (!unread.empty())
+		{
+			RenderResource r = unread.back();
+			unread.pop_back();
+
+			for (u32 writer : resources[r].writers)
+			{
+				PassNode& pass = passes[writer];
+				if (!pass.culled && !pass.sideEffect && --pass.refCount == 0)
+					cullPass(pass);
+			}
+		}
+
+		// A pass depends on every earlier pass that writes what it reads, or touches what it writes
+		std::vector<std::vector<u32>> dependents(passes.size());
+		std::vector<u32> dependencyCount(passes.size(), 0);
+		auto touches = [](const PassNode& pass, RenderResource r)
+		{
+			return std::find(pass.reads.begin(), pass.reads.end(), r) != pass.reads.end()
+				|| std::find(pass.writes.begin(), pass.writes.end(), r) != pass.writes.end();
+		};
+
+		for (u32 j = 0; j < passes.size(); j++)
+		{
+			if (passes[j].culled)
+				continue;
+
+			for (u32 i = 0; i < j; i++)
+			{
+				if (passes[i].culled)
+					continue;
+
+				bool dependent = false;
+				for (RenderResource r : passes[j].reads)
+					dependent |= std::find(passes[i].writes.begin(), passes[i].writes.end(), r) != passes[i].writes.end();
+				for (RenderResource r : passes[j].writes)
+					dependent |= touches(passes[i], r);
+
+				if (dependent)
+				{
+					dependents[i].push_back(j);
+					dependencyCount[j]++;
+				}
+			}
+		}
+
+		// Topological sort. Of the passes that are ready, prefer one drawing to the same target as the last pass to save framebuffer switches.
+		std::vector<u32> ready;
+		for (u32 i = 0; i < passes.size(); i++)
+		{
+			if (!passes[i].culled && dependencyCount[i] == 0)
+				ready.push_back(i);
+		}
+
+		RenderResource lastTarget = INVALID_RENDER_RESOURCE;
+		while (!ready.empty())
+		{
+			auto next = std::min_element(ready.begin(), ready.end());
+			for (auto it = ready.begin(); it != ready.end(); it++)
+			{
+				const PassNode& pass = passes[*it];
+				if (!pass.writes.empty() && pass.writes[0] == lastTarget)
+				{
+					next = it;
+					break;
+				}
+			}
+
+			u32 index = *next;
+			ready.erase(next);
+			order.push_back(index);
+
+			if (!passes[index].writes.empty())
+				lastTarget = passes[index].writes[0];
+
+			for (u32 dependent : dependents[index])
+			{
+				if (--dependencyCount[dependent] == 0)
+					ready.push_back(dependent);
+			}
+		}
+
+		// Lifetimes of transient resources, used to hand their framebuffers to later passes once they're finished with
+		for (u32 i = 0; i < order.size(); i++)
+		{
+			const PassNode& pass = passes[order[i]];
+			auto use = [this, i](RenderResource r)
+			{
+				resources[r].firstUse = std::min(resources[r].firstUse, i);
+				resources[r].lastUse = std::max(resources[r].lastUse, i);
+			};
+
+			std::for_each(pass.reads.begin(), pass.reads.end(), use);
+			std::for_each(pass.writes.begin(), pass.writes.end(), use);
+		}
+	}
+
+	void RenderGraph::execute()
+	{
+		KU_PROFILE_FUNCTION();
+
+		Context context(*this);
+
+		for (u32 i = 0; i < order.size(); i++)
+		{
+			PassNode& pass = passes[order[i]];
+
+			for (RenderResource r : pass.writes)
+			{
+				if (!resources[r].imported && resources[r].firstUse == i)
+					resources[r].framebuffer = acquireFramebuffer(resources[r].props);
+			}
+			for (RenderResource r : pass.reads)
+			{
+				if (!resources[r].imported && resources[r].firstUse == i)
+					resources[r].framebuffer = acquireFramebuffer(resources[r].props);
+			}
+
+			// Attachment writes are visible to later passes without help; only storage writes need a barrier
+			bool needsBarrier = false;
+			for (RenderResource r : pass.reads)
+				needsBarrier |= resources[r].pendingStorageWrite;
+
+			if (needsBarrier)
+			{
+				glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+				for (auto& resource : resources)
+					resource.pendingStorageWrite = false;
+			}
+
+			// Render to the pass's first attachment
+			for (size_t w = 0; w < pass.writes.size(); w++)
+			{
+				if (pass.writeAccess[w] != Access::ATTACHMENT)
+					continue;
+
+				ResourceNode& target = resources[pass.writes[w]];
+				if (target.framebuffer)
+					target.framebuffer->bind();
+				else
+					RenderState::bindFramebuffer(0);
+
+				Renderer::setViewport(0, 0, target.props.width, target.props.height);
+				break;
+			}
+
+			pass.execute(context);
+
+			for (size_t w = 0; w < pass.writes.size(); w++)
+			{
+				if (pass.writeAccess[w] == Access::STORAGE)
+					resources[pass.writes[w]].pendingStorageWrite = true;
+			}
+
+			// Hand back transient framebuffers this was the last user of
+			for (RenderResource r : pass.writes)
+			{
+				if (!resources[r].imported && resources[r].lastUse == i && resources[r].framebuffer)
+				{
+					releaseFramebuffer(resources[r].framebuffer);
+					resources[r].framebuffer = nullptr;
+				}
+			}
+			for (RenderResource r : pass.reads)
+			{
+				if (!resources[r].imported && resources[r].lastUse == i && resources[r].framebuffer)
+				{
+					releaseFramebuffer(resources[r].framebuffer);
+					resources[r].framebuffer = nullptr;
+				}
+			}
+		}
+
+		RenderState::bindFramebuffer(0);
+
+		// Free framebuffers that haven't been needed for a while
+		for (auto& pooled : pool)
+		{
+			pooled.unusedFrames++;
+		}
+		pool.erase(std::remove_if(pool.begin(), pool.end(), [](const PooledFramebuffer& pooled) { return pooled.unusedFrames > MAX_UNUSED_FRAMES; }), pool.end());
+	}
+
+	Framebuffer* RenderGraph::acquireFramebuffer(const FramebufferProps& props)
+	{
+		for (auto& pooled : pool)
+		{
+			if (!pooled.inUse && pooled.props == props)
+			{
+				pooled.inUse = true;
+				pooled.unusedFrames = 0;
+				return pooled.framebuffer.get();
+			}
+		}
+
+		PooledFramebuffer pooled;
+		pooled.framebuffer = makeBox<Framebuffer>(props.width, props.height, props.samples, props.attachments);
+		pooled.props = props;
+		pooled.inUse = true;
+		pool.push_back(std::move(pooled));
+
+		return pool.back().framebuffer.get();
+	}
+
+	void RenderGraph::releaseFramebuffer(Framebuffer* framebuffer)
+	{
+		for (auto& pooled : pool)
+		{
+			if (pooled.framebuffer.get() == framebuffer)
+			{
+				pooled.inUse = false;
+				return;
+			}
+		}
+	}
+}
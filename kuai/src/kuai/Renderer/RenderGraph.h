@@ -0,0 +1,171 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+namespace kuai {
+	/**
+	* Handle to a render target declared in a RenderGraph; only valid for the frame it was declared in.
+	*/
+	using RenderResource = u32;
+
+	const RenderResource INVALID_RENDER_RESOURCE = ~0u;
+
+	/** \class RenderGraph
+	*	\brief Describes a frame as passes that read and write render targets.
+	*
+	*	Passes declare what they read and write up front. Compiling the graph orders the passes by their
+	*	dependencies, culls passes whose output is never used, and assigns transient targets framebuffers
+	*	from a pool, so targets with non-overlapping lifetimes share the same memory. Memory barriers are
+	*	only issued where a pass reads something an earlier pass wrote through image or storage access.
+	*/
+	class RenderGraph
+	{
+	public:
+		/**
+		* How a pass accesses a resource it writes to.
+		*/
+		enum class Access
+		{
+			ATTACHMENT,	// Rendered to as the pass's framebuffer
+			STORAGE		// Written by image load/store or storage buffers, needs a barrier before being read
+		};
+
+		/**
+		* Passed to a pass's setup function to declare its resources.
+		*/
+		class Builder
+		{
+		public:
+			/**
+			* Declare a new transient target, owned by the graph for the lifetime of its readers.
+			*/
+			RenderResource create(const std::string& name, const FramebufferProps& props);
+			RenderResource read(RenderResource resource);
+			RenderResource write(RenderResource resource, Access access = Access::ATTACHMENT);
+
+			/**
+			* Keep the pass even if nothing reads what it writes, e.g. it has effects outside the graph.
+			*/
+			void setSideEffect() { graph.passes[pass].sideEffect = true; }
+
+		private:
+			Builder(RenderGraph& graph, u32 pass) : graph(graph), pass(pass) {}
+
+			RenderGraph& graph;
+			u32 pass;
+
+			friend class RenderGraph;
+		};
+
+		/**
+		* Passed to a pass when it executes, to look up the framebuffers behind its resources.
+		*/
+		class Context
+		{
+		public:
+			/**
+			* Returns the framebuffer behind a resource, or nullptr for the backbuffer.
+			*/
+			Framebuffer* getFramebuffer(RenderResource resource) const;
+			const FramebufferProps& getProps(RenderResource resource) const;
+
+		private:
+			Context(RenderGraph& graph) : graph(graph) {}
+
+			RenderGraph& graph;
+
+			friend class RenderGraph;
+		};
+
+		using SetupFn = std::function<void(Builder&)>;
+		using ExecuteFn = std::function<void(Context&)>;
+
+	public:
+		RenderGraph() = default;
+
+		/**
+		* Remove all passes and resources ready to describe the next frame. Pooled framebuffers are kept.
+		*/
+		void reset();
+
+		/**
+		* Import the window's default framebuffer. Writes to it are always kept.
+		*/
+		RenderResource importBackbuffer(const std::string& name, u32 width, u32 height);
+		/**
+		* Import a framebuffer owned outside the graph. Writes to it are always kept.
+		*/
+		RenderResource importFramebuffer(const std::string& name, Framebuffer* framebuffer);
+
+		/**
+		* Add a pass. Setup runs immediately to declare resources; execute runs later, and only if the pass survives culling.
+		*/
+		void addPass(const std::string& name, const SetupFn& setup, const ExecuteFn& execute);
+
+		/**
+		* Returns the most recently declared resource with a name, or INVALID_RENDER_RESOURCE.
+		*/
+		RenderResource getResource(const std::string& name) const;
+
+		/**
+		* Order passes, cull unused ones and plan framebuffer aliasing.
+		*/
+		void compile();
+		/**
+		* Run the compiled passes.
+		*/
+		void execute();
+
+		u32 getPooledFramebufferCount() const { return pool.size(); }
+
+	private:
+		struct ResourceNode
+		{
+			std::string name;
+			FramebufferProps props;
+
+			bool imported = false;
+			Framebuffer* framebuffer = nullptr;	// nullptr and imported for the backbuffer
+
+			std::vector<u32> writers;
+			u32 readerCount = 0;	// Live readers, used while culling
+
+			u32 firstUse = ~0u;		// Positions in the execution order
+			u32 lastUse = 0;
+
+			bool pendingStorageWrite = false;
+		};
+
+		struct PassNode
+		{
+			std::string name;
+			ExecuteFn execute;
+
+			std::vector<RenderResource> reads;
+			std::vector<RenderResource> writes;
+			std::vector<Access> writeAccess;
+
+			bool sideEffect = false;
+			bool culled = false;
+			u32 refCount = 0;
+		};
+
+		struct PooledFramebuffer
+		{
+			Box<Framebuffer> framebuffer;
+			FramebufferProps props;
+			bool inUse = false;
+			u32 unusedFrames = 0;
+		};
+
+		Framebuffer* acquireFramebuffer(const FramebufferProps& props);
+		void releaseFramebuffer(Framebuffer* framebuffer);
+
+	private:
+		std::vector<ResourceNode> resources;
+		std::vector<PassNode> passes;
+		std::vector<u32> order;		// Indices of passes that survived culling, in execution order
+
+		std::vector<PooledFramebuffer> pool;
+	};
+}
@@ -0,0 +1,264 @@
+#include "kpch.h"
+#include "RenderState.h"
+
+#include "glad/glad.h"
+
+namespace kuai {
+	static const u32 UNKNOWN = ~0u;
+
+	static const u32 MAX_TEXTURE_UNITS = 32;
+	static const u32 TEXTURE_TARGET_COUNT = 4;
+
+	struct StateCache
+	{
+		u32 program;
+		u32 vertexArray;
+		u32 framebuffer;
+		u32 activeUnit;
+
+		std::unordered_map<u32, u32> buffers;			// Target -> buffer
+		std::unordered_map<u64, u32> indexedBuffers;	// (Target, index) -> buffer
+		u32 textures[MAX_TEXTURE_UNITS][TEXTURE_TARGET_COUNT];
+
+		std::unordered_map<u32, bool> caps;
+		u32 blendSrc, blendDst;
+		u32 depthFunc;
+		u32 cullFace;
+		i32 viewport[4];
+
+		StateCache() { reset(); }
+
+		void reset()
+		{
+			program = vertexArray = framebuffer = activeUnit = UNKNOWN;
+			buffers.clear();
+			indexedBuffers.clear();
+			std::fill(&textures[0][0], &textures[0][0] + MAX_TEXTURE_UNITS * TEXTURE_TARGET_COUNT, UNKNOWN);
+			caps.clear();
+			blendSrc = blendDst = depthFunc = cullFace = UNKNOWN;
+			std::fill(viewport, viewport + 4, -1);
+		}
+	};
+
+	static StateCache cache;
+	static RenderState::Stats frameStats;
+	static RenderState::Stats lastFrameStats;
+
+	// Returns true, and records the new value, if GL needs to be told about it
+	template<typename T>
+	static bool changed(T& cached, T value)
+	{
+		if (cached == value)
+		{
+			frameStats.skipped++;
+			return false;
+		}
+
+		cached = value;
+		frameStats.issued++;
+		return true;
+	}
+
+	static u32& cachedBuffer(u32 target)
+	{
+		return cache.buffers.emplace(target, UNKNOWN).first->second;
+	}
+
+	static i32 textureTargetIndex(u32 target)
+	{
+		switch (target)
+		{
+			case GL_TEXTURE_2D:				return 0;
+			case GL_TEXTURE_2D_ARRAY:		return 1;
+			case GL_TEXTURE_CUBE_MAP:		return 2;
+			case GL_TEXTURE_2D_MULTISAMPLE:	return 3;
+		}
+		return -1;
+	}
+
+	void RenderState::useProgram(u32 program)
+	{
+		if (changed(cache.program, program))
+			glUseProgram(program);
+	}
+
+	void RenderState::bindVertexArray(u32 vertexArray)
+	{
+		if (changed(cache.vertexArray, vertexArray))
+		{
+			glBindVertexArray(vertexArray);
+			cachedBuffer(GL_ELEMENT_ARRAY_BUFFER) = UNKNOWN; // Element array binding belongs to the vertex array
+		}
+	}
+
+	void RenderState::bindBuffer(u32 target, u32 buffer)
+	{
+		if (changed(cachedBuffer(target), buffer))
+			glBindBuffer(target, buffer);
+	}
+
+	void RenderState::bindBufferBase(u32 target, u32 index, u32 buffer)
+	{
+		u32& cached = cache.indexedBuffers.emplace(((u64)target << 32) | index, UNKNOWN).first->second;
+		if (changed(cached, buffer))
+		{
+			glBindBufferBase(target, index, buffer);
+			cachedBuffer(target) = buffer; // Also binds the generic binding point
+		}
+	}
+
+	void RenderState::bindTexture(u32 unit, u32 target, u32 texture)
+	{
+		i32 targetIndex = textureTargetIndex(target);
+		if (unit >= MAX_TEXTURE_UNITS || targetIndex < 0) // Untracked, so always issue
+		{
+			frameStats.issued += 2;
+			cache.activeUnit = unit;
+			glActiveTexture(GL_TEXTURE0 + unit);
+			glBindTexture(target, texture);
+			return;
+		}
+
+		if (cache.textures[unit][targetIndex] == texture)
+		{
+			frameStats.skipped++;
+			return;
+		}
+
+		if (changed(cache.activeUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+
+		cache.textures[unit][targetIndex] = texture;
+		frameStats.issued++;
+		glBindTexture(target, texture);
+	}
+
+	void RenderState::bindFramebuffer(u32 framebuffer)
+	{
+		if (changed(cache.framebuffer, framebuffer))
+			glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+	}
+
+	void RenderState::setEnabled(u32 cap, bool enabled)
+	{
+		auto it = cache.caps.find(cap);
+		if (it != cache.caps.end() && it->second == enabled)
+		{
+			frameStats.skipped++;
+			return;
+		}
+
+		cache.caps[cap] = enabled;
+		frameStats.issued++;
+		if (enabled)
+			glEnable(cap);
+		else
+			glDisable(cap);
+	}
+
+	void RenderState::setBlendFunc(u32 src, u32 dst)
+	{
+		if (cache.blendSrc == src && cache.blendDst == dst)
+		{
+			frameStats.skipped++;
+			return;
+		}
+
+		cache.blendSrc = src;
+		cache.blendDst = dst;
+		frameStats.issued++;
+		glBlendFunc(src, dst);
+	}
+
+	void RenderState::setDepthFunc(u32 func)
+	{
+		if (changed(cache.depthFunc, func))
+			glDepthFunc(func);
+	}
+
+	void RenderState::setCullFace(u32 face)
+	{
+		if (changed(cache.cullFace, face))
+			glCullFace(face);
+	}
+
+	void RenderState::setViewport(i32 x, i32 y, u32 width, u32 height)
+	{
+		i32* v = cache.viewport;
+		if (v[0] == x && v[1] == y && v[2] == (i32)width && v[3] == (i32)height)
+		{
+			frameStats.skipped++;
+			return;
+		}
+
+		v[0] = x;
+		v[1] = y;
+		v[2] = width;
+		v[3] = height;
+		frameStats.issued++;
+		glViewport(x, y, width, height);
+	}
+
+	void RenderState::onDeleteProgram(u32 program)
+	{
+		if (cache.program == program)
+			cache.program = UNKNOWN;
+	}
+
+	void RenderState::onDeleteVertexArray(u32 vertexArray)
+	{
+		if (cache.vertexArray == vertexArray)
+		{
+			cache.vertexArray = UNKNOWN;
+			cachedBuffer(GL_ELEMENT_ARRAY_BUFFER) = UNKNOWN;
+		}
+	}
+
+	void RenderState::onDeleteBuffer(u32 buffer)
+	{
+		for (auto& pair : cache.buffers)
+		{
+			if (pair.second == buffer)
+				pair.second = UNKNOWN;
+		}
+		for (auto& pair : cache.indexedBuffers)
+		{
+			if (pair.second == buffer)
+				pair.second = UNKNOWN;
+		}
+	}
+
+	void RenderState::onDeleteTexture(u32 texture)
+	{
+		for (u32 unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+		{
+			for (u32 target = 0; target < TEXTURE_TARGET_COUNT; target++)
+			{
+				if (cache.textures[unit][target] == texture)
+					cache.textures[unit][target] = UNKNOWN;
+			}
+		}
+	}
+
+	void RenderState::onDeleteFramebuffer(u32 framebuffer)
+	{
+		if (cache.framebuffer == framebuffer)
+			cache.framebuffer = UNKNOWN;
+	}
+
+	void RenderState::invalidate()
+	{
+		cache.reset();
+	}
+
+	void RenderState::endFrame()
+	{
+		lastFrameStats = frameStats;
+		frameStats = Stats();
+	}
+
+	const RenderState::Stats& RenderState::getStats()
+	{
+		return lastFrameStats;
+	}
+}
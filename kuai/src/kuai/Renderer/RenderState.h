@@ -0,0 +1,56 @@
+#pragma once
+
+// @cond
+namespace kuai {
+	/**
+	* Mirrors the GL state the engine touches so redundant binds and state changes are never sent to the driver.
+	* All renderer code binds through here; anything calling GL directly must call invalidate() afterwards.
+	* Enums are the plain GL values.
+	*/
+	class RenderState
+	{
+	public:
+		struct Stats
+		{
+			u32 issued = 0;		// State changes sent to GL
+			u32 skipped = 0;	// State changes dropped because GL was already in that state
+		};
+
+		static void useProgram(u32 program);
+		static void bindVertexArray(u32 vertexArray);
+		static void bindBuffer(u32 target, u32 buffer);
+		static void bindBufferBase(u32 target, u32 index, u32 buffer);
+		static void bindTexture(u32 unit, u32 target, u32 texture);
+		static void bindFramebuffer(u32 framebuffer);
+
+		static void setEnabled(u32 cap, bool enabled);
+		static void setBlendFunc(u32 src, u32 dst);
+		static void setDepthFunc(u32 func);
+		static void setCullFace(u32 face);
+		static void setViewport(i32 x, i32 y, u32 width, u32 height);
+
+		/**
+		* GL unbinds objects when they are deleted, and may hand their names out again, so forget them.
+		*/
+		static void onDeleteProgram(u32 program);
+		static void onDeleteVertexArray(u32 vertexArray);
+		static void onDeleteBuffer(u32 buffer);
+		static void onDeleteTexture(u32 texture);
+		static void onDeleteFramebuffer(u32 framebuffer);
+
+		/**
+		* Forget everything, so the next call of each kind is always issued.
+		*/
+		static void invalidate();
+
+		/**
+		* Finish counting this frame's state changes.
+		*/
+		static void endFrame();
+		/**
+		* Returns the counts for the last completed frame.
+		*/
+		static const Stats& getStats();
+	};
+}
+// @endcond
@@ -0,0 +1,94 @@
+#include "kpch.h"
+#include "RenderThread.h"
+
+#include "kuai/Core/Window.h"
+
+namespace kuai {
+	RenderThread::~RenderThread()
+	{
+		stop();
+	}
+
+	void RenderThread::start(Window* window)
+	{
+		if (running)
+			return;
+
+		this->window = window;
+		quit = false;
+		running = true;
+
+		window->makeContextCurrent(false);
+		thread = std::thread(&RenderThread::loop, this);
+
+		KU_CORE_INFO("Started render thread");
+	}
+
+	void RenderThread::stop()
+	{
+		if (!running)
+			return;
+
+		waitIdle();
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			quit = true;
+		}
+		cond.notify_all();
+		thread.join();
+
+		running = false;
+		window->makeContextCurrent(true);
+	}
+
+	void RenderThread::submit(const FrameFn& frame)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return !busy; });
+
+		pending = frame;
+		busy = true;
+		lock.unlock();
+		cond.notify_all();
+	}
+
+	void RenderThread::waitIdle()
+	{
+		if (!running)
+			return;
+
+		KU_PROFILE_FUNCTION();
+
+		std::unique_lock<std::mutex> lock(mutex);
+		cond.wait(lock, [this]() { return !busy; });
+	}
+
+	void RenderThread::loop()
+	{
+		window->makeContextCurrent(true);
+
+		while (true)
+		{
+			FrameFn frame;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				cond.wait(lock, [this]() { return busy || quit; });
+
+				if (quit && !busy)
+					break;
+
+				frame = std::move(pending);
+			}
+
+			frame();
+
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				busy = false;
+			}
+			cond.notify_all();
+		}
+
+		window->makeContextCurrent(false);
+	}
+}
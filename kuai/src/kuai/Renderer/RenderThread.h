@@ -0,0 +1,57 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// @cond
+namespace kuai {
+	// Forward declaration
+	class Window;
+
+	/**
+	* Thread that owns a window's GL context and runs one frame of rendering work at a time,
+	* so the main thread can simulate the next frame while the last one is submitted.
+	*/
+	class RenderThread
+	{
+	public:
+		using FrameFn = std::function<void()>;
+
+		~RenderThread();
+
+		/**
+		* Take the window's context from the calling thread and start rendering on a new thread.
+		*/
+		void start(Window* window);
+		/**
+		* Finish the frame in flight, stop the thread and give the context back to the calling thread.
+		*/
+		void stop();
+
+		bool isRunning() const { return running; }
+
+		/**
+		* Hand a frame to the render thread. Waits for the previous frame first, so at most one frame is in flight.
+		*/
+		void submit(const FrameFn& frame);
+		/**
+		* Block until the render thread has finished its frame. Returns immediately if it isn't running.
+		*/
+		void waitIdle();
+
+	private:
+		void loop();
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable cond;
+
+		Window* window = nullptr;
+		FrameFn pending;
+		bool busy = false;
+		bool quit = false;
+		bool running = false;
+	};
+}
+// @endcond
@@ -2,33 +2,51 @@
 
 #include "Renderer.h"
 #include "Shader.h"
+#include "RenderState.h"
 
 #include "glad/glad.h"
 
 #include "glm/gtc/matrix_inverse.hpp"
 #include "glm/gtx/string_cast.hpp"
 
+#include <mutex>
+
 namespace kuai {
     Box<Renderer::RenderData> Renderer::renderData = std::make_unique<Renderer::RenderData>();
+    Box<LightClusters> Renderer::lightClusters = nullptr;
+
+    Box<StorageBuffer> Renderer::boneBuf = nullptr;
+    std::vector<glm::mat4> Renderer::bonePalettes;
+    bool Renderer::bonePalettesChanged = false;
+
+    static std::vector<RenderCommandList> submittedLists;	// Recording, for the frame being simulated
+    static std::vector<RenderCommandList> closedLists;		// Closed, for the next flush
+    static std::mutex submitMutex;
 
     void Renderer::init()
     {
-        glEnable(GL_DEPTH_TEST);
-        glDepthFunc(GL_LESS);
+        RenderState::setEnabled(GL_DEPTH_TEST, true);
+        RenderState::setDepthFunc(GL_LESS);
 
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_BACK);
+        RenderState::setEnabled(GL_CULL_FACE, true);
+        RenderState::setCullFace(GL_BACK);
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        RenderState::setEnabled(GL_BLEND, true);
+        RenderState::setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-        glEnable(GL_FRAMEBUFFER_SRGB); // TODO: IMPLEMENT THIS MANUALLY IN SHADER AND TEXTURES
+        RenderState::setEnabled(GL_FRAMEBUFFER_SRGB, true); // TODO: IMPLEMENT THIS MANUALLY IN SHADER AND TEXTURES
 
         Shader::init();
+
+        lightClusters = makeBox<LightClusters>();
+        boneBuf = makeBox<StorageBuffer>(4);
     }
 
     void Renderer::cleanup()
     {
+        lightClusters.reset();
+        boneBuf.reset();
+
         Shader::cleanup();
     }
 
@@ -36,6 +54,31 @@ namespace kuai {
     {
         renderData->projMatrix = camera.getProjectionMatrix();
         renderData->viewMatrix = camera.getViewMatrix();
+
+        // Cameras rendering to a framebuffer use its size rather than the window's
+        Framebuffer* target = camera.getTarget();
+        u32 width = target ? target->getWidth() : renderData->viewportWidth;
+        u32 height = target ? target->getHeight() : renderData->viewportHeight;
+
+        lightClusters->build(camera, width, height);
+
+        // Every camera draws the same poses, so they're uploaded once per frame
+        if (bonePalettesChanged)
+        {
+            boneBuf->setData(bonePalettes.data(), bonePalettes.size() * sizeof(glm::mat4));
+            bonePalettesChanged = false;
+        }
+    }
+
+    void Renderer::setLights(const std::vector<GpuLight>& lights, u32 dirLightCount)
+    {
+        lightClusters->setLights(lights, dirLightCount);
+    }
+
+    void Renderer::setBonePalettes(const std::vector<glm::mat4>& palettes)
+    {
+        bonePalettes = palettes;
+        bonePalettesChanged = true;
     }
 
     void Renderer::render(Shader& shader)
@@ -48,9 +91,45 @@ namespace kuai {
         glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, shader.getCommandCount(), sizeof(IndirectCommand));
     }
 
+    void Renderer::submit(RenderCommandList&& list)
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        submittedLists.push_back(std::move(list));
+    }
+
+    void Renderer::closeFrame()
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+
+        // Appended rather than swapped, in case the last closed frame hasn't been flushed yet
+        for (auto& list : submittedLists)
+        {
+            closedLists.push_back(std::move(list));
+        }
+        submittedLists.clear();
+    }
+
+    void Renderer::flush()
+    {
+        KU_PROFILE_FUNCTION();
+
+        std::vector<RenderCommandList> lists;
+        {
+            std::lock_guard<std::mutex> lock(submitMutex);
+            lists.swap(closedLists);
+        }
+
+        for (auto& list : lists)
+        {
+            list.execute();
+        }
+    }
+
     void Renderer::setViewport(u32 x, u32 y, u32 width, u32 height)
     {
-        glViewport(x, y, width, height);
+        renderData->viewportWidth = width;
+        renderData->viewportHeight = height;
+        RenderState::setViewport(x, y, width, height);
     }
 
     void Renderer::setClearCol(const glm::vec4& col)
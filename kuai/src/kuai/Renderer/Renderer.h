@@ -2,6 +2,9 @@
 
 #include "kuai/Components/Components.h"
 
+#include "LightClusters.h"
+#include "RenderCommandList.h"
+
 #include "glm/glm.hpp"
 
 namespace kuai {
@@ -13,8 +16,38 @@ namespace kuai {
 		
 		static void setCamera(Camera& camera);
 
+		static const glm::mat4& getViewMatrix() { return renderData->viewMatrix; }
+		static const glm::mat4& getProjMatrix() { return renderData->projMatrix; }
+
+		/**
+		* Set the lights used by subsequent frames; directional lights must be at the front of the list.
+		*/
+		static void setLights(const std::vector<GpuLight>& lights, u32 dirLightCount);
+
+		/**
+		* Set the joint matrices skinned meshes are drawn with in subsequent frames. Each animated instance reads its own
+		* range, starting at the offset kept in its model matrix.
+		*/
+		static void setBonePalettes(const std::vector<glm::mat4>& palettes);
+
 		static void render(Shader& shader);
 
+		/**
+		* Queue a command list recorded on any thread. Lists are replayed by the flush() after the next closeFrame(), in the order submitted.
+		*/
+		static void submit(RenderCommandList&& list);
+
+		/**
+		* Hand every list submitted so far to the next flush(). Lists submitted later, e.g. while the next frame
+		* is simulated alongside this one rendering, wait for the flush after. Main thread, once a frame.
+		*/
+		static void closeFrame();
+
+		/**
+		* Replay the lists of every closed frame not yet flushed. On whichever thread owns the context.
+		*/
+		static void flush();
+
 		static void setViewport(u32 x, u32 y, u32 width, u32 height);
 		static void setClearCol(const glm::vec4& col);
 		static void clear();
@@ -24,9 +57,17 @@ namespace kuai {
 		{
 			glm::mat4 projMatrix;
 			glm::mat4 viewMatrix;
+
+			u32 viewportWidth = 0;
+			u32 viewportHeight = 0;
 		};
 
 		static Box<RenderData> renderData;
+		static Box<LightClusters> lightClusters;
+
+		static Box<StorageBuffer> boneBuf;
+		static std::vector<glm::mat4> bonePalettes;
+		static bool bonePalettesChanged;
 	};
 }
 
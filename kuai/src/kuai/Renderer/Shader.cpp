@@ -1,10 +1,14 @@
 #include "kpch.h"
 #include "Shader.h"
 
+#include "RenderState.h"
+
 #include <glad/glad.h>
 
 namespace kuai {
 	Shader* Shader::base = nullptr;
+	Shader* Shader::baseCompact = nullptr;
+	Shader* Shader::skinned = nullptr;
 	Shader* Shader::sprite = nullptr;
 
 	std::unordered_map<std::string, u32> Shader::ubos = std::unordered_map<std::string, u32>();
@@ -26,10 +30,16 @@ namespace kuai {
 		unbind();
 		
 		for (auto& pair : ubos)
+		{
+			RenderState::onDeleteBuffer(pair.second);
 			glDeleteBuffers(1, &pair.second);
+		}
 
 		if (programId)
+		{
+			RenderState::onDeleteProgram(programId);
 			glDeleteProgram(programId);
+		}
 	}
 
 	void Shader::createUniform(const std::string& name)
@@ -96,10 +106,9 @@ namespace kuai {
 
 		// Create uniform buffer object
 		u32 ubo;
-		glGenBuffers(1, &ubo);
-		glBindBuffer(GL_UNIFORM_BUFFER, ubo);
-		glBufferData(GL_UNIFORM_BUFFER, blockSize, nullptr, GL_STATIC_DRAW);
-		glBindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
+		glCreateBuffers(1, &ubo);
+		glNamedBufferData(ubo, blockSize, nullptr, GL_STATIC_DRAW);
+		RenderState::bindBufferBase(GL_UNIFORM_BUFFER, binding, ubo);
 
 		ubos[name] = ubo;
 	}
@@ -121,26 +130,30 @@ namespace kuai {
 
 	void Shader::setIndirectBufData(const std::vector<IndirectCommand>& commands)
 	{
-		ibo = makeBox<IndirectBuffer>(commands);
+		ibo->setData(commands);
+		ibo->bind();
+	}
+
+	void Shader::setIndirectBufData(const IndirectCommand* commands, u32 count)
+	{
+		ibo->setData(commands, count);
 		ibo->bind();
 	}
 
 	void Shader::bind() const
 	{
-		glUseProgram(programId);
+		RenderState::useProgram(programId);
 		vao->bind();
 		ibo->bind();
 	}
 
 	void Shader::unbind() const
 	{
-		glUseProgram(0);
+		RenderState::useProgram(0);
 	}
 
-	void Shader::init()
-	{
-		base = new Shader(
-		R"(
+	// Vertex attributes for each vertex format. Each provides getPos() and getNormal() to the base vertex shader.
+	static const char* fullVertexInputs = R"(
 		#version 450
 
 		layout (location = 0)	in vec3 aPos;
@@ -148,6 +161,70 @@ namespace kuai {
 		layout (location = 2)	in vec2 aTexCoord;
 		layout (location = 3)	in mat4 aModelMatrix;
 
+		vec3 getPos() { return aPos; }
+		vec3 getNormal() { return aNormal; }
+		)";
+
+	static const char* compactVertexInputs = R"(
+		#version 450
+
+		layout (location = 0)	in vec4 aPos;		// Half floats
+		layout (location = 1)	in vec2 aNormal;	// Octahedral encoded
+		layout (location = 2)	in vec2 aTexCoord;	// Half floats
+		layout (location = 3)	in mat4 aModelMatrix;
+
+		vec3 getPos() { return aPos.xyz; }
+
+		vec3 getNormal()
+		{
+			vec3 n = vec3(aNormal, 1.0 - abs(aNormal.x) - abs(aNormal.y));
+			float t = max(-n.z, 0.0);
+			n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+			return normalize(n);
+		}
+		)";
+
+	// Joint matrices of every animated instance come from one palette. Each instance's offset into it is kept in the
+	// bottom row of its model matrix, which is always (0, 0, 0, 1) for an affine transform.
+	static const char* skinnedVertexInputs = R"(
+		#version 450
+
+		layout (location = 0)	in vec3 aPos;
+		layout (location = 1)	in vec3 aNormal;
+		layout (location = 2)	in vec2 aTexCoord;
+		layout (location = 3)	in mat4 aInstanceMatrix;
+		layout (location = 7)	in uvec4 aJoints;
+		layout (location = 8)	in vec4 aWeights;
+
+		layout (std430, binding = 4) readonly buffer BonePalettes
+		{
+			mat4 bones[];
+		};
+
+		mat4 getModelMatrix()
+		{
+			mat4 model = aInstanceMatrix;
+			model[0][3] = 0.0;
+			return model;
+		}
+
+		mat4 getSkinMatrix()
+		{
+			uint offset = uint(aInstanceMatrix[0][3]);
+			return bones[offset + aJoints.x] * aWeights.x +
+				   bones[offset + aJoints.y] * aWeights.y +
+				   bones[offset + aJoints.z] * aWeights.z +
+				   bones[offset + aJoints.w] * aWeights.w;
+		}
+
+		#define aModelMatrix getModelMatrix()
+
+		vec3 getPos() { return (getSkinMatrix() * vec4(aPos, 1.0)).xyz; }
+		vec3 getNormal() { return mat3(getSkinMatrix()) * aNormal; }
+		)";
+
+	static const char* baseVertSrc = R"(
+
 		layout (binding = 0) uniform CamData
 		{
 			mat4 projMatrix;
@@ -157,31 +234,119 @@ namespace kuai {
 		out vec4 worldPos;
 		out vec3 worldNorm;
 		out vec2 texCoords;
+		out float viewDepth;
 
 		void main()
 		{
-			worldPos = aModelMatrix * vec4(aPos, 1.0);
+			worldPos = aModelMatrix * vec4(getPos(), 1.0);
 			mat3 model3x3InvTransp = mat3(transpose(inverse(aModelMatrix)));
-			worldNorm = model3x3InvTransp * aNormal;
+			worldNorm = model3x3InvTransp * getNormal();
 			texCoords = aTexCoord;
 
-			gl_Position = projMatrix * viewMatrix * worldPos;
+			vec4 viewPos = viewMatrix * worldPos;
+			viewDepth = -viewPos.z;
+
+			gl_Position = projMatrix * viewPos;
 		}
-		)",
-		R"(
+		)";
+
+	static const char* baseFragSrc = R"(
 		#version 450
 
+		struct Light
+		{
+			vec4 posRange;
+			vec4 dirCutoff;
+			vec4 colIntensity;
+			vec4 params; // x = linear, y = quadratic, z = type
+		};
+
+		layout (std430, binding = 1) readonly buffer LightData
+		{
+			Light lights[];
+		};
+
+		// Offset and count into lightIndices for every cluster
+		layout (std430, binding = 2) readonly buffer ClusterGrid
+		{
+			uvec2 clusters[];
+		};
+
+		layout (std430, binding = 3) readonly buffer ClusterIndices
+		{
+			uint lightIndices[];
+		};
+
+		layout (binding = 1) uniform ClusterData
+		{
+			uvec4 clusterDims;	// xyz = number of clusters along each axis, w = number of directional lights
+			vec4 clusterDepth;	// x = depth slice scale, y = depth slice bias
+			vec2 clusterScale;	// Clusters per pixel
+		};
+
 		in vec4 worldPos;
 		in vec3 worldNorm;
 		in vec2 texCoords;
+		in float viewDepth;
+
+		uniform sampler2D diffuse;
 
 		out vec4 fragCol;
 
+		const float ambient = 0.1;
+
+		vec3 calcLight(Light light, vec3 norm)
+		{
+			int type = int(light.params.z);
+			vec3 lightDir;
+			float attenuation = 1.0;
+
+			if (type == 0) // Directional
+			{
+				lightDir = normalize(-light.dirCutoff.xyz);
+			}
+			else
+			{
+				vec3 toLight = light.posRange.xyz - worldPos.xyz;
+				float dist = length(toLight);
+				lightDir = toLight / dist;
+				attenuation = 1.0 / (1.0 + light.params.x * dist + light.params.y * dist * dist);
+
+				if (type == 2 && dot(lightDir, normalize(-light.dirCutoff.xyz)) < light.dirCutoff.w) // Outside spotlight cone
+					attenuation = 0.0;
+			}
+
+			float diff = max(dot(norm, lightDir), 0.0);
+			return light.colIntensity.rgb * light.colIntensity.a * diff * attenuation;
+		}
+
 		void main()
 		{
-			fragCol = vec4(1.0);
+			vec3 norm = normalize(worldNorm);
+			vec3 lighting = vec3(ambient);
+
+			for (uint i = 0; i < clusterDims.w; i++)
+				lighting += calcLight(lights[i], norm);
+
+			// Find this fragment's cluster and only shade with the lights binned into it
+			uint slice = uint(max(log(viewDepth) * clusterDepth.x + clusterDepth.y, 0.0));
+			uvec3 cluster = min(uvec3(uvec2(gl_FragCoord.xy * clusterScale), slice), clusterDims.xyz - 1);
+			uvec2 range = clusters[cluster.x + cluster.y * clusterDims.x + cluster.z * clusterDims.x * clusterDims.y];
+
+			for (uint i = 0; i < range.y; i++)
+				lighting += calcLight(lights[lightIndices[range.x + i]], norm);
+
+			fragCol = vec4(texture(diffuse, texCoords).rgb * lighting, 1.0);
 		}
-		)");
+		)";
+
+	void Shader::init()
+	{
+		base = new Shader(std::string(fullVertexInputs) + baseVertSrc, baseFragSrc);
+		baseCompact = new Shader(std::string(compactVertexInputs) + baseVertSrc, baseFragSrc);
+		baseCompact->vertexFormat = VertexFormat::COMPACT;
+		skinned = new Shader(std::string(skinnedVertexInputs) + baseVertSrc, baseFragSrc);
+		skinned->vertexFormat = VertexFormat::SKINNED;
 
 		Rc<VertexBuffer> baseVbo1 = makeRc<VertexBuffer>(0);
 		Rc<VertexBuffer> baseVbo2 = makeRc<VertexBuffer>(0);
@@ -199,9 +364,62 @@ namespace kuai {
 		base->vao->addVertexBuffer(baseVbo1);
 		base->vao->addVertexBuffer(baseVbo2);
 
+		Rc<VertexBuffer> compactVbo1 = makeRc<VertexBuffer>(0);
+		Rc<VertexBuffer> compactVbo2 = makeRc<VertexBuffer>(0);
+
+		compactVbo1->setLayout(
+			{
+				{ ShaderDataType::HALF4,     "pos" },
+				{ ShaderDataType::SNORM16_2, "normal" },
+				{ ShaderDataType::HALF2,     "texCoord" }
+			});
+		compactVbo2->setLayout(
+			{
+				{ ShaderDataType::MAT4,  "modelMatrix" }
+			});
+		baseCompact->vao->addVertexBuffer(compactVbo1);
+		baseCompact->vao->addVertexBuffer(compactVbo2);
+
+		Rc<VertexBuffer> skinnedVbo1 = makeRc<VertexBuffer>(0);
+		Rc<VertexBuffer> skinnedVbo2 = makeRc<VertexBuffer>(0);
+		Rc<VertexBuffer> skinnedVbo3 = makeRc<VertexBuffer>(0);
+
+		skinnedVbo1->setLayout(
+			{
+				{ ShaderDataType::VEC3, "pos" },
+				{ ShaderDataType::VEC3, "normal" },
+				{ ShaderDataType::VEC2, "texCoord" }
+			});
+		skinnedVbo2->setLayout(
+			{
+				{ ShaderDataType::MAT4,  "modelMatrix" }
+			});
+		skinnedVbo3->setLayout(
+			{
+				{ ShaderDataType::UINT16_4, "joints" },
+				{ ShaderDataType::VEC4,     "weights" }
+			});
+		skinned->vao->addVertexBuffer(skinnedVbo1);
+		skinned->vao->addVertexBuffer(skinnedVbo2);
+		skinned->vao->addVertexBuffer(skinnedVbo3);
+
 		base->bind();
 
 		base->createUniformBlock("CamData", { "projMatrix", "viewMatrix" }, 0);
+		base->createUniformBlock("ClusterData", { "clusterDims", "clusterDepth", "clusterScale" }, 1);
+
+		base->createUniform("diffuse");
+		base->setUniform("diffuse", 0);
+
+		baseCompact->bind();
+
+		baseCompact->createUniform("diffuse");
+		baseCompact->setUniform("diffuse", 0);
+
+		skinned->bind();
+
+		skinned->createUniform("diffuse");
+		skinned->setUniform("diffuse", 0);
 
 		sprite = new Shader(
 		R"(
@@ -294,6 +512,8 @@ namespace kuai {
 	void Shader::cleanup()
 	{
 		delete base;
+		delete baseCompact;
+		delete skinned;
 		delete sprite;
 	}
 
@@ -6,6 +6,15 @@
 
 namespace kuai {
 
+	/**
+	* Layout of the per-vertex data a shader reads. COMPACT shaders are fed CompactVertex instead of Vertex,
+	* SKINNED shaders are fed Vertex plus a second buffer of SkinWeights.
+	*/
+	enum class VertexFormat
+	{
+		FULL, COMPACT, SKINNED
+	};
+
 	class Shader
 	{
 	public:
@@ -26,8 +35,11 @@ namespace kuai {
 
 		Rc<VertexArray> getVertexArray();
 
+		VertexFormat getVertexFormat() const { return vertexFormat; }
+
 		u32 getCommandCount() const;
 		void setIndirectBufData(const std::vector<IndirectCommand>& commands);
+		void setIndirectBufData(const IndirectCommand* commands, u32 count);
 
 		void bind() const;
 		void unbind() const;
@@ -37,6 +49,8 @@ namespace kuai {
 		static void cleanup();
 
 		static Shader* base;
+		static Shader* baseCompact;	// Same as base but reads quantised vertices, halving vertex bandwidth
+		static Shader* skinned;		// Same as base but deforms vertices by the joints of an animated skeleton
 		static Shader* sprite;
 
 	protected:
@@ -49,6 +63,8 @@ namespace kuai {
 
 		std::unordered_map<std::string, u32> uniforms;
 
+		VertexFormat vertexFormat = VertexFormat::FULL;
+
 		Rc<VertexArray> vao;	    // Vertex array object
 		Box<IndirectBuffer> ibo;	// Buffer containing mesh instance information
 
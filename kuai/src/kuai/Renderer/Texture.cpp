@@ -1,6 +1,8 @@
 #include "kpch.h"
 #include "Texture.h"
 
+#include "RenderState.h"
+
 #include "glad/glad.h"
 #include "stb_image.h"
 
@@ -10,7 +12,7 @@ namespace kuai {
 		unsigned char data[] = { 0xFF, 0xFF, 0xFF };
 		
 		glGenTextures(1, &textureId);
-		glBindTexture(GL_TEXTURE_2D, textureId);
+		RenderState::bindTexture(0, GL_TEXTURE_2D, textureId);
 
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
 	}
@@ -20,7 +22,7 @@ namespace kuai {
 		KU_PROFILE_FUNCTION();
 
 		glGenTextures(1, &textureId);
-		glBindTexture(GL_TEXTURE_2D, textureId);
+		RenderState::bindTexture(0, GL_TEXTURE_2D, textureId);
 
 		// Load file using stbi library
 		int width, height, colourChannels;
@@ -72,6 +74,7 @@ namespace kuai {
 
 	Texture::~Texture()
 	{
+		RenderState::onDeleteTexture(textureId);
 		glDeleteTextures(1, &textureId);
 	}
 
@@ -82,7 +85,6 @@ namespace kuai {
 
 	void Texture::bind(u32 activeTex)
 	{
-		glActiveTexture(GL_TEXTURE0 + activeTex);
-		glBindTexture(GL_TEXTURE_2D, textureId);
+		RenderState::bindTexture(activeTex, GL_TEXTURE_2D, textureId);
 	}
 }
@@ -2,6 +2,8 @@
 
 #include "TextureArray.h"
 
+#include "RenderState.h"
+
 #include "glad/glad.h"
 
 #include "stb_image_resize.h"
@@ -12,7 +14,7 @@ namespace kuai {
 		: width(width), height(height), layers(layers)
 	{
 		glGenTextures(1, &textureId);
-		glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+		RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, textureId);
 
 		// Allocate the storage; only use 1 mip level
 		glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RGBA8, width, height, layers);
@@ -45,7 +47,7 @@ namespace kuai {
 		{
 			unsigned char* inData = new unsigned char[(size_t)texture->getWidth() * texture->getHeight() * 4];
 
-			glBindTexture(GL_TEXTURE_2D, texture->getId());
+			RenderState::bindTexture(0, GL_TEXTURE_2D, texture->getId());
 			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, inData);
 
 			stbir_resize_uint8(inData, texture->getWidth(), texture->getHeight(), 0, outData, width, height, 0, 4);
@@ -54,11 +56,11 @@ namespace kuai {
 		}
 		else
 		{
-			glBindTexture(GL_TEXTURE_2D, texture->getId());
+			RenderState::bindTexture(0, GL_TEXTURE_2D, texture->getId());
 			glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, outData);
 		}
 
-		glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+		RenderState::bindTexture(0, GL_TEXTURE_2D_ARRAY, textureId);
 		// First zero is mipmap level; next two zeros are x and y offsets; last zero is layer index offset
 		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, texture->getId(), width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, outData);
 
@@ -76,7 +78,6 @@ namespace kuai {
 
 	void TextureArray::bind(u32 activeTex)
 	{
-		glActiveTexture(GL_TEXTURE0 + activeTex);
-		glBindTexture(GL_TEXTURE_2D_ARRAY, textureId);
+		RenderState::bindTexture(activeTex, GL_TEXTURE_2D_ARRAY, textureId);
 	}
 }
\ No newline at end of file
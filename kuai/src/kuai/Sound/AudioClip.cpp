@@ -1,60 +1,132 @@
 #include "kpch.h"
 #include "AudioClip.h"
+#include "SampleCache.h"
 
 #include "AL/al.h"
 #include "sndfile.hh"
 
+#include <fstream>
+
 namespace kuai {
-	AudioClip::AudioClip(const std::string& filename) : handle(new SndfileHandle(filename))
+	AudioClip::AudioClip(const std::string& filename, bool resident) : filename(filename)
 	{
+		if (resident)
+		{
+			std::ifstream file(filename, std::ios::binary | std::ios::ate);
+			if (!file)
+			{
+				KU_CORE_ERROR("Failed to open audio file: {0}", filename);
+			}
+			else
+			{
+				encoded.resize(file.tellg());
+				file.seekg(0);
+				file.read((char*)encoded.data(), encoded.size());
+			}
+		}
+
+		reader = openReader();
 	}
 
 	AudioClip::~AudioClip()
+	{
+		SampleCache::remove(this);
+	}
+
+	AudioClip::Reader::~Reader()
 	{
 		delete handle;
 	}
 
 	int AudioClip::getSamplerate()
 	{
-		return handle->samplerate();
+		return reader->handle->samplerate();
 	}
 
 	int AudioClip::getChannels()
 	{
-		return handle->channels();
+		return reader->handle->channels();
 	}
 
 	int AudioClip::getFrames()
 	{
-		return handle->frames();
+		return reader->handle->frames();
 	}
 
-	uint64_t AudioClip::loadData(short* dest, uint64_t amount)
+	Box<AudioClip::Reader> AudioClip::openReader() const
 	{
-		uint64_t readAmount = handle->read(dest, amount);
+		Box<Reader> result = makeBox<Reader>();
+
+		if (encoded.empty())
+		{
+			result->handle = new SndfileHandle(filename);
+			return result;
+		}
+
+		// libsndfile reads resident clips through these, each reader keeping its own position in the shared bytes
+		static SF_VIRTUAL_IO memoryIO =
+		{
+			[](void* user) -> sf_count_t
+			{
+				return ((Reader*)user)->encoded->size();
+			},
+			[](sf_count_t offset, int whence, void* user) -> sf_count_t
+			{
+				Reader* reader = (Reader*)user;
+				i64 size = reader->encoded->size();
+				i64 base = whence == SEEK_SET ? 0 : (whence == SEEK_CUR ? reader->pos : size);
+				reader->pos = std::clamp<i64>(base + offset, 0, size);
+				return reader->pos;
+			},
+			[](void* dest, sf_count_t count, void* user) -> sf_count_t
+			{
+				Reader* reader = (Reader*)user;
+				sf_count_t amount = std::min<sf_count_t>(count, reader->encoded->size() - reader->pos);
+				memcpy(dest, reader->encoded->data() + reader->pos, amount);
+				reader->pos += amount;
+				return amount;
+			},
+			[](const void*, sf_count_t, void*) -> sf_count_t
+			{
+				return 0;
+			},
+			[](void* user) -> sf_count_t
+			{
+				return ((Reader*)user)->pos;
+			}
+		};
+
+		result->encoded = &encoded;
+		result->handle = new SndfileHandle(memoryIO, result.get());
+		return result;
+	}
+
+	u64 AudioClip::read(Reader& reader, short* dest, u64 amount)
+	{
+		u64 readAmount = reader.handle->read(dest, amount);
 		if (readAmount < amount) // Set seek position to start if EOF reached
-			handle->seek(0, SF_SEEK_SET);
+			reader.handle->seek(0, SF_SEEK_SET);
 		return readAmount;
 	}
 
 	std::vector<short> AudioClip::loadAllData()
 	{
-		std::vector<short> data(handle->channels() * handle->frames());
-		handle->read(data.data(), data.size());
+		std::vector<short> data(getChannels() * getFrames());
+
+		// Its own reader, so it can decode on a worker while the clip's details are read elsewhere
+		Box<Reader> wholeReader = openReader();
+		wholeReader->handle->read(data.data(), data.size());
 		return data;
 	}
 
 	int AudioClip::getFormat()
 	{
-		if (handle->channels() == 1 && handle->format() & SF_FORMAT_PCM_S8)
-			return AL_FORMAT_MONO8;
-		else if (handle->channels() == 1 && handle->format() & SF_FORMAT_PCM_16)
+		// Every format is decoded to 16 bit samples
+		if (getChannels() == 1)
 			return AL_FORMAT_MONO16;
-		else if (handle->channels() == 2 && handle->format() & SF_FORMAT_PCM_S8)
-			return AL_FORMAT_STEREO8;
-		else if (handle->channels() == 2 && handle->format() & SF_FORMAT_PCM_16)
+		else if (getChannels() == 2)
 			return AL_FORMAT_STEREO16;
-		
+
 		return AL_NONE;
 		//KU_CORE_WARN("Sound file {0} is stereo and will not have 3D positional sound", filename);
 	}
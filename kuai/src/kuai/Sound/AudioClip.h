@@ -6,27 +6,49 @@ class SndfileHandle;
 namespace kuai {
 	/** \class AudioClip
 	*	\brief Stores an audio file from a given location.
+	*		   Sources share one decoded copy of the clip through the SampleCache.
 	*/
 	class AudioClip
 	{
 	public:
 		/**
-		* Creates audio clip from a sound file.
+		* Creates audio clip from a sound file. Any format libsndfile reads is supported, including Ogg Vorbis, Opus and FLAC.
+		* @param resident Keep the file's encoded bytes in memory and decode from them as it plays, rather than reading
+		*				  the file from disk. For compressed formats this is around a tenth the size of the decoded samples.
 		*/
-		AudioClip(const std::string& filename);
-		// TODO: AudioClip(const std::string& filename, bool stream = false); // Move stream option to audioclip
+		AudioClip(const std::string& filename, bool resident = false);
 		~AudioClip();
 
 		int getSamplerate();
 		int getChannels();
 		int getFrames();
 
+		/**
+		* Bytes of the encoded file kept in memory, or 0 if it is read from disk.
+		*/
+		u64 getResidentSize() const { return encoded.size(); }
+
 	private:
 		/**
-		* Load (amount * sizeof(short)) bytes of data from file into dest.
-		* @return The number of shorts read from the file.
+		* An independent read position in the clip, so each stream decodes on its own thread without disturbing any other.
 		*/
-		uint64_t loadData(short* dest, uint64_t amount);
+		struct Reader
+		{
+			~Reader();
+
+			SndfileHandle* handle = nullptr;
+			const std::vector<u8>* encoded = nullptr; // Read through instead of the file when resident
+			i64 pos = 0;
+		};
+
+		Box<Reader> openReader() const;
+
+		/**
+		* Decode up to amount shorts into dest, going back to the start when the end is reached.
+		* @return The number of shorts read.
+		*/
+		static u64 read(Reader& reader, short* dest, u64 amount);
+
 		/**
 		* Load the whole file at once and return it as a vector of shorts.
 		*/
@@ -34,10 +56,14 @@ namespace kuai {
 
 		int getFormat();
 
-		SndfileHandle* handle = nullptr;
+		std::string filename;
+		std::vector<u8> encoded;
+
+		Box<Reader> reader; // For the clip's details and decoding it whole
 
 		friend class AudioSource;
 		friend class MusicSource;
+		friend class SampleCache;
+		friend class StreamDecoder;
 	};
 }
-
@@ -3,12 +3,25 @@
 #include "AudioManager.h"
 #include "AudioClip.h"
 #include "MusicSource.h"
+#include "AudioStreamer.h"
+#include "Mixer.h"
+#include "SampleCache.h"
+#include "VoiceManager.h"
 
 namespace kuai {
 	ALCdevice* AudioManager::device = nullptr;
 	ALCcontext* AudioManager::context = nullptr;
 
-	std::unordered_map<u32, AudioSource*> AudioManager::sourceMap = std::unordered_map<u32, AudioSource*>();
+	std::vector<AudioSource*> AudioManager::sources;
+
+	glm::vec3 AudioManager::listenerPos = glm::vec3(0.0f);
+	glm::vec3 AudioManager::listenerAt = glm::vec3(0.0f, 0.0f, -1.0f);
+	glm::vec3 AudioManager::listenerUp = glm::vec3(0.0f, 1.0f, 0.0f);
+	float AudioManager::listenerGain = 1.0f;
+	bool AudioManager::listenerDirty = false;
+
+	LPALDEFERUPDATESSOFT AudioManager::alDeferUpdates = nullptr;
+	LPALPROCESSUPDATESSOFT AudioManager::alProcessUpdates = nullptr;
 
 	void AudioManager::init()
 	{
@@ -27,19 +40,43 @@ namespace kuai {
 			exit(1);
 		}
 
+		if (alIsExtensionPresent("AL_SOFT_deferred_updates"))
+		{
+			alDeferUpdates = (LPALDEFERUPDATESSOFT)alGetProcAddress("alDeferUpdatesSOFT");
+			alProcessUpdates = (LPALPROCESSUPDATESSOFT)alGetProcAddress("alProcessUpdatesSOFT");
+		}
+
+		Mixer::init(device);
+
+		ALCint monoSources = 0;
+		alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &monoSources);
+		VoiceManager::init(monoSources);
+
+		AudioStreamer::init();
+
 		KU_CORE_INFO("Started Audio Manager");
 	}
 
 	void AudioManager::cleanup()
 	{
-		for (auto& pair : sourceMap)
+		for (AudioSource* source : sources)
 		{
-			auto& source = pair.second;
 			source->cleanup();
 			delete source;
 		}
 
-		sourceMap.clear();
+		sources.clear();
+
+		VoiceManager::cleanup();
+
+		// Filters and the reverb go after the voices using them
+		Mixer::cleanup();
+
+		// Every stream has stopped with its source, so the thread has nothing left to service
+		AudioStreamer::cleanup();
+
+		// Shared buffers go once no source holds them, and before the context they belong to
+		SampleCache::cleanup();
 
 		if (context)
 		{
@@ -61,46 +98,86 @@ namespace kuai {
 		else
 		{
 			source = new AudioSource();
+			VoiceManager::add(source);
 		}
 
-		sourceMap.emplace(source->getId(), source);
+		sources.push_back(source);
 
 		return source;
 	}
 
-	void AudioManager::destroyAudioSource(u32 id)
+	void AudioManager::destroyAudioSource(AudioSource* source)
 	{
-		if (context && !sourceMap.empty())
+		auto it = std::find(sources.begin(), sources.end(), source);
+		if (context && it != sources.end())
 		{
-			auto& source = sourceMap.at(id);
-
 			source->cleanup();
+			delete source;
 
-			sourceMap.erase(id);
+			*it = sources.back();
+			sources.pop_back();
 		}
 	}
 
+	void AudioManager::update(float dt)
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Hold back the changes until they're all made, so the mixer never hears half of them
+		if (alDeferUpdates)
+			alDeferUpdates();
+		else
+			alcSuspendContext(context);
+
+		if (listenerDirty)
+		{
+			float orientation[6] = { listenerAt.x, listenerAt.y, listenerAt.z, listenerUp.x, listenerUp.y, listenerUp.z };
+			alCheck(alListener3f(AL_POSITION, listenerPos.x, listenerPos.y, listenerPos.z));
+			alCheck(alListenerfv(AL_ORIENTATION, orientation));
+			alCheck(alListenerf(AL_GAIN, listenerGain));
+			listenerDirty = false;
+		}
+
+		// Mixed gains first, so voices go to the sources that are loudest once their buses are taken into account
+		Mixer::update(dt, sources, listenerPos);
+		VoiceManager::update(dt, listenerPos);
+
+		// Sources given a voice above were sent everything; the rest only send what changed
+		for (AudioSource* source : sources)
+		{
+			if (source->dirty && source->sourceId)
+				source->apply(source->sourceId, source->dirty);
+			source->dirty = 0;
+		}
+
+		if (alProcessUpdates)
+			alProcessUpdates();
+		else
+			alcProcessContext(context);
+	}
+
 	float AudioManager::getGlobalGain()
 	{
-		ALfloat gain;
-		alCheck(alGetListenerf(AL_GAIN, &gain));
-		return gain;
+		return listenerGain;
 	}
 
 	void AudioManager::setGlobalGain(float gain)
 	{
-		alCheck(alListenerf(AL_GAIN, gain));
+		listenerGain = gain;
+		listenerDirty = true;
 	}
 
 	void AudioManager::setPos(const glm::vec3& pos)
 	{
-		alCheck(alListener3f(AL_POSITION, pos.x, pos.y, pos.z));
+		listenerPos = pos;
+		listenerDirty = true;
 	}
 
 	void AudioManager::setOrientation(const glm::vec3& at, const glm::vec3& up)
 	{
-		float vals[6] = { at.x, at.y, at.z, up.x, up.y, up.z };
-		alCheck(alListenerfv(AL_ORIENTATION, vals));
+		listenerAt = at;
+		listenerUp = up;
+		listenerDirty = true;
 	}
 
 	void checkAlErrors(const std::filesystem::path& file, unsigned int line, std::string_view expression)
@@ -2,6 +2,7 @@
 
 #include "AL/al.h"
 #include "AL/alc.h"
+#include "AL/alext.h"
 #include "glm/glm.hpp"
 
 #include "AudioSource.h"
@@ -14,8 +15,14 @@ namespace kuai {
 		static void init();
 		static void cleanup();
 
+		/**
+		* Reassign voices to the sources that can be heard best from where the listener is, then send every property
+		* changed since the last update to OpenAL in one batch. Once a frame.
+		*/
+		static void update(float dt);
+
 		static AudioSource* createAudioSource(bool stream = false);
-		static void destroyAudioSource(u32 id);
+		static void destroyAudioSource(AudioSource* source);
 
 		static float getGlobalGain();
 		static void setGlobalGain(float gain);
@@ -27,14 +34,23 @@ namespace kuai {
 		static ALCdevice* device;
 		static ALCcontext* context;
 
-		static std::unordered_map<u32, AudioSource*> sourceMap;
+		static std::vector<AudioSource*> sources;
+
+		// Listener properties, sent to OpenAL in update
+		static glm::vec3 listenerPos;
+		static glm::vec3 listenerAt;
+		static glm::vec3 listenerUp;
+		static float listenerGain;
+		static bool listenerDirty;
+
+		// AL_SOFT_deferred_updates, so a batch of changes is applied to the mix all at once
+		static LPALDEFERUPDATESSOFT alDeferUpdates;
+		static LPALPROCESSUPDATESSOFT alProcessUpdates;
 	};
 	
 	// This is based on SFML - Simple and Fast Multimedia Library
 	// Copyright (C) 2007-2023 Laurent Gomila (laurent@sfml-dev.org)
 	// The do-while loop is needed so that alCheck can be used as a single statement in if/else branches
-	#define KU_DEBUG
-
 	#ifdef KU_DEBUG
 		#define alCheck(expr)                                      \
 			do                                                     \
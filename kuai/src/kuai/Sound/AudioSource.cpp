@@ -3,99 +3,137 @@
 #include "AudioSource.h"
 #include "AudioClip.h"
 #include "AudioManager.h"
+#include "Mixer.h"
+#include "SampleCache.h"
+#include "VoiceManager.h"
 
 namespace kuai {
-	AudioSource::AudioSource()
+	AudioSource::AudioSource() : bus(Mixer::SFX)
 	{
-		alCheck(alGenSources(1, &sourceId));
-		alCheck(alGenBuffers(BUF_COUNT, buffers));
 	}
 
 	void AudioSource::cleanup()
 	{
-		alCheck(alSourceStop(sourceId));
+		// Gives back its voice, if it has one
+		VoiceManager::remove(this);
 
-		// Delete the buffers (This gets handled centrally by the AudioManager class)
-		alCheck(alSourcei(sourceId, AL_BUFFER, 0));
-		alCheck(alDeleteBuffers(BUF_COUNT, buffers));
-
-		alCheck(alDeleteSources(1, &sourceId));
+		if (cachedClip)
+		{
+			SampleCache::release(cachedClip);
+			cachedClip = nullptr;
+		}
 	}
 
 	void AudioSource::play()
 	{
-		alCheck(alSourcePlay(sourceId));
+		if (!audioClip)
+			return;
+
+		if (state == PlaybackState::Stopped)
+			playTime = 0.0f;
+		state = PlaybackState::Playing;
+
+		if (sourceId)
+			alCheck(alSourcePlay(sourceId));
+		else
+			VoiceManager::requestVoice(this);
 	}
 
 	void AudioSource::pause()
 	{
-		alCheck(alSourcePause(sourceId));
+		if (state != PlaybackState::Playing)
+			return;
+
+		state = PlaybackState::Paused;
+		if (sourceId)
+			alCheck(alSourcePause(sourceId));
 	}
 
 	void AudioSource::stop()
 	{
-		alCheck(alSourceStop(sourceId));
+		state = PlaybackState::Stopped;
+		playTime = 0.0f;
+		if (sourceId)
+			alCheck(alSourceStop(sourceId));
 	}
 
 	void AudioSource::setAudioClip(Rc<AudioClip> audioClip)
 	{
-		this->audioClip = audioClip;
+		// A buffer can only be swapped on a stopped source
+		stop();
+		if (sourceId)
+			alCheck(alSourcei(sourceId, AL_BUFFER, AL_NONE));
 
-		std::vector<short> data = audioClip->loadAllData();
+		if (cachedClip)
+			SampleCache::release(cachedClip);
 
-		alCheck(alSourcei(sourceId, AL_BUFFER, AL_NONE));
-		alCheck(alBufferData(buffers[0], audioClip->getFormat(), data.data(), data.size() * sizeof(short), audioClip->getSamplerate()));
-		alCheck(alSourcei(sourceId, AL_BUFFER, buffers[0]));
+		this->audioClip = audioClip;
+		cachedClip = audioClip.get();
+		clipBuffer = 0;
+		clipDuration = 0.0f;
+
+		if (audioClip)
+		{
+			clipBuffer = SampleCache::acquire(audioClip);
+			clipDuration = (float)audioClip->getFrames() / audioClip->getSamplerate();
 
-		data.clear();
+			if (sourceId)
+				alCheck(alSourcei(sourceId, AL_BUFFER, clipBuffer));
+		}
 	}
 
 	float AudioSource::getGain() const
 	{
-		ALfloat gain;
-		alCheck(alGetSourcef(sourceId, AL_GAIN, &gain));
 		return gain;
 	}
 
 	void AudioSource::setGain(float gain)
 	{
-		alCheck(alSourcef(sourceId, AL_GAIN, gain));
+		this->gain = gain;
+		dirty |= GAIN;
 	}
 
 	float AudioSource::getPitch() const
 	{
-		ALfloat pitch;
-		alCheck(alGetSourcef(sourceId, AL_PITCH, &pitch));
 		return pitch;
 	}
 
 	void AudioSource::setPitch(float pitch)
 	{
-		alCheck(alSourcef(sourceId, AL_PITCH, pitch));
+		this->pitch = pitch;
+		dirty |= PITCH;
 	}
 
 	float AudioSource::getRolloff() const
 	{
-		ALfloat rolloff;
-		alCheck(alGetSourcef(sourceId, AL_ROLLOFF_FACTOR, &rolloff));
 		return rolloff;
 	}
 
 	void AudioSource::setRolloff(float rolloff)
 	{
-		alCheck(alSourcef(sourceId, AL_ROLLOFF_FACTOR, rolloff));
+		this->rolloff = rolloff;
+		dirty |= ROLLOFF;
 	}
 
 	float AudioSource::getRefDist() const
 	{
-		ALfloat refDist;
-		alCheck(alGetSourcef(sourceId, AL_REFERENCE_DISTANCE, &refDist));
 		return refDist;
 	}
 
 	void AudioSource::setRefDist(float refDist)
 	{
-		alCheck(alSourcef(sourceId, AL_REFERENCE_DISTANCE, refDist));
+		this->refDist = refDist;
+		dirty |= REF_DIST;
+	}
+
+	i32 AudioSource::getPriority() const
+	{
+		return priority;
+	}
+
+	void AudioSource::setPriority(i32 priority)
+	{
+		this->priority = priority;
 	}
 
 	bool AudioSource::isLoop() const
@@ -106,11 +144,27 @@ namespace kuai {
 	void AudioSource::setLoop(bool loop)
 	{
 		this->loop = loop;
-		alCheck(alSourcei(sourceId, AL_LOOPING, loop));
+		dirty |= LOOPING;
+	}
+
+	u32 AudioSource::getBus() const
+	{
+		return bus;
+	}
+
+	void AudioSource::setBus(u32 bus)
+	{
+		KU_CORE_ASSERT(bus < Mixer::buses.size(), "Bus doesn't exist");
+
+		// The Mixer sends the new bus's mix with its next update
+		this->bus = bus;
 	}
 
 	AudioSource::PlaybackState AudioSource::getStatus() const
 	{
+		if (!sourceId)
+			return state;
+
 		ALint status;
 		alCheck(alGetSourcei(sourceId, AL_SOURCE_STATE, &status));
 
@@ -130,21 +184,41 @@ namespace kuai {
 
 	void AudioSource::setPos(const glm::vec3& pos)
 	{
-		alCheck(alSource3f(sourceId, AL_GAIN, pos.x, pos.y, pos.z));
+		this->pos = pos;
+		dirty |= POSITION;
 	}
 
 	void AudioSource::setDir(const glm::vec3& dir)
 	{
-		alCheck(alSource3f(sourceId, AL_GAIN, dir.x, dir.y, dir.z));
+		this->dir = dir;
+		dirty |= DIRECTION;
 	}
 
 	void AudioSource::setVel(const glm::vec3& vel)
 	{
-		alCheck(alSource3f(sourceId, AL_GAIN, vel.x, vel.y, vel.z));
-	}
-
-	u32 AudioSource::getId()
-	{
-		return sourceId;
+		this->vel = vel;
+		dirty |= VELOCITY;
+	}
+
+	void AudioSource::apply(u32 voice, u32 properties) const
+	{
+		if (properties & PITCH)
+			alCheck(alSourcef(voice, AL_PITCH, pitch));
+		if (properties & GAIN)
+			alCheck(alSourcef(voice, AL_GAIN, gain * mixGain));
+		if (properties & ROLLOFF)
+			alCheck(alSourcef(voice, AL_ROLLOFF_FACTOR, rolloff));
+		if (properties & REF_DIST)
+			alCheck(alSourcef(voice, AL_REFERENCE_DISTANCE, refDist));
+		if (properties & POSITION)
+			alCheck(alSource3f(voice, AL_POSITION, pos.x, pos.y, pos.z));
+		if (properties & DIRECTION)
+			alCheck(alSource3f(voice, AL_DIRECTION, dir.x, dir.y, dir.z));
+		if (properties & VELOCITY)
+			alCheck(alSource3f(voice, AL_VELOCITY, vel.x, vel.y, vel.z));
+		if (properties & LOOPING)
+			alCheck(alSourcei(voice, AL_LOOPING, loop));
+		if (properties & EFFECTS)
+			Mixer::applyEffects(voice, mixGainHF, mixSend);
 	}
 }
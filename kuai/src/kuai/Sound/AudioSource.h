@@ -9,6 +9,10 @@ namespace kuai {
 	const u32 BUF_COUNT = 4;
 	const u32 BUF_SIZE = 32768;
 
+	/**
+	* A sound in the scene. Its settings are kept here and sent to its OpenAL voice in one batch with every other change,
+	* once a frame. Without a voice from the VoiceManager it is virtual, silently keeping track of where it is in its clip.
+	*/
     class AudioSource
     {
     public:
@@ -21,7 +25,7 @@ namespace kuai {
 
         AudioSource();
 		virtual void cleanup();
-       
+
 		virtual void play();
 		virtual void pause();
 		virtual void stop();
@@ -40,27 +44,79 @@ namespace kuai {
 		float getRefDist() const;
 		void setRefDist(float refDist);
 
+		i32 getPriority() const;
+		void setPriority(i32 priority);
+
 		bool isLoop() const;
 		virtual void setLoop(bool loop);
 
+		/**
+		* The Mixer bus the source plays through (default Mixer::SFX, or Mixer::MUSIC when streamed).
+		*/
+		u32 getBus() const;
+		void setBus(u32 bus);
+
 		virtual PlaybackState getStatus() const;
 
+		/**
+		* Whether the source currently has an OpenAL voice.
+		*/
+		bool isReal() const { return sourceId != 0; }
+
 	private:
 		void setPos(const glm::vec3& pos);
 		void setDir(const glm::vec3& dir);
 		void setVel(const glm::vec3& vel);
 
-		u32 getId();
+		// Properties changed since they were last sent to OpenAL
+		enum Property : u32
+		{
+			PITCH = BIT(0), GAIN = BIT(1), ROLLOFF = BIT(2), REF_DIST = BIT(3),
+			POSITION = BIT(4), DIRECTION = BIT(5), VELOCITY = BIT(6), LOOPING = BIT(7), EFFECTS = BIT(8),
+			ALL_PROPERTIES = 0x1FF
+		};
+
+		/**
+		* Send the given properties to a voice.
+		*/
+		void apply(u32 voice, u32 properties) const;
 
 	protected:
 		Rc<AudioClip> audioClip = nullptr;
 		bool loop = false;
 
-		u32 sourceId = 0;
-		
-		u32 buffers[BUF_COUNT];
+		u32 sourceId = 0; // OpenAL source, or 0 while virtual
+
+		u32 buffers[BUF_COUNT] = {};	// Only streaming sources have buffers of their own
+		AudioClip* cachedClip = nullptr;	// Clip whose shared buffer from the SampleCache is attached
+		u32 clipBuffer = 0;
+		float clipDuration = 0.0f;
+
+		float pitch = 1.0f;
+		float gain = 1.0f;
+		float rolloff = 1.0f;
+		float refDist = 1.0f;
+		i32 priority = 0;
+		u32 bus;
+		glm::vec3 pos = glm::vec3(0.0f);
+		glm::vec3 dir = glm::vec3(0.0f);
+		glm::vec3 vel = glm::vec3(0.0f);
+
+		// Worked out by the Mixer from the source's bus and how occluded it is
+		float mixGain = 1.0f;
+		float mixGainHF = 1.0f;
+		float mixSend = 0.0f;
+		float occlusion = 0.0f;
+
+		u32 dirty = 0;
+
+		PlaybackState state = PlaybackState::Stopped;
+		float playTime = 0.0f;		// Seconds into the clip, kept up to date while virtual
+		float audibility = 0.0f;	// Estimated loudness at the listener, from the last voice update
 
 		friend class AudioManager;
+		friend class Mixer;
+		friend class VoiceManager;
 		friend class SoundSource;
     };
-}
\ No newline at end of file
+}
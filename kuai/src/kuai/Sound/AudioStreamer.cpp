@@ -0,0 +1,89 @@
+#include "kpch.h"
+#include "AudioStreamer.h"
+
+#include "MusicSource.h"
+
+namespace kuai {
+	std::thread AudioStreamer::thread;
+	std::mutex AudioStreamer::mutex;
+	std::condition_variable AudioStreamer::cond;
+	bool AudioStreamer::running = false;
+
+	std::vector<MusicSource*> AudioStreamer::streams;
+
+	void AudioStreamer::init()
+	{
+		running = true;
+		thread = std::thread(&AudioStreamer::run);
+	}
+
+	void AudioStreamer::cleanup()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			running = false;
+		}
+		cond.notify_one();
+
+		if (thread.joinable())
+			thread.join();
+
+		streams.clear();
+	}
+
+	void AudioStreamer::add(MusicSource* source)
+	{
+		source->nextService = MusicSource::Clock::now();
+		streams.push_back(source);
+		cond.notify_one();
+	}
+
+	void AudioStreamer::remove(MusicSource* source)
+	{
+		auto it = std::find(streams.begin(), streams.end(), source);
+		if (it == streams.end())
+			return;
+
+		*it = streams.back();
+		streams.pop_back();
+	}
+
+	void AudioStreamer::run()
+	{
+		using Clock = MusicSource::Clock;
+
+		std::unique_lock<std::mutex> lock(mutex);
+		while (running)
+		{
+			Clock::time_point now = Clock::now();
+			Clock::time_point wake = Clock::time_point::max();
+
+			for (size_t i = 0; i < streams.size();)
+			{
+				MusicSource* source = streams[i];
+
+				if (now >= source->nextService)
+				{
+					if (source->service())
+					{
+						// Reached the end, so finish up and stop servicing it
+						source->finish();
+						streams[i] = streams.back();
+						streams.pop_back();
+						continue;
+					}
+
+					source->nextService = now + source->serviceInterval;
+				}
+
+				wake = std::min(wake, source->nextService);
+				i++;
+			}
+
+			if (streams.empty())
+				cond.wait(lock, [] { return !running || !streams.empty(); });
+			else
+				cond.wait_until(lock, wake);
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+
+// @cond
+namespace kuai {
+	// Forward declaration
+	class MusicSource;
+
+	/**
+	* One thread refilling the buffers of every playing MusicSource. Each stream is serviced again once it should have
+	* finished playing half a buffer, and the thread sleeps until the soonest one is due or a stream starts.
+	*/
+	class AudioStreamer
+	{
+	public:
+		static void init();
+		static void cleanup();
+
+		/**
+		* Start servicing a stream. Must hold the lock from getMutex().
+		*/
+		static void add(MusicSource* source);
+
+		/**
+		* Stop servicing a stream. Must hold the lock from getMutex(), so the stream isn't midway through being serviced.
+		*/
+		static void remove(MusicSource* source);
+
+		/**
+		* Guards the streams and the streaming state of every MusicSource.
+		*/
+		static std::mutex& getMutex() { return mutex; }
+
+	private:
+		static void run();
+
+	private:
+		static std::thread thread;
+		static std::mutex mutex;
+		static std::condition_variable cond;
+		static bool running;
+
+		static std::vector<MusicSource*> streams;
+	};
+}
+// @endcond
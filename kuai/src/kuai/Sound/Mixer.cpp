@@ -0,0 +1,356 @@
+#include "kpch.h"
+#include "Mixer.h"
+
+#include "AudioSource.h"
+#include "AudioManager.h"
+#include "kuai/Physics/SpatialIndex.h"
+
+#include "AL/efx.h"
+
+namespace kuai {
+	// Hits this close to a source or the listener are taken to be their own geometry rather than something in the way
+	static const float OCCLUSION_MARGIN = 0.5f;
+	// Seconds for a source to become most of the way occluded or clear, so it doesn't click as things pass in front
+	static const float OCCLUSION_TIME = 0.1f;
+	// Mixed values closer than this to what a voice has aren't worth sending
+	static const float MIX_EPSILON = 0.001f;
+
+	// ALC_EXT_EFX, loaded in init
+	static LPALGENEFFECTS alGenEffects = nullptr;
+	static LPALDELETEEFFECTS alDeleteEffects = nullptr;
+	static LPALEFFECTI alEffecti = nullptr;
+	static LPALEFFECTF alEffectf = nullptr;
+	static LPALGENFILTERS alGenFilters = nullptr;
+	static LPALDELETEFILTERS alDeleteFilters = nullptr;
+	static LPALFILTERI alFilteri = nullptr;
+	static LPALFILTERF alFilterf = nullptr;
+	static LPALGENAUXILIARYEFFECTSLOTS alGenAuxiliaryEffectSlots = nullptr;
+	static LPALDELETEAUXILIARYEFFECTSLOTS alDeleteAuxiliaryEffectSlots = nullptr;
+	static LPALAUXILIARYEFFECTSLOTI alAuxiliaryEffectSloti = nullptr;
+
+	// Occlusion queries, kept between updates so they don't allocate
+	static std::vector<AudioSource*> occludable;
+	static std::vector<Ray> rays;
+	static std::vector<float> rayDists;
+	static std::vector<std::optional<SpatialIndexSystem::RaycastHit>> hits;
+
+	std::vector<Mixer::Bus> Mixer::buses = {
+		{ "Master" },
+		{ "Music", MASTER },
+		{ "SFX", MASTER },
+		{ "Voice", MASTER }
+	};
+	std::vector<Mixer::Ducking> Mixer::duckings;
+
+	Mixer::Reverb Mixer::reverb;
+	float Mixer::occludedGain = 0.5f;
+	float Mixer::occludedGainHF = 0.15f;
+	const SpatialIndexSystem* Mixer::scene = nullptr;
+
+	bool Mixer::efx = false;
+	u32 Mixer::directFilter = 0;
+	u32 Mixer::sendFilter = 0;
+	u32 Mixer::reverbEffect = 0;
+	u32 Mixer::reverbSlot = 0;
+
+	void Mixer::init(ALCdevice* device)
+	{
+		if (!alcIsExtensionPresent(device, "ALC_EXT_EFX"))
+		{
+			KU_CORE_WARN("OpenAL effects extension unavailable, so the mixer won't filter or add reverb");
+			return;
+		}
+
+		alGenEffects = (LPALGENEFFECTS)alGetProcAddress("alGenEffects");
+		alDeleteEffects = (LPALDELETEEFFECTS)alGetProcAddress("alDeleteEffects");
+		alEffecti = (LPALEFFECTI)alGetProcAddress("alEffecti");
+		alEffectf = (LPALEFFECTF)alGetProcAddress("alEffectf");
+		alGenFilters = (LPALGENFILTERS)alGetProcAddress("alGenFilters");
+		alDeleteFilters = (LPALDELETEFILTERS)alGetProcAddress("alDeleteFilters");
+		alFilteri = (LPALFILTERI)alGetProcAddress("alFilteri");
+		alFilterf = (LPALFILTERF)alGetProcAddress("alFilterf");
+		alGenAuxiliaryEffectSlots = (LPALGENAUXILIARYEFFECTSLOTS)alGetProcAddress("alGenAuxiliaryEffectSlots");
+		alDeleteAuxiliaryEffectSlots = (LPALDELETEAUXILIARYEFFECTSLOTS)alGetProcAddress("alDeleteAuxiliaryEffectSlots");
+		alAuxiliaryEffectSloti = (LPALAUXILIARYEFFECTSLOTI)alGetProcAddress("alAuxiliaryEffectSloti");
+
+		alCheck(alGenFilters(1, &directFilter));
+		alCheck(alFilteri(directFilter, AL_FILTER_TYPE, AL_FILTER_LOWPASS));
+		alCheck(alGenFilters(1, &sendFilter));
+		alCheck(alFilteri(sendFilter, AL_FILTER_TYPE, AL_FILTER_LOWPASS));
+
+		alCheck(alGenEffects(1, &reverbEffect));
+		alCheck(alEffecti(reverbEffect, AL_EFFECT_TYPE, AL_EFFECT_REVERB));
+		alCheck(alGenAuxiliaryEffectSlots(1, &reverbSlot));
+
+		efx = true;
+		setReverb(reverb);
+	}
+
+	void Mixer::cleanup()
+	{
+		scene = nullptr;
+
+		if (!efx)
+			return;
+
+		alCheck(alAuxiliaryEffectSloti(reverbSlot, AL_EFFECTSLOT_EFFECT, AL_EFFECTSLOT_NULL));
+		alCheck(alDeleteAuxiliaryEffectSlots(1, &reverbSlot));
+		alCheck(alDeleteEffects(1, &reverbEffect));
+		alCheck(alDeleteFilters(1, &directFilter));
+		alCheck(alDeleteFilters(1, &sendFilter));
+		efx = false;
+	}
+
+	u32 Mixer::createBus(const std::string& name, u32 parent)
+	{
+		KU_CORE_ASSERT(parent < buses.size(), "Parent bus doesn't exist");
+
+		// Parents always come before their children, so one pass in order resolves the graph
+		Bus bus;
+		bus.name = name;
+		bus.parent = parent;
+		buses.push_back(bus);
+
+		return buses.size() - 1;
+	}
+
+	u32 Mixer::findBus(const std::string& name)
+	{
+		for (u32 i = 0; i < buses.size(); i++)
+		{
+			if (buses[i].name == name)
+				return i;
+		}
+
+		return MASTER;
+	}
+
+	float Mixer::getGain(u32 bus)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		return buses[bus].gain;
+	}
+
+	void Mixer::setGain(u32 bus, float gain)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		buses[bus].gain = gain;
+	}
+
+	float Mixer::getLowpass(u32 bus)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		return buses[bus].lowpass;
+	}
+
+	void Mixer::setLowpass(u32 bus, float gainHF)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		buses[bus].lowpass = std::clamp(gainHF, 0.0f, 1.0f);
+	}
+
+	float Mixer::getReverbSend(u32 bus)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		return buses[bus].reverbSend < 0.0f ? buses[buses[bus].parent].mixSend : buses[bus].reverbSend;
+	}
+
+	void Mixer::setReverbSend(u32 bus, float send)
+	{
+		KU_CORE_ASSERT(bus < buses.size(), "Bus doesn't exist");
+		buses[bus].reverbSend = std::clamp(send, 0.0f, 1.0f);
+	}
+
+	void Mixer::addDucking(u32 target, u32 sidechain, float depth, float attack, float release, float threshold)
+	{
+		KU_CORE_ASSERT(target < buses.size() && sidechain < buses.size(), "Bus doesn't exist");
+		duckings.push_back({ target, sidechain, std::clamp(depth, 0.0f, 1.0f), attack, release, threshold });
+	}
+
+	void Mixer::clearDucking()
+	{
+		duckings.clear();
+		for (Bus& bus : buses)
+			bus.duck = 0.0f;
+	}
+
+	void Mixer::setReverb(const Reverb& reverb)
+	{
+		Mixer::reverb = reverb;
+
+		if (!efx)
+			return;
+
+		alCheck(alEffectf(reverbEffect, AL_REVERB_DECAY_TIME, reverb.decayTime));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_DENSITY, reverb.density));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_DIFFUSION, reverb.diffusion));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_GAIN, reverb.gain));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_GAINHF, reverb.gainHF));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_REFLECTIONS_DELAY, reverb.reflectionsDelay));
+		alCheck(alEffectf(reverbEffect, AL_REVERB_LATE_REVERB_DELAY, reverb.lateDelay));
+
+		// A slot copies its effect's settings when it is attached, so it's reattached after every change
+		alCheck(alAuxiliaryEffectSloti(reverbSlot, AL_EFFECTSLOT_EFFECT, reverbEffect));
+	}
+
+	void Mixer::setOcclusionScene(const SpatialIndexSystem* scene)
+	{
+		Mixer::scene = scene;
+	}
+
+	void Mixer::setOcclusion(float gain, float gainHF)
+	{
+		occludedGain = std::clamp(gain, 0.0f, 1.0f);
+		occludedGainHF = std::clamp(gainHF, 0.0f, 1.0f);
+	}
+
+	void Mixer::update(float dt, const std::vector<AudioSource*>& sources, const glm::vec3& listenerPos)
+	{
+		KU_PROFILE_FUNCTION();
+
+		// Follow each sidechain with an envelope, so ducking fades rather than jumps
+		for (Bus& bus : buses)
+			bus.duck = 0.0f;
+
+		for (Ducking& ducking : duckings)
+		{
+			float key = 0.0f;
+			for (AudioSource* source : sources)
+			{
+				if (routesTo(source->bus, ducking.sidechain) && source->getStatus() == AudioSource::PlaybackState::Playing)
+					key = std::max(key, source->gain);
+			}
+
+			float target = key > ducking.threshold ? ducking.depth : 0.0f;
+			float time = std::max(target > ducking.level ? ducking.attack : ducking.release, 0.0001f);
+			ducking.level += (target - ducking.level) * (1.0f - std::exp(-dt / time));
+
+			Bus& bus = buses[ducking.target];
+			bus.duck = std::max(bus.duck, ducking.level);
+		}
+
+		for (u32 i = 0; i < buses.size(); i++)
+		{
+			Bus& bus = buses[i];
+			bus.mixGain = bus.gain * (1.0f - bus.duck);
+			bus.mixLowpass = bus.lowpass;
+			bus.mixSend = std::max(bus.reverbSend, 0.0f);
+
+			if (i != MASTER)
+			{
+				const Bus& parent = buses[bus.parent];
+				bus.mixGain *= parent.mixGain;
+				bus.mixLowpass *= parent.mixLowpass;
+				if (bus.reverbSend < 0.0f)
+					bus.mixSend = parent.mixSend;
+			}
+		}
+
+		// Cast from the listener to every source with a voice; virtual ones can't be heard, so keep what they had
+		occludable.clear();
+		rays.clear();
+		rayDists.clear();
+		float maxDist = 0.0f;
+		if (scene)
+		{
+			for (AudioSource* source : sources)
+			{
+				// Streams don't keep a playback state of their own here, so only voices from the VoiceManager are tested
+				if (!source->sourceId || source->state != AudioSource::PlaybackState::Playing)
+					continue;
+
+				glm::vec3 toSource = source->pos - listenerPos;
+				float dist = glm::length(toSource);
+				if (dist <= 2.0f * OCCLUSION_MARGIN)
+					continue;
+
+				// Trimmed at both ends; hits are two-sided, so a mesh the listener is inside (the player's, a camera rig's)
+				// would otherwise be hit from within and occlude everything
+				glm::vec3 dir = toSource / dist;
+				float rayDist = dist - 2.0f * OCCLUSION_MARGIN;
+
+				occludable.push_back(source);
+				rays.emplace_back(listenerPos + dir * OCCLUSION_MARGIN, dir);
+				rayDists.push_back(rayDist);
+				maxDist = std::max(maxDist, rayDist);
+			}
+		}
+
+		if (!rays.empty())
+			scene->raycast(rays, maxDist, hits);
+
+		float occlusionRate = 1.0f - std::exp(-dt / OCCLUSION_TIME);
+		for (u32 i = 0; i < occludable.size(); i++)
+		{
+			AudioSource* source = occludable[i];
+			float target = hits[i] && hits[i]->distance < rayDists[i] ? 1.0f : 0.0f;
+
+			source->occlusion += (target - source->occlusion) * occlusionRate;
+			if (std::abs(target - source->occlusion) < MIX_EPSILON)
+				source->occlusion = target;
+		}
+
+		for (AudioSource* source : sources)
+		{
+			const Bus& bus = buses[source->bus];
+			float mixGain = bus.mixGain * glm::mix(1.0f, occludedGain, source->occlusion);
+			float mixGainHF = bus.mixLowpass * glm::mix(1.0f, occludedGainHF, source->occlusion);
+			float mixSend = bus.mixSend;
+
+			if (std::abs(mixGain - source->mixGain) > MIX_EPSILON)
+			{
+				source->mixGain = mixGain;
+				source->dirty |= AudioSource::GAIN;
+			}
+
+			if (std::abs(mixGainHF - source->mixGainHF) > MIX_EPSILON || std::abs(mixSend - source->mixSend) > MIX_EPSILON)
+			{
+				source->mixGainHF = mixGainHF;
+				source->mixSend = mixSend;
+				source->dirty |= AudioSource::EFFECTS;
+			}
+		}
+	}
+
+	void Mixer::applyEffects(u32 voice, float gainHF, float send)
+	{
+		if (!efx)
+			return;
+
+		// The direct path is only filtered when it needs to be, saving the mixer the work
+		if (gainHF < 1.0f)
+		{
+			alCheck(alFilterf(directFilter, AL_LOWPASS_GAIN, 1.0f));
+			alCheck(alFilterf(directFilter, AL_LOWPASS_GAINHF, gainHF));
+			alCheck(alSourcei(voice, AL_DIRECT_FILTER, directFilter));
+		}
+		else
+		{
+			alCheck(alSourcei(voice, AL_DIRECT_FILTER, AL_FILTER_NULL));
+		}
+
+		if (send > 0.0f)
+		{
+			// The reverb hears the same muffled sound as the listener
+			alCheck(alFilterf(sendFilter, AL_LOWPASS_GAIN, send));
+			alCheck(alFilterf(sendFilter, AL_LOWPASS_GAINHF, gainHF));
+			alCheck(alSource3i(voice, AL_AUXILIARY_SEND_FILTER, reverbSlot, 0, sendFilter));
+		}
+		else
+		{
+			alCheck(alSource3i(voice, AL_AUXILIARY_SEND_FILTER, AL_EFFECTSLOT_NULL, 0, AL_FILTER_NULL));
+		}
+	}
+
+	bool Mixer::routesTo(u32 bus, u32 ancestor)
+	{
+		while (true)
+		{
+			if (bus == ancestor)
+				return true;
+			if (bus == MASTER)
+				return false;
+			bus = buses[bus].parent;
+		}
+	}
+}
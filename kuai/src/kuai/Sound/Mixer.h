@@ -0,0 +1,154 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+// Forward declaration
+struct ALCdevice;
+
+namespace kuai {
+	// Forward declarations
+	class AudioSource;
+	class SpatialIndexSystem;
+
+	/** \class Mixer
+	*	\brief Routes every sound through a graph of buses, each with its own gain, low-pass filter and reverb send.
+	*
+	*	Master, Music, SFX and Voice buses always exist, the last three feeding Master; more can be created under any of
+	*	them. A bus can be ducked while another is playing, e.g. music under dialogue. Sounds behind scene geometry from
+	*	the listener are muffled, found with raycasts through the scene's SpatialIndexSystem. The filtering and reverb
+	*	are done by OpenAL's effects extension (EFX) on its mixing thread; without it, only the gains apply.
+	*/
+	class Mixer
+	{
+	public:
+		enum : u32 { MASTER, MUSIC, SFX, VOICE };
+
+		/**
+		* Add a bus feeding parent. Until given a send of their own, created buses use their parent's reverb send.
+		* @return The new bus.
+		*/
+		static u32 createBus(const std::string& name, u32 parent = MASTER);
+
+		/**
+		* The bus with the given name, or MASTER if there isn't one.
+		*/
+		static u32 findBus(const std::string& name);
+
+		static float getGain(u32 bus);
+		static void setGain(u32 bus, float gain);
+
+		/**
+		* Gain of the bus's high frequencies, from 0 (muffled) to 1 (unfiltered). Multiplies with its parents'.
+		*/
+		static float getLowpass(u32 bus);
+		static void setLowpass(u32 bus, float gainHF);
+
+		/**
+		* How much of the bus is sent to the reverb, from 0 (dry) to 1.
+		*/
+		static float getReverbSend(u32 bus);
+		static void setReverbSend(u32 bus, float send);
+
+		/**
+		* Lower target by depth (0 to 1) while anything on sidechain is playing louder than threshold.
+		* @param attack Seconds to duck by most of depth.
+		* @param release Seconds to recover most of the way.
+		*/
+		static void addDucking(u32 target, u32 sidechain, float depth, float attack = 0.05f, float release = 0.5f, float threshold = 0.01f);
+		static void clearDucking();
+
+		struct Reverb
+		{
+			float decayTime = 1.49f;		// Seconds
+			float density = 1.0f;
+			float diffusion = 1.0f;
+			float gain = 0.32f;
+			float gainHF = 0.89f;
+			float reflectionsDelay = 0.007f;	// Seconds
+			float lateDelay = 0.011f;		// Seconds
+		};
+
+		/**
+		* The room every bus's reverb send goes to.
+		*/
+		static const Reverb& getReverb() { return reverb; }
+		static void setReverb(const Reverb& reverb);
+
+		/**
+		* The scene raycast to find occluded sounds, or nullptr to turn occlusion off.
+		*/
+		static void setOcclusionScene(const SpatialIndexSystem* scene);
+
+		/**
+		* How much a fully occluded sound is turned down (default 0.5) and how much of its high frequencies are kept (default 0.15).
+		*/
+		static void setOcclusion(float gain, float gainHF);
+
+		/**
+		* Whether OpenAL's effects extension is available for filtering and reverb.
+		*/
+		static bool hasEffects() { return efx; }
+
+	private:
+		static void init(ALCdevice* device);
+		static void cleanup();
+
+		/**
+		* Advance the ducking, resolve each bus through its parents and work out every source's mix, marking what changed.
+		* Main thread, once a frame, before the VoiceManager uses the mixed gains.
+		*/
+		static void update(float dt, const std::vector<AudioSource*>& sources, const glm::vec3& listenerPos);
+
+		/**
+		* Send a source's mixed filter and reverb send to its voice.
+		*/
+		static void applyEffects(u32 voice, float gainHF, float send);
+
+		static bool routesTo(u32 bus, u32 ancestor);
+
+		struct Bus
+		{
+			std::string name;
+			u32 parent = MASTER;
+
+			float gain = 1.0f;
+			float lowpass = 1.0f;
+			float reverbSend = -1.0f; // Negative to use the parent's
+			float duck = 0.0f; // Current reduction from ducking
+
+			// Resolved through the parents each update
+			float mixGain = 1.0f;
+			float mixLowpass = 1.0f;
+			float mixSend = 0.0f;
+		};
+
+		struct Ducking
+		{
+			u32 target;
+			u32 sidechain;
+			float depth;
+			float attack;
+			float release;
+			float threshold;
+			float level = 0.0f; // Envelope, from 0 to depth
+		};
+
+	private:
+		static std::vector<Bus> buses;
+		static std::vector<Ducking> duckings;
+
+		static Reverb reverb;
+		static float occludedGain;
+		static float occludedGainHF;
+		static const SpatialIndexSystem* scene;
+
+		static bool efx;
+		static u32 directFilter;	// Scratch filters; a source copies one's settings when it is attached
+		static u32 sendFilter;
+		static u32 reverbEffect;
+		static u32 reverbSlot;
+
+		friend class AudioManager;
+		friend class AudioSource;
+	};
+}
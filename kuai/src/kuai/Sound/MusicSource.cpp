@@ -6,216 +6,207 @@
 #include "MusicSource.h"
 #include "AudioClip.h"
 #include "AudioManager.h"
+#include "AudioStreamer.h"
+#include "Mixer.h"
 
 #include <mutex>
 
 namespace kuai {
-	MusicSource::MusicSource()
+	MusicSource::MusicSource() : decoder(BUF_COUNT, BUF_SIZE)
 	{
+		bus = Mixer::MUSIC;
+
+		// Streams keep a voice of their own rather than competing for the VoiceManager's
+		alCheck(alGenSources(1, &sourceId));
+		alCheck(alGenBuffers(BUF_COUNT, buffers));
 	}
 
 	void MusicSource::cleanup()
 	{
-		awaitThread();
+		stop();
+
+		alCheck(alSourcei(sourceId, AL_BUFFER, 0));
+		alCheck(alDeleteBuffers(BUF_COUNT, buffers));
+		alCheck(alDeleteSources(1, &sourceId));
+		sourceId = 0;
+
 		AudioSource::cleanup();
 	}
 
 	void MusicSource::play()
 	{
-		bool isStreamingT = false;
-		PlaybackState threadStartStateT = PlaybackState::Stopped;
+		std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
 
+		if (isStreaming) // Resume
 		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
-			isStreamingT = isStreaming;
-			threadStartStateT = threadStartState;
+			if (isPaused)
+			{
+				isPaused = false;
+				if (isStarted)
+					alCheck(alSourcePlay(sourceId));
+			}
+			return;
 		}
 
-		if (isStreamingT && (threadStartStateT == PlaybackState::Paused)) // Resume
-		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
-			threadStartState = PlaybackState:: Playing;
-			alCheck(alSourcePlay(sourceId));
+		if (!audioClip)
 			return;
-		}
-		else if (!isStreamingT && thread.joinable()) // Streaming thread finished, let it join so it can be restarted
-		{
-			stop();
-		}
 
-		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
-			isStreaming = true;
-			threadStartState = PlaybackState::Playing;
-		}
+		isStreaming = true;
+		isStarted = false;
+		isPaused = false;
+		requestStop = false;
 
-		thread = std::thread(&MusicSource::stream, this); // Start updating stream in separate thread
+		// Service it again once half a buffer should have played, so a full one is always queued ahead
+		float bufSeconds = (float)BUF_SIZE / (audioClip->getChannels() * audioClip->getSamplerate());
+		serviceInterval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(bufSeconds * 0.5f));
+
+		decoder.start(audioClip, loop);
+		AudioStreamer::add(this);
 	}
 
 	void MusicSource::pause()
 	{
-		std::lock_guard<std::recursive_mutex> lock(mutex);
-		isStreaming = false;
+		std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
+
+		if (!isStreaming)
+			return;
+
+		isPaused = true;
+		if (isStarted)
+			alCheck(alSourcePause(sourceId));
 	}
 
 	void MusicSource::stop()
 	{
-		awaitThread();
+		std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
+
+		if (!isStreaming)
+			return;
+
+		AudioStreamer::remove(this);
+		finish();
 	}
 
 	void MusicSource::setAudioClip(Rc<AudioClip> audioClip)
 	{
+		stop();
+
+		std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
 		this->audioClip = audioClip;
 	}
 
 	void MusicSource::setLoop(bool loop)
 	{
+		std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
 		this->loop = loop;
+		decoder.setLoop(loop);
 	}
 
 	MusicSource::PlaybackState MusicSource::getStatus() const
 	{
 	    PlaybackState state = AudioSource::getStatus();
 
-        // To compensate for the lag between play() and alSourceplay()
+        // To compensate for the lag between play() and the streamer starting the source
         if (state == PlaybackState::Stopped)
         {
-            std::lock_guard<std::recursive_mutex> lock(mutex);
+            std::lock_guard<std::mutex> lock(AudioStreamer::getMutex());
 
             if (isStreaming)
-                state = threadStartState;
+                state = isPaused ? PlaybackState::Paused : PlaybackState::Playing;
         }
 
         return state;
 	}
 
-	void MusicSource::stream()
+	bool MusicSource::service()
 	{
-		bool requestStop = false;
-
+		if (!isStarted)
 		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
+			// Wait for the decoder to get ahead before starting, so the start of the stream doesn't stutter
+			if (!decoder.front())
+				return false;
 
-			if (threadStartState == PlaybackState::Stopped) // Launching a thread in stopped state does nothing
+			// Fill and enqueue all available buffers
+			for (size_t i = 0; i < BUF_COUNT; i++)
 			{
-				isStreaming = false;
-				return;
+				if (requestStop || !fillAndPushBuf(buffers[i]))
+					freeBufs[freeCount++] = buffers[i];
 			}
+
+			alCheck(alSourcePlay(sourceId));
+			if (isPaused)
+				alCheck(alSourcePause(sourceId));
+
+			isStarted = true;
+			return false;
 		}
-		
-		// Fill and enqueue all available buffers
-		for (size_t i = 0; (i < BUF_COUNT) && !requestStop; i++)
+
+		bool interrupted = AudioSource::getStatus() == PlaybackState::Stopped;
+		if (interrupted && requestStop)
+			return true; // End streaming
+
+		// Get number of processed buffers (i.e. number that are ready for reuse)
+		ALint processed = 0;
+		alCheck(alGetSourcei(sourceId, AL_BUFFERS_PROCESSED, &processed));
+
+		// Pop the played buffers off the queue, so stale data is never played again if the decoder falls behind
+		while (processed--)
 		{
-			if (fillAndPushBuf(i))
-				requestStop = true;
+			ALuint buf;
+			alCheck(alSourceUnqueueBuffers(sourceId, 1, &buf));
+			freeBufs[freeCount++] = buf;
 		}
 
-		alCheck(alSourcePlay(sourceId));
+		// Refill as many as the decoder has chunks ready for
+		while (freeCount > 0 && !requestStop && fillAndPushBuf(freeBufs[freeCount - 1]))
+			freeCount--;
 
+		if (interrupted && !isPaused) // Stream ran dry, so try and continue
 		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
-
-			if (threadStartState == PlaybackState::Paused) // If thread was launched paused
-				alCheck(alSourcePause(sourceId));
+			ALint queued = 0;
+			alCheck(alGetSourcei(sourceId, AL_BUFFERS_QUEUED, &queued));
+			if (queued > 0)
+				alCheck(alSourcePlay(sourceId));
 		}
 
-		while (1)
-		{
-			{
-				std::lock_guard<std::recursive_mutex> lock(mutex);
-				if (!isStreaming)
-					break;
-			}
+		return false;
+	}
 
-			if (AudioSource::getStatus() == PlaybackState::Stopped) // Stream interrupted
-			{
-				if (requestStop)
-				{
-					// End streaming
-					std::lock_guard<std::recursive_mutex> lock(mutex);
-					isStreaming = false;
-				}
-				else
-				{
-					alCheck(alSourcePlay(sourceId)); // Try and continue
-				}
-			}
+	bool MusicSource::fillAndPushBuf(u32 buf)
+	{
+		// Take the next chunk the decoder has ready
+		const StreamDecoder::Chunk* chunk = decoder.front();
+		if (!chunk)
+			return false;
 
-			// Get number of processed buffers (i.e. number that are ready for reuse)
-			ALint processed = 0;
-			alCheck(alGetSourcei(sourceId, AL_BUFFERS_PROCESSED, &processed));
-			
-			while (processed--)
-			{
-				// Pop the first unused buffer from the queue
-				ALuint buf;
-				alCheck(alSourceUnqueueBuffers(sourceId, 1, &buf));
-
-				u32 bufNo;
-				for (int i = 0; i < BUF_COUNT; i++)
-				{
-					if (buffers[i] == buf)
-						bufNo = i;
-				}
-
-				if (!requestStop)
-				{
-					if (fillAndPushBuf(bufNo))
-						requestStop = true;
-				}
-			}
+		if (chunk->last) // If not looping and reached end of file
+			requestStop = true;
 
-			// Leave some time for other threads if stream still playing
-			if (AudioSource::getStatus() != PlaybackState::Stopped)
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
-		}
+		// Fill buffer and push it to queue
+		alCheck(alBufferData(buf, audioClip->getFormat(), chunk->samples.data(), chunk->count * sizeof(short), audioClip->getSamplerate()));
+		alCheck(alSourceQueueBuffers(sourceId, 1, &buf));
+
+		decoder.pop();
+		return true;
+	}
+
+	void MusicSource::finish()
+	{
+		decoder.stop();
 
 		// Stop the playback
 		alCheck(alSourceStop(sourceId));
 
 		// Dequeue any buffer left in the queue
-		// Get the number of buffers still in the queue
 		ALint queued;
 		alCheck(alGetSourcei(sourceId, AL_BUFFERS_QUEUED, &queued));
 
-		// Dequeue them all
 		ALuint buf;
 		for (ALint i = 0; i < queued; ++i)
 			alCheck(alSourceUnqueueBuffers(sourceId, 1, &buf));
-	}
-
-	bool MusicSource::fillAndPushBuf(u32 bufNo)
-	{
-		bool requestStop = false;
-
-		// Load chunk of data from file
-		short* data = new short[BUF_SIZE];
-		uint64_t amount = audioClip->loadData(data, BUF_SIZE);
-
-		if (!loop && amount < BUF_SIZE) // If not looping and reached end of file
-			requestStop = true;
-
-		// Fill buffer
-		u32 buf = buffers[bufNo];
-		alCheck(alBufferData(buf, audioClip->getFormat(), &data[0], amount * sizeof(short), audioClip->getSamplerate()));
-	
-		// Push it to queue
-		alCheck(alSourceQueueBuffers(sourceId, 1, &buf));
 
-		delete[] data;
-
-		return requestStop;
-	}
-
-	void MusicSource::awaitThread()
-	{
-		// Request thread to join
-		{
-			std::lock_guard<std::recursive_mutex> lock(mutex);
-			isStreaming = false;
-		}
-
-		if (thread.joinable())
-			thread.join();
+		freeCount = 0;
+		isStreaming = false;
+		isStarted = false;
 	}
-}
\ No newline at end of file
+}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "AudioSource.h"
+#include "StreamDecoder.h"
 
 namespace kuai {
 	// Forward Declaration
@@ -14,7 +15,7 @@ namespace kuai {
     public:
         MusicSource();
 		virtual void cleanup() override;
-        
+
 		virtual void play() override;
 		virtual void pause() override;
 		virtual void stop() override;
@@ -26,15 +27,34 @@ namespace kuai {
 		virtual PlaybackState getStatus() const override;
 
 	private:
-		void stream();
-		bool fillAndPushBuf(u32 bufNo);
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		* Refill and requeue the buffers that have finished playing. Called by the AudioStreamer's thread.
+		* @return Whether the stream has ended.
+		*/
+		bool service();
+		/**
+		* Queue the next decoded chunk into a buffer.
+		* @return Whether a chunk was ready; the decoder may have fallen behind.
+		*/
+		bool fillAndPushBuf(u32 buf);
+		void finish();
 
-		void awaitThread();
-        
 	private:
-		std::thread thread;											// Streaming thread
-		mutable std::recursive_mutex mutex;							// Thread mutex
-		PlaybackState threadStartState{ PlaybackState::Stopped };	// Thread state when it starts
-		bool isStreaming = false;
+		// All guarded by AudioStreamer::getMutex()
+		bool isStreaming = false;	// Being serviced by the AudioStreamer
+		bool isStarted = false;		// Buffers have been queued for the first time
+		bool isPaused = false;
+		bool requestStop = false;	// The file has been read to its end and won't loop
+
+		u32 freeBufs[BUF_COUNT] = {};	// Unqueued buffers waiting on the decoder
+		u32 freeCount = 0;
+
+		StreamDecoder decoder;	// Decodes on the job system ahead of the buffers being refilled
+		Clock::time_point nextService;
+		Clock::duration serviceInterval = std::chrono::milliseconds(10);
+
+		friend class AudioStreamer;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,212 @@
+#include "kpch.h"
+#include "SampleCache.h"
+
+#include "AudioClip.h"
+#include "AudioManager.h"
+
+namespace kuai {
+	std::unordered_map<AudioClip*, SampleCache::Entry> SampleCache::entries;
+	std::list<AudioClip*> SampleCache::lru;
+	std::mutex SampleCache::mutex;
+
+	u64 SampleCache::budget = 64 * 1024 * 1024;
+	u64 SampleCache::memoryUsage = 0;
+	SampleCache::Stats SampleCache::stats;
+
+	void SampleCache::preload(Rc<AudioClip> clip)
+	{
+		Entry* entry = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if (entries.find(clip.get()) != entries.end())
+				return;
+
+			entry = &entries[clip.get()];
+			entry->lruIt = lru.insert(lru.begin(), clip.get());
+		}
+
+		// Unlocked, as the job runs straight away when there are no workers. Entries never move once made.
+		JobSystem::execute(entry->loading, [clip, entry]()
+		{
+			std::vector<short> samples = clip->loadAllData();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			entry->bytes = samples.size() * sizeof(short);
+			entry->samples = std::move(samples);
+			entry->state = EntryState::Decoded;
+			memoryUsage += entry->bytes;
+		});
+	}
+
+	void SampleCache::setBudget(u64 bytes)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		budget = bytes;
+		evict();
+	}
+
+	u64 SampleCache::getBudget()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return budget;
+	}
+
+	u64 SampleCache::getMemoryUsage()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return memoryUsage;
+	}
+
+	SampleCache::Stats SampleCache::getStats()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Stats result = stats;
+		result.clips = entries.size();
+		return result;
+	}
+
+	u32 SampleCache::acquire(Rc<AudioClip> clip)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		auto it = entries.find(clip.get());
+		if (it == entries.end())
+		{
+			stats.misses++;
+
+			Entry& entry = entries[clip.get()];
+			entry.lruIt = lru.insert(lru.begin(), clip.get());
+
+			// The source needs it now, so it's decoded here rather than on a worker
+			lock.unlock();
+			std::vector<short> samples = clip->loadAllData();
+			lock.lock();
+
+			entry.bytes = samples.size() * sizeof(short);
+			entry.samples = std::move(samples);
+			entry.state = EntryState::Decoded;
+			memoryUsage += entry.bytes;
+		}
+		else if (it->second.state == EntryState::Loading)
+		{
+			stats.misses++;
+
+			Entry& entry = it->second;
+			lru.splice(lru.begin(), lru, entry.lruIt);
+
+			lock.unlock();
+			JobSystem::wait(entry.loading);
+			lock.lock();
+		}
+		else
+		{
+			stats.hits++;
+			lru.splice(lru.begin(), lru, it->second.lruIt);
+		}
+
+		Entry& entry = entries.at(clip.get());
+		entry.refs++;
+
+		if (entry.state == EntryState::Decoded)
+			upload(clip.get());
+
+		evict();
+
+		return entry.bufferId;
+	}
+
+	void SampleCache::release(AudioClip* clip)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = entries.find(clip);
+		if (it == entries.end())
+			return;
+
+		KU_CORE_ASSERT(it->second.refs > 0, "Sample cache entry released more times than it was acquired.");
+		it->second.refs--;
+
+		evict();
+	}
+
+	void SampleCache::remove(AudioClip* clip)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		auto it = entries.find(clip);
+		if (it == entries.end())
+			return;
+
+		// Sources and loading jobs hold the clip, so neither can still be using it
+		Entry& entry = it->second;
+		if (entry.bufferId)
+			alCheck(alDeleteBuffers(1, &entry.bufferId));
+
+		memoryUsage -= entry.bytes;
+		lru.erase(entry.lruIt);
+		entries.erase(it);
+	}
+
+	void SampleCache::cleanup()
+	{
+		// Loading jobs lock the cache when they finish, so wait for them unlocked
+		std::vector<JobCounter*> loading;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			for (auto& pair : entries)
+			{
+				if (pair.second.state == EntryState::Loading)
+					loading.push_back(&pair.second.loading);
+			}
+		}
+
+		for (JobCounter* counter : loading)
+			JobSystem::wait(*counter);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (auto& pair : entries)
+		{
+			if (pair.second.bufferId)
+				alCheck(alDeleteBuffers(1, &pair.second.bufferId));
+		}
+
+		entries.clear();
+		lru.clear();
+		memoryUsage = 0;
+	}
+
+	void SampleCache::evict()
+	{
+		// Oldest first, skipping clips still attached to a source or still being decoded
+		auto it = lru.end();
+		while (memoryUsage > budget && it != lru.begin())
+		{
+			--it;
+
+			Entry& entry = entries.at(*it);
+			if (entry.refs > 0 || entry.state == EntryState::Loading)
+				continue;
+
+			if (entry.bufferId)
+				alCheck(alDeleteBuffers(1, &entry.bufferId));
+
+			memoryUsage -= entry.bytes;
+			stats.evictions++;
+
+			entries.erase(*it);
+			it = lru.erase(it);
+		}
+	}
+
+	void SampleCache::upload(AudioClip* clip)
+	{
+		Entry& entry = entries.at(clip);
+
+		alCheck(alGenBuffers(1, &entry.bufferId));
+		alCheck(alBufferData(entry.bufferId, clip->getFormat(), entry.samples.data(), entry.bytes, clip->getSamplerate()));
+
+		// OpenAL keeps its own copy
+		entry.samples = std::vector<short>();
+		entry.state = EntryState::Uploaded;
+	}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "kuai/Core/JobSystem.h"
+
+#include <list>
+#include <mutex>
+
+namespace kuai {
+	// Forward declaration
+	class AudioClip;
+
+	/** \class SampleCache
+	*	\brief Decodes each AudioClip once into a single OpenAL buffer shared by every source playing it.
+	*
+	*	Buffers are reference counted by the sources using them. Clips nobody is playing stay cached until the
+	*	decoded samples of every cached clip exceed the budget, then the least recently used are evicted first.
+	*/
+	class SampleCache
+	{
+	public:
+		/**
+		* Start decoding a clip on a worker thread so it is ready before it is first played.
+		*/
+		static void preload(Rc<AudioClip> clip);
+
+		/**
+		* Bytes of decoded samples kept before unused clips are evicted (default 64MB).
+		*/
+		static void setBudget(u64 bytes);
+		static u64 getBudget();
+
+		/**
+		* Bytes of decoded samples currently cached, whether in OpenAL buffers or waiting to be uploaded.
+		*/
+		static u64 getMemoryUsage();
+
+		struct Stats
+		{
+			u32 clips = 0;
+			u32 hits = 0;		// Acquires that found the clip already decoded
+			u32 misses = 0;		// Acquires that had to decode, or wait for a preload to finish
+			u32 evictions = 0;
+		};
+		static Stats getStats();
+
+	private:
+		/**
+		* Get the buffer holding a clip's samples, decoding it first if it isn't cached. Main thread only.
+		* Every acquire must be paired with a release.
+		*/
+		static u32 acquire(Rc<AudioClip> clip);
+		static void release(AudioClip* clip);
+
+		/**
+		* Forget a clip that is being destroyed.
+		*/
+		static void remove(AudioClip* clip);
+
+		static void cleanup();
+
+		static void evict();
+		static void upload(AudioClip* clip);
+
+	private:
+		enum class EntryState
+		{
+			Loading, Decoded, Uploaded
+		};
+
+		struct Entry
+		{
+			EntryState state = EntryState::Loading;
+			u32 bufferId = 0;
+			u32 refs = 0;
+			u64 bytes = 0;
+
+			std::vector<short> samples;	// Decoded, waiting for the main thread to upload them
+			JobCounter loading{ 0 };
+
+			std::list<AudioClip*>::iterator lruIt;
+		};
+
+		static std::unordered_map<AudioClip*, Entry> entries;
+		static std::list<AudioClip*> lru; // Most recently used at the front
+		static std::mutex mutex;
+
+		static u64 budget;
+		static u64 memoryUsage;
+		static Stats stats;
+
+		friend class AudioClip;
+		friend class AudioSource;
+		friend class AudioManager;
+	};
+}
@@ -0,0 +1,95 @@
+#include "kpch.h"
+#include "StreamDecoder.h"
+
+namespace kuai {
+	StreamDecoder::StreamDecoder(u32 chunkCount, u32 chunkSize) : ring(chunkCount), chunkSize(chunkSize)
+	{
+		// Allocated once; playing never allocates
+		for (Chunk& chunk : ring)
+			chunk.samples.resize(chunkSize);
+	}
+
+	StreamDecoder::~StreamDecoder()
+	{
+		stop();
+	}
+
+	void StreamDecoder::start(Rc<AudioClip> clip, bool loop)
+	{
+		stop();
+
+		// A reader of its own, so the stream's position is independent of any other playing the clip
+		reader = clip->openReader();
+		this->clip = clip;
+		this->loop = loop;
+		stopping = false;
+		finished = false;
+		head = 0;
+		tail = 0;
+
+		schedule();
+	}
+
+	void StreamDecoder::stop()
+	{
+		stopping = true;
+		JobSystem::wait(pending);
+	}
+
+	const StreamDecoder::Chunk* StreamDecoder::front() const
+	{
+		u32 h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &ring[h % ring.size()];
+	}
+
+	void StreamDecoder::pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		schedule();
+	}
+
+	void StreamDecoder::schedule()
+	{
+		if (stopping)
+			return;
+
+		// Claimed with a flag rather than read off pending, which only drops once a job has fully returned
+		bool expected = false;
+		if (!scheduled.compare_exchange_strong(expected, true))
+			return;
+
+		JobSystem::execute(pending, [this]() { decode(); });
+	}
+
+	void StreamDecoder::decode()
+	{
+		while (true)
+		{
+			u32 t = tail.load(std::memory_order_relaxed);
+			while (!stopping && !finished && t - head.load(std::memory_order_acquire) < ring.size())
+			{
+				Chunk& chunk = ring[t % ring.size()];
+				chunk.count = AudioClip::read(*reader, chunk.samples.data(), chunkSize);
+				chunk.last = !loop && chunk.count < chunkSize; // If not looping and reached end of file
+				finished = chunk.last;
+
+				tail.store(++t, std::memory_order_release);
+			}
+			bool done = stopping || finished;
+
+			scheduled.store(false);
+
+			// A pop between the ring filling and the flag clearing scheduled nothing, so its space is picked up here.
+			// If the consumer has claimed the flag since, its job decodes instead.
+			if (done || t - head.load(std::memory_order_acquire) >= ring.size())
+				return;
+
+			bool expected = false;
+			if (!scheduled.compare_exchange_strong(expected, true))
+				return;
+		}
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "AudioClip.h"
+
+#include "kuai/Core/JobSystem.h"
+
+// @cond
+namespace kuai {
+	/**
+	* Decodes a clip on the job system into a ring of chunks, ahead of a stream playing them. One decoding job is in
+	* flight at a time, so there is a single producer, and the stream taking chunks is the single consumer.
+	*/
+	class StreamDecoder
+	{
+	public:
+		struct Chunk
+		{
+			std::vector<short> samples;
+			u32 count = 0;		// Shorts decoded into samples
+			bool last = false;	// Reached the end of a clip that doesn't loop
+		};
+
+		StreamDecoder(u32 chunkCount, u32 chunkSize);
+		~StreamDecoder();
+
+		/**
+		* Start decoding a clip from its beginning.
+		*/
+		void start(Rc<AudioClip> clip, bool loop);
+
+		/**
+		* Stop decoding, waiting for the job in flight to finish.
+		*/
+		void stop();
+
+		void setLoop(bool loop) { this->loop = loop; }
+
+		/**
+		* The oldest decoded chunk, or nullptr if the decoder has fallen behind. Consumer only.
+		*/
+		const Chunk* front() const;
+
+		/**
+		* Hand the front chunk back to be decoded into again. Consumer only.
+		*/
+		void pop();
+
+	private:
+		void schedule();
+		void decode();
+
+	private:
+		std::vector<Chunk> ring;
+		u32 chunkSize;
+
+		std::atomic<u32> head{ 0 }; // Next chunk to play, moved by the consumer
+		std::atomic<u32> tail{ 0 }; // Next chunk to decode into, moved by the decoding job
+
+		Rc<AudioClip> clip;
+		Box<AudioClip::Reader> reader;
+		std::atomic<bool> loop{ false };
+		std::atomic<bool> stopping{ false };
+		bool finished = false; // Only touched by the decoding job while one is in flight
+
+		std::atomic<bool> scheduled{ false }; // Whether a decoding job is running or about to; only one decodes at a time
+		JobCounter pending{ 0 };
+	};
+}
+// @endcond
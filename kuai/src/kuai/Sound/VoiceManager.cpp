@@ -0,0 +1,240 @@
+#include "kpch.h"
+#include "VoiceManager.h"
+
+#include "AudioSource.h"
+#include "AudioManager.h"
+
+namespace kuai {
+	// Streamed sources create voices of their own, so some of the device's are left for them
+	static const u32 STREAM_VOICES = 16;
+	// Sources quieter than this (-60dB) aren't worth a voice even when one is free
+	static const float MIN_AUDIBILITY = 0.001f;
+
+	std::vector<AudioSource*> VoiceManager::sources;
+	std::vector<AudioSource*> VoiceManager::candidates;
+
+	std::vector<u32> VoiceManager::freeVoices;
+	u32 VoiceManager::voiceCount = 0;
+	u32 VoiceManager::maxVoices = 64;
+	u32 VoiceManager::deviceVoices = 0;
+
+	VoiceManager::Stats VoiceManager::stats;
+
+	void VoiceManager::init(u32 deviceVoices)
+	{
+		// Devices that don't say how many they have are left to fail when they run out
+		if (!deviceVoices)
+			return;
+
+		VoiceManager::deviceVoices = deviceVoices > STREAM_VOICES ? deviceVoices - STREAM_VOICES : deviceVoices;
+		maxVoices = std::min(maxVoices, VoiceManager::deviceVoices);
+	}
+
+	void VoiceManager::cleanup()
+	{
+		for (AudioSource* source : sources)
+		{
+			if (source->sourceId)
+				virtualise(source);
+		}
+
+		alCheck(alDeleteSources(freeVoices.size(), freeVoices.data()));
+		freeVoices.clear();
+		voiceCount = 0;
+
+		sources.clear();
+	}
+
+	void VoiceManager::setMaxVoices(u32 count)
+	{
+		// Voices over the limit are given back as the next update reassigns them
+		maxVoices = deviceVoices ? std::min(count, deviceVoices) : count;
+	}
+
+	void VoiceManager::update(float dt, const glm::vec3& listenerPos)
+	{
+		KU_PROFILE_FUNCTION();
+
+		stats = Stats();
+		stats.sources = sources.size();
+
+		candidates.clear();
+		for (AudioSource* source : sources)
+		{
+			if (source->state == AudioSource::PlaybackState::Playing)
+			{
+				if (source->sourceId)
+				{
+					// Voices stop by themselves at the end of clips that don't loop
+					ALint status;
+					alCheck(alGetSourcei(source->sourceId, AL_SOURCE_STATE, &status));
+					if (status == AL_STOPPED)
+					{
+						source->state = AudioSource::PlaybackState::Stopped;
+						source->playTime = 0.0f;
+					}
+				}
+				else
+				{
+					source->playTime += dt * source->pitch;
+					if (source->playTime >= source->clipDuration && source->clipDuration > 0.0f)
+					{
+						if (source->loop)
+						{
+							source->playTime = std::fmod(source->playTime, source->clipDuration);
+						}
+						else
+						{
+							source->state = AudioSource::PlaybackState::Stopped;
+							source->playTime = 0.0f;
+						}
+					}
+				}
+			}
+
+			if (source->state != AudioSource::PlaybackState::Playing || !source->clipBuffer)
+			{
+				// Paused and stopped sources don't need a voice to hold their place
+				if (source->sourceId)
+					virtualise(source);
+				continue;
+			}
+
+			// OpenAL's default inverse distance clamped attenuation
+			float dist = std::max(glm::length(source->pos - listenerPos), source->refDist);
+			float attenuation = source->refDist / std::max(source->refDist + source->rolloff * (dist - source->refDist), 0.0001f);
+			source->audibility = source->gain * source->mixGain * attenuation;
+
+			candidates.push_back(source);
+		}
+
+		// Highest priority first, then loudest
+		u32 count = std::min((u32)candidates.size(), maxVoices);
+		if (count < candidates.size())
+		{
+			std::nth_element(candidates.begin(), candidates.begin() + count, candidates.end(), [](AudioSource* a, AudioSource* b)
+			{
+				return a->priority != b->priority ? a->priority > b->priority : a->audibility > b->audibility;
+			});
+		}
+
+		// Free voices from the sources losing them before handing them to the ones gaining them
+		for (u32 i = 0; i < candidates.size(); i++)
+		{
+			AudioSource* source = candidates[i];
+			if (source->sourceId && (i >= count || source->audibility < MIN_AUDIBILITY))
+				virtualise(source);
+		}
+
+		for (u32 i = 0; i < count; i++)
+		{
+			AudioSource* source = candidates[i];
+			if (!source->sourceId && source->audibility >= MIN_AUDIBILITY)
+				realise(source);
+		}
+
+		// Trim voices left over after lowering the limit
+		while (voiceCount > maxVoices && !freeVoices.empty())
+		{
+			alCheck(alDeleteSources(1, &freeVoices.back()));
+			freeVoices.pop_back();
+			voiceCount--;
+		}
+
+		stats.playing = candidates.size();
+		for (AudioSource* source : candidates)
+		{
+			if (source->sourceId)
+				stats.real++;
+		}
+		stats.virtualised = stats.playing - stats.real;
+	}
+
+	void VoiceManager::add(AudioSource* source)
+	{
+		sources.push_back(source);
+	}
+
+	void VoiceManager::remove(AudioSource* source)
+	{
+		auto it = std::find(sources.begin(), sources.end(), source);
+		if (it == sources.end())
+			return;
+
+		if (source->sourceId)
+			virtualise(source);
+
+		*it = sources.back();
+		sources.pop_back();
+	}
+
+	void VoiceManager::requestVoice(AudioSource* source)
+	{
+		if (freeVoices.empty() && voiceCount >= maxVoices)
+			return;
+
+		if (std::find(sources.begin(), sources.end(), source) != sources.end())
+			realise(source);
+	}
+
+	bool VoiceManager::realise(AudioSource* source)
+	{
+		u32 voice = takeVoice();
+		if (!voice)
+			return false;
+
+		source->sourceId = voice;
+		source->apply(voice, AudioSource::ALL_PROPERTIES);
+
+		// Carry on from where the source got to while virtual
+		alCheck(alSourcei(voice, AL_BUFFER, source->clipBuffer));
+		alCheck(alSourcef(voice, AL_SEC_OFFSET, source->playTime));
+		alCheck(alSourcePlay(voice));
+
+		return true;
+	}
+
+	void VoiceManager::virtualise(AudioSource* source)
+	{
+		u32 voice = source->sourceId;
+
+		// Only playing and paused voices have a place in their clip worth keeping
+		if (source->state != AudioSource::PlaybackState::Stopped)
+			alCheck(alGetSourcef(voice, AL_SEC_OFFSET, &source->playTime));
+
+		source->sourceId = 0;
+		giveVoice(voice);
+	}
+
+	u32 VoiceManager::takeVoice()
+	{
+		if (!freeVoices.empty())
+		{
+			u32 voice = freeVoices.back();
+			freeVoices.pop_back();
+			return voice;
+		}
+
+		if (voiceCount >= maxVoices)
+			return 0;
+
+		u32 voice = 0;
+		alGenSources(1, &voice);
+		if (alGetError() != AL_NO_ERROR)
+		{
+			// The device has run out, so don't ask again
+			maxVoices = deviceVoices = voiceCount;
+			return 0;
+		}
+
+		voiceCount++;
+		return voice;
+	}
+
+	void VoiceManager::giveVoice(u32 voice)
+	{
+		alCheck(alSourceStop(voice));
+		alCheck(alSourcei(voice, AL_BUFFER, AL_NONE));
+		freeVoices.push_back(voice);
+	}
+}
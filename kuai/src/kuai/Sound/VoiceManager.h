@@ -0,0 +1,72 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+namespace kuai {
+	// Forward declaration
+	class AudioSource;
+
+	/** \class VoiceManager
+	*	\brief Shares a bounded number of OpenAL voices between every playing AudioSource.
+	*
+	*	Each frame playing sources are ranked by priority, then by how loud they should be at the listener given their
+	*	gain, distance and rolloff. The loudest get voices, and the rest play virtually, keeping their place in their
+	*	clip so they pick up where they should be when they become audible again. Streamed sources keep voices of
+	*	their own and aren't managed.
+	*/
+	class VoiceManager
+	{
+	public:
+		/**
+		* Most sources that can be heard at once (default 64). Limited by what the device supports.
+		*/
+		static void setMaxVoices(u32 count);
+		static u32 getMaxVoices() { return maxVoices; }
+
+		struct Stats
+		{
+			u32 sources = 0;
+			u32 playing = 0;
+			u32 real = 0;		// Playing with a voice
+			u32 virtualised = 0; // Playing without one
+		};
+		static const Stats& getStats() { return stats; }
+
+	private:
+		static void init(u32 deviceVoices);
+		static void cleanup();
+
+		/**
+		* Advance virtual sources and reassign voices to the loudest playing sources. Main thread, once a frame.
+		*/
+		static void update(float dt, const glm::vec3& listenerPos);
+
+		static void add(AudioSource* source);
+		static void remove(AudioSource* source);
+
+		/**
+		* Give a source that just started playing a voice straight away, if one is free.
+		*/
+		static void requestVoice(AudioSource* source);
+
+		static bool realise(AudioSource* source);
+		static void virtualise(AudioSource* source);
+
+		static u32 takeVoice();
+		static void giveVoice(u32 voice);
+
+	private:
+		static std::vector<AudioSource*> sources;
+		static std::vector<AudioSource*> candidates;
+
+		static std::vector<u32> freeVoices;
+		static u32 voiceCount;	// Voices created, whether free or in use
+		static u32 maxVoices;
+		static u32 deviceVoices;
+
+		static Stats stats;
+
+		friend class AudioManager;
+		friend class AudioSource;
+	};
+}